@@ -27,6 +27,9 @@ class Brush {
     Tempest::Color              color;
     PaintDevice::Blend          blend = PaintDevice::NoBlend;
     ClampMode                   clamp = ClampMode::Repeat;
+    // sprite holds a glyph distance field, see FontElement::distanceField
+    bool                        distField = false;
+    PaintDevice::TextEffect     fx;
 
     struct Info {
       int      w=0,h=0;
@@ -1,3 +1,25 @@
 #include "paintdevice.h"
 
+#include <algorithm>
+
 using namespace Tempest;
+
+void PaintDevice::addPoints(const Point* p, size_t count) {
+  if(count==0)
+    return;
+  std::copy(p,p+count,allocPoints(count));
+  }
+
+PaintDevice::Quad* PaintDevice::allocQuads(size_t) {
+  return nullptr;
+  }
+
+void PaintDevice::beginRange(const RangeKey&) {
+  }
+
+void PaintDevice::endRange() {
+  }
+
+bool PaintDevice::replayRange(const RangeKey&) {
+  return false;
+  }
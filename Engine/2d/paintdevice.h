@@ -3,13 +3,13 @@
 #include <Tempest/AbstractGraphicsApi>
 #include <Tempest/RenderPipeline>
 #include <Tempest/VertexBuffer>
+#include <Tempest/Color>
 
 #include <initializer_list>
 
 namespace Tempest {
 
 class Texture2d;
-class Color;
 class Sprite;
 
 enum AlignFlag : uint8_t {
@@ -47,11 +47,50 @@ class PaintDevice {
       float r=0,g=0,b=0,a=0;
       };
 
+    // axis-aligned textured rect, expanded to 6 vertices on gpu
+    struct Quad {
+      float    x0=0,y0=0,x1=0,y1=0;
+      uint32_t uv0=0, uv1=0; // unorm16 pairs
+      uint32_t color=0;      // unorm8 rgba
+      uint32_t page=0;       // texture slot of a batch, see VectorImage::Mesh
+      };
+
+    // outline and glow around distance-field glyphs; widths are in pixels of glyph at FontElement::DistanceFieldSize
+    struct TextEffect {
+      float outline = 0;
+      float glow    = 0;
+      Color outlineColor;
+      Color glowColor;
+
+      bool operator == (const TextEffect& e) const {
+        return outline==e.outline && glow==e.glow && outlineColor==e.outlineColor && glowColor==e.glowColor;
+        }
+      };
+
+    // widget and the area it was painted to; geometry of same key can be replayed, see VectorImage::setRetained
+    struct RangeKey {
+      const void* owner = nullptr;
+      int32_t     x=0, y=0;
+      int32_t     vx=0, vy=0, vw=0, vh=0;
+      uint32_t    w=0, h=0;
+      // widget only moved: geometry of same owner and viewport can be replayed with offset
+      bool        movable = false;
+
+      bool operator == (const RangeKey& k) const {
+        return owner==k.owner && x==k.x && y==k.y && vx==k.vx && vy==k.vy && vw==k.vw && vh==k.vh && w==k.w && h==k.h;
+        }
+      };
+
   protected:
     using TexPtr = Detail::ResourcePtr<Tempest::Texture2d>;
 
     virtual void   clear()=0;
     virtual void   addPoint(const Point& p)=0;
+    virtual void   addPoints(const Point* p, size_t count);
+    // storage for count points of current block, filled in place by the caller
+    virtual Point* allocPoints(size_t count)=0;
+    // storage for count quads, or nullptr if device has no quad instancing in current state
+    virtual Quad*  allocQuads(size_t count);
     virtual void   commitPoints()=0;
 
     virtual void   beginPaint(bool clear,uint32_t w,uint32_t h)=0;
@@ -60,10 +99,16 @@ class PaintDevice {
     virtual void   popState(size_t id)=0;
 
     virtual void   setState(const TexPtr& t, const Color& c, TextureFormat frm, ClampMode clamp)=0;
-    virtual void   setState(const Sprite& s, const Color& c)=0;
+    virtual void   setState(const Sprite& s, const Color& c, bool distanceField, const TextEffect& fx)=0;
     virtual void   setTopology(Topology t)=0;
     virtual void   setBlend(const Blend b)=0;
 
+    virtual void   beginRange(const RangeKey& k);
+    virtual void   endRange();
+    // repeats geometry, painted under same key on previous frame; false if there is none
+    virtual bool   replayRange(const RangeKey& k);
+
   friend class Painter;
+  friend class Widget;
   };
 }
@@ -8,8 +8,78 @@
 
 #include "../utility/utf8_helper.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#include <emmintrin.h>
+#define TEMPEST_PAINTER_SSE 1
+#endif
+
 using namespace Tempest;
 
+namespace {
+
+// vertex as x,y,u,v; or distances to four scissor edges
+struct F4 {
+#if defined(TEMPEST_PAINTER_SSE)
+  __m128 v;
+
+  F4() = default;
+  F4(__m128 v):v(v){}
+  explicit F4(float s):v(_mm_set1_ps(s)){}
+  F4(float a, float b, float c, float d):v(_mm_setr_ps(a,b,c,d)){}
+
+  static F4 load(const float* f)  { return _mm_loadu_ps(f); }
+  void      store(float* f) const { _mm_storeu_ps(f,v); }
+  F4        xyxy()          const { return _mm_shuffle_ps(v,v,_MM_SHUFFLE(1,0,1,0)); }
+  int       signs()         const { return _mm_movemask_ps(v); }
+
+  friend F4 operator + (F4 a, F4 b) { return _mm_add_ps(a.v,b.v); }
+  friend F4 operator - (F4 a, F4 b) { return _mm_sub_ps(a.v,b.v); }
+  friend F4 operator * (F4 a, F4 b) { return _mm_mul_ps(a.v,b.v); }
+  friend F4 vmin(F4 a, F4 b) { return _mm_min_ps(a.v,b.v); }
+  friend F4 vmax(F4 a, F4 b) { return _mm_max_ps(a.v,b.v); }
+#else
+  float v[4];
+
+  F4() = default;
+  explicit F4(float s):v{s,s,s,s}{}
+  F4(float a, float b, float c, float d):v{a,b,c,d}{}
+
+  static F4 load(const float* f)  { return F4(f[0],f[1],f[2],f[3]); }
+  void      store(float* f) const { std::memcpy(f,v,sizeof(v)); }
+  F4        xyxy()          const { return F4(v[0],v[1],v[0],v[1]); }
+  int       signs()         const {
+    return int(std::signbit(v[0])) | int(std::signbit(v[1]))<<1 |
+           int(std::signbit(v[2]))<<2 | int(std::signbit(v[3]))<<3;
+    }
+
+  friend F4 operator + (F4 a, F4 b) { return F4(a.v[0]+b.v[0],a.v[1]+b.v[1],a.v[2]+b.v[2],a.v[3]+b.v[3]); }
+  friend F4 operator - (F4 a, F4 b) { return F4(a.v[0]-b.v[0],a.v[1]-b.v[1],a.v[2]-b.v[2],a.v[3]-b.v[3]); }
+  friend F4 operator * (F4 a, F4 b) { return F4(a.v[0]*b.v[0],a.v[1]*b.v[1],a.v[2]*b.v[2],a.v[3]*b.v[3]); }
+  friend F4 vmin(F4 a, F4 b) {
+    return F4(std::min(a.v[0],b.v[0]),std::min(a.v[1],b.v[1]),std::min(a.v[2],b.v[2]),std::min(a.v[3],b.v[3]));
+    }
+  friend F4 vmax(F4 a, F4 b) {
+    return F4(std::max(a.v[0],b.v[0]),std::max(a.v[1],b.v[1]),std::max(a.v[2],b.v[2]),std::max(a.v[3],b.v[3]));
+    }
+#endif
+
+  float operator[](int i) const { float f[4]; store(f); return f[i]; }
+  };
+
+}
+
+static uint32_t unorm8(float v) {
+  return uint32_t(std::clamp(v,0.f,1.f)*255.f+0.5f);
+  }
+
+static uint32_t unorm16(float v) {
+  return uint32_t(std::clamp(v,0.f,1.f)*65535.f+0.5f);
+  }
+
 Painter::Painter(PaintEvent &ev, Mode m)
   : dev(ev.device()), ta(ev.ta) {
   s.fnt = Application::font();
@@ -59,20 +129,12 @@ void Painter::setScissor(const Rect& r) {
   setScissor(r.x,r.y,r.w,r.h);
   }
 
-void Painter::implAddPoint(float x, float y, float u, float v) {
-  pt.x=x*s.tr.invW-1.f;
-  pt.y=y*s.tr.invH-1.f;
-  pt.u=u;
-  pt.v=v;
-  dev.addPoint(pt);
-  }
-
-void Painter::implAddPoint(int x, int y, float u, float v) {
-  pt.x=x*s.tr.invW-1.f;
-  pt.y=y*s.tr.invH-1.f;
-  pt.u=u;
-  pt.v=v;
-  dev.addPoint(pt);
+void Painter::implSetPoint(PaintDevice::Point& p, float x, float y, float u, float v) const {
+  p   = pt;
+  p.x = x*s.tr.invW-1.f;
+  p.y = y*s.tr.invH-1.f;
+  p.u = u;
+  p.v = v;
   }
 
 void Painter::implSetColor(float r, float g, float b, float a) {
@@ -80,133 +142,103 @@ void Painter::implSetColor(float r, float g, float b, float a) {
   pt.g=g;
   pt.b=b;
   pt.a=a;
+  ptColor = unorm8(r) | unorm8(g)<<8 | unorm8(b)<<16 | unorm8(a)<<24;
   }
 
 void Painter::drawTriangle(int x0, int y0, float u0, float v0,
                            int x1, int y1, float u1, float v1,
                            int x2, int y2, float u2, float v2) {
-  FPoint trigBuf[4+4+4+4];
   implDrawTrig( float(x0), float(y0), s.dU+u0*s.invW,s.dV+v0*s.invH,
                 float(x1), float(y1), s.dU+u1*s.invW,s.dV+v1*s.invH,
-                float(x2), float(y2), s.dU+u2*s.invW,s.dV+v2*s.invH,
-                trigBuf, 0 );
+                float(x2), float(y2), s.dU+u2*s.invW,s.dV+v2*s.invH );
   }
 
 void Painter::drawTriangle(float x0, float y0, float u0, float v0,
                            float x1, float y1, float u1, float v1,
                            float x2, float y2, float u2, float v2) {
-  FPoint trigBuf[4+4+4+4];
   implDrawTrig( x0, y0, s.dU+u0*s.invW,s.dV+v0*s.invH,
                 x1, y1, s.dU+u1*s.invW,s.dV+v1*s.invH,
-                x2, y2, s.dU+u2*s.invW,s.dV+v2*s.invH,
-                trigBuf, 0 );
+                x2, y2, s.dU+u2*s.invW,s.dV+v2*s.invH );
   }
 
 void Painter::implDrawTrig( float x0, float y0, float u0, float v0,
                             float x1, float y1, float u1, float v1,
-                            float x2, float y2, float u2, float v2,
-                            FPoint* out,
-                            int stage ) {
-  ScissorRect& sc = s.scRect;
-  FPoint*      r  = out;
-
-  float x[4] = {x0,x1,x2,x0};
-  float y[4] = {y0,y1,y2,y0};
-  float u[4] = {u0,u1,u2,u0};
-  float v[4] = {v0,v1,v2,v0};
-
-  float mid;
-  float sx = 0.f;
-  bool  cs = false, ns = false;
-
-  switch( stage ) {
-    case 0: sx = float(sc.x);  break;
-    case 1: sx = float(sc.y);  break;
-    case 2: sx = float(sc.x1); break;
-    case 3: sx = float(sc.y1); break;
+                            float x2, float y2, float u2, float v2 ) {
+  const FPoint p[3] = {{x0,y0,u0,v0}, {x1,y1,u1,v1}, {x2,y2,u2,v2}};
+  implDrawPoly(p,3);
+  }
+
+void Painter::implDrawQuad(const float x[4], const float y[4], float u1, float v1, float u2, float v2) {
+  const FPoint p[4] = {{x[0],y[0],u1,v1}, {x[1],y[1],u2,v1}, {x[2],y[2],u2,v2}, {x[3],y[3],u1,v2}};
+  implDrawPoly(p,4);
+  }
+
+void Painter::implDrawPoly(const FPoint* p, size_t n) {
+  // Sutherland-Hodgman: each clipped edge adds at most n/2 vertices
+  enum { MaxVert = 20 };
+  const ScissorRect& sc   = s.scRect;
+  const F4           sign = F4(1.f,1.f,-1.f,-1.f);
+  const F4           bias = F4(-float(sc.x),-float(sc.y),float(sc.x1),float(sc.y1));
+
+  F4  vbuf[2][MaxVert], dbuf[2][MaxVert];
+  F4* vert = vbuf[0];
+  F4* dist = dbuf[0];
+
+  // distances to left, top, right and bottom edges; negative is outside
+  int any = 0, all = 0xF;
+  for(size_t i=0; i<n; ++i) {
+    vert[i] = F4::load(&p[i].x);
+    dist[i] = vert[i].xyxy()*sign + bias;
+    const int out = dist[i].signs();
+    any |= out;
+    all &= out;
     }
+  if(all!=0)
+    return;
 
-  for(int i=0;i<3;++i){
-    switch( stage ){
-      case 0:
-        cs = x[i]  >=sx;
-        ns = x[i+1]>=sx;
-        break;
-      case 1:
-        cs = y[i]  >=sx;
-        ns = y[i+1]>=sx;
-        break;
-      case 2:
-        cs = x[i]  <sx;
-        ns = x[i+1]<sx;
-        break;
-      case 3:
-        cs = y[i]  <sx;
-        ns = y[i+1]<sx;
-        break;
-      }
-
-    if(cs==ns){
-      if( cs ){
-        *out = FPoint{float(x[i+1]),float(y[i+1]),float(u[i+1]),float(v[i+1])};
-        ++out;
+  for(int e=0; e<4; ++e) {
+    if((any & (1<<e))==0)
+      continue;
+    F4*   nv = (vert==vbuf[0]) ? vbuf[1] : vbuf[0];
+    F4*   nd = (dist==dbuf[0]) ? dbuf[1] : dbuf[0];
+    float d[MaxVert];
+    for(size_t i=0; i<n; ++i)
+      d[i] = dist[i][e];
+
+    size_t k = 0;
+    for(size_t i=0; i<n; ++i) {
+      const size_t j  = (i+1==n) ? 0 : i+1;
+      const bool   in = d[i]>=0.f;
+      if(in) {
+        nv[k] = vert[i];
+        nd[k] = dist[i];
+        ++k;
         }
-      } else {
-      float dx = (x[i+1]-x[i]);
-      float dy = (y[i+1]-y[i]);
-      float du = (u[i+1]-u[i]);
-      float dv = (v[i+1]-v[i]);
-      if( ns ){
-        if(stage%2==0){
-          mid = y[i] + (dy*(sx-x[i]))/dx;
-          *out = FPoint{sx, mid,
-              u[i] + (du*(sx-x[i]))/dx,
-              v[i] + (dv*(sx-x[i]))/dx};   ++out;
-
-          *out = FPoint{float(x[i+1]),float(y[i+1]),float(u[i+1]),float(v[i+1])};
-          ++out;
-          } else {
-          mid = x[i] + (dx*(sx-y[i]))/dy;
-          *out = FPoint{mid, sx,
-              u[i] + (du*(sx-y[i]))/dy,
-              v[i] + (dv*(sx-y[i]))/dy};   ++out;
-
-          *out = FPoint{float(x[i+1]),float(y[i+1]),float(u[i+1]),float(v[i+1])};
-          ++out;
-          }
-        } else {
-        if(stage%2==0){
-          mid = y[i] + (dy*(sx-x[i]))/dx;
-          *out = FPoint{sx, mid,
-              u[i] + (du*(sx-x[i]))/dx,
-              v[i] + (dv*(sx-x[i]))/dx};   ++out;
-          } else {
-          mid = x[i] + (dx*(sx-y[i]))/dy;
-          *out = FPoint{mid, sx,
-              u[i] + (du*(sx-y[i]))/dy,
-              v[i] + (dv*(sx-y[i]))/dy};   ++out;
-          }
+      if(in!=(d[j]>=0.f)) {
+        const F4 t = F4(d[i]/(d[i]-d[j]));
+        nv[k] = vert[i] + (vert[j]-vert[i])*t;
+        nd[k] = dist[i] + (dist[j]-dist[i])*t;
+        ++k;
         }
       }
-    cs = ns;
+    vert = nv;
+    dist = nd;
+    n    = k;
+    if(n<3)
+      return;
     }
 
-  ptrdiff_t count = out-r;
-  count-=3;
-
-  if( stage<3 ){
-    for(ptrdiff_t i=0;i<=count;++i){
-      implDrawTrig( r[  0].x, r[  0].y, r[  0].u, r[  0].v,
-                    r[i+1].x, r[i+1].y, r[i+1].u, r[i+1].v,
-                    r[i+2].x, r[i+2].y, r[i+2].u, r[i+2].v,
-                    out, stage+1 );
-      }
-    } else {
-    for(ptrdiff_t i=0;i<=count;++i){
-      implAddPoint(r[  0].x, r[  0].y, r[  0].u, r[  0].v);
-      implAddPoint(r[i+1].x, r[i+1].y, r[i+1].u, r[i+1].v);
-      implAddPoint(r[i+2].x, r[i+2].y, r[i+2].u, r[i+2].v);
-      }
+  auto* out = dev.allocPoints((n-2)*3);
+  float a[4], b[4], c[4];
+  vert[0].store(a);
+  vert[1].store(c);
+  for(size_t i=2; i<n; ++i) {
+    std::memcpy(b,c,sizeof(c));
+    vert[i].store(c);
+    implSetPoint(out[0], a[0],a[1],a[2],a[3]);
+    implSetPoint(out[1], b[0],b[1],b[2],b[3]);
+    implSetPoint(out[2], c[0],c[1],c[2],c[3]);
+    out += 3;
     }
   }
 
@@ -231,10 +263,11 @@ void Painter::implBrush(const Brush &b) {
   if(b.tex) {
     dev.setState(b.tex,b.color,b.texFrm,b.clamp);
     } else {
-    dev.setState(b.spr,b.color);
+    dev.setState(b.spr,b.color,b.distField,b.fx);
     }
   dev.setBlend(b.blend);
   implSetColor(b.color.r(),b.color.g(),b.color.b(),b.color.a());
+  ptTex = bool(b.tex) || !b.spr.isEmpty();
   }
 
 void Painter::implPen(const Pen &p) {
@@ -266,65 +299,58 @@ void Painter::implDrawRect(int x1, int y1, int x2, int y2, float u1, float v1, f
       std::swap(v1,v2);
       }
 
-    float invW = (u2-u1)/float(x2-x1);
-    float invH = (v2-v1)/float(y2-y1);
-
-    ScissorRect& sc = s.scRect;
-    if(x1<sc.x){
-      int dx=sc.x-x1;
-      x1+=dx;
-      if(x1>=x2)
-        return;
-      u1+=dx*invW;
-      }
-
-    if(sc.x1<x2){
-      int dx=sc.x1-x2;
-      x2+=dx;
-      if(x1>=x2)
-        return;
-      u2+=dx*invW;
-      }
-
-    if(y1<sc.y){
-      int dy=sc.y-y1;
-      y1+=dy;
-      if(y1>=y2)
-        return;
-      v1+=dy*invH;
-      }
-
-    if(sc.y1<y2){
-      int dy=sc.y1-y2;
-      y2+=dy;
-      if(y1>=y2)
-        return;
-      v2+=dy*invH;
-      }
-
-    implAddPoint(x1,y1, u1,v1);
-    implAddPoint(x2,y1, u2,v1);
-    implAddPoint(x2,y2, u2,v2);
-
-    implAddPoint(x1,y1, u1,v1);
-    implAddPoint(x2,y2, u2,v2);
-    implAddPoint(x1,y2, u1,v2);
+    implDrawRectAA(float(x1),float(y1),float(x2),float(y2), u1,v1,u2,v2);
     } else {
     float x[4] = {float(x1), float(x2), float(x2), float(x1)};
     float y[4] = {float(y1), float(y1), float(y2), float(y2)};
     for(size_t i=0;i<4;++i)
       s.tr.mat.map(x[i],y[i],x[i],y[i]);
+    implDrawQuad(x,y, u1,v1,u2,v2);
+    }
+  }
+
+void Painter::implDrawRectAA(float x1, float y1, float x2, float y2, float u1, float v1, float u2, float v2) {
+  // screen space rect, x1<x2 and y1<y2: clip corners and uv together
+  const ScissorRect& sc   = s.scRect;
+  const F4           rect = F4(x1,y1,x2,y2);
+  const F4           uv   = F4(u1,v1,u2,v2);
+  const float        du   = (u2-u1)/(x2-x1);
+  const float        dv   = (v2-v1)/(y2-y1);
+
+  const F4 lo   = F4(float(sc.x), float(sc.y), float(sc.x), float(sc.y));
+  const F4 hi   = F4(float(sc.x1),float(sc.y1),float(sc.x1),float(sc.y1));
+  const F4 clip = vmin(vmax(rect,lo),hi);
+  const F4 cuv  = uv + (clip-rect)*F4(du,dv,du,dv);
 
-    FPoint trigBuf[4+4+4+4];
-    implDrawTrig( x[0], y[0], u1, v1,
-                  x[1], y[1], u2, v1,
-                  x[2], y[2], u2, v2,
-                  trigBuf, 0 );
-    implDrawTrig(x[0],y[0], u1,v1,
-                 x[2],y[2], u2,v2,
-                 x[3],y[3], u1,v2,
-                 trigBuf, 0 );
+  float r[4], t[4];
+  clip.store(r);
+  cuv .store(t);
+  if(r[0]>=r[2] || r[1]>=r[3])
+    return;
+
+  // quad instance has 16-bit uv: atlas sprites and clamped textures only
+  const bool unorm = !ptTex || (std::min({t[0],t[1],t[2],t[3]})>=0.f && std::max({t[0],t[1],t[2],t[3]})<=1.f);
+  if(T_LIKELY(unorm)) {
+    if(auto* q = dev.allocQuads(1)) {
+      q->x0    = r[0]*s.tr.invW-1.f;
+      q->y0    = r[1]*s.tr.invH-1.f;
+      q->x1    = r[2]*s.tr.invW-1.f;
+      q->y1    = r[3]*s.tr.invH-1.f;
+      q->uv0   = ptTex ? (unorm16(t[0]) | unorm16(t[1])<<16) : 0;
+      q->uv1   = ptTex ? (unorm16(t[2]) | unorm16(t[3])<<16) : 0;
+      q->color = ptColor;
+      return;
+      }
     }
+
+  auto* p = dev.allocPoints(6);
+  implSetPoint(p[0], r[0],r[1], t[0],t[1]);
+  implSetPoint(p[1], r[2],r[1], t[2],t[1]);
+  implSetPoint(p[2], r[2],r[3], t[2],t[3]);
+
+  p[3] = p[0];
+  p[4] = p[2];
+  implSetPoint(p[5], r[0],r[3], t[0],t[3]);
   }
 
 void Painter::implDrawRectF(float x1, float y1, float x2, float y2, float u1, float v1, float u2, float v2) {
@@ -333,20 +359,36 @@ void Painter::implDrawRectF(float x1, float y1, float x2, float y2, float u1, fl
     state=StBrush;
     implBrush(s.br);
     }
-  float x[4] = {float(x1), float(x2), float(x2), float(x1)};
-  float y[4] = {float(y1), float(y1), float(y2), float(y2)};
+
+  if(T_LIKELY(s.tr.mat.type()==Transform::T_AxisAligned)) {
+    float ax,ay,bx,by,cx,cy;
+    s.tr.mat.map(x1,y1, ax,ay);
+    s.tr.mat.map(x2,y2, bx,by);
+    s.tr.mat.map(x2,y1, cx,cy);
+    // rotation by 90 degrees moves u to vertical axis; leave it to polygon path
+    if(T_LIKELY(cy==ay)) {
+      if(T_UNLIKELY(ax>=bx)) {
+        if(T_UNLIKELY(ax==bx))
+          return;
+        std::swap(ax,bx);
+        std::swap(u1,u2);
+        }
+      if(T_UNLIKELY(ay>=by)) {
+        if(T_UNLIKELY(ay==by))
+          return;
+        std::swap(ay,by);
+        std::swap(v1,v2);
+        }
+      implDrawRectAA(ax,ay,bx,by, u1,v1,u2,v2);
+      return;
+      }
+    }
+
+  float x[4] = {x1, x2, x2, x1};
+  float y[4] = {y1, y1, y2, y2};
   for(size_t i=0;i<4;++i)
     s.tr.mat.map(x[i],y[i],x[i],y[i]);
-
-  FPoint trigBuf[4+4+4+4];
-  implDrawTrig( x[0], y[0], u1, v1,
-      x[1], y[1], u2, v1,
-      x[2], y[2], u2, v2,
-      trigBuf, 0 );
-  implDrawTrig(x[0],y[0], u1,v1,
-      x[2],y[2], u2,v2,
-      x[3],y[3], u1,v2,
-      trigBuf, 0 );
+  implDrawQuad(x,y, u1,v1,u2,v2);
   }
 
 void Painter::implDrawWideLine(float width, int x1, int y1, int x2, int y2) {
@@ -367,16 +409,7 @@ void Painter::implDrawWideLine(float width, int x1, int y1, int x2, int y2) {
   float y[4] = {float(y1)-ortho.y, float(y2)-ortho.y, float(y2)+ortho.y, float(y1)+ortho.y};
   for(size_t i=0;i<4;++i)
     s.tr.mat.map(x[i],y[i],x[i],y[i]);
-
-  FPoint trigBuf[4+4+4+4];
-  implDrawTrig( x[0], y[0], u1, v1,
-      x[1], y[1], u2, v1,
-      x[2], y[2], u2, v2,
-      trigBuf, 0 );
-  implDrawTrig(x[0],y[0], u1,v1,
-      x[2],y[2], u2,v2,
-      x[3],y[3], u1,v2,
-      trigBuf, 0 );
+  implDrawQuad(x,y, u1,v1,u2,v2);
   }
 
 void Painter::drawRect(float x, float y, float w, float h, float u1, float v1, float u2, float v2) {
@@ -478,8 +511,9 @@ void Painter::drawLine(int ix1, int iy1, int ix2, int iy2) {
     state=StPen;
     implPen(s.pn);
     }
-  implAddPoint(x1+0.5f,y1+0.5f, 0,0);
-  implAddPoint(x2+0.5f,y2+0.5f, 0,0);
+  auto* p = dev.allocPoints(2);
+  implSetPoint(p[0], x1+0.5f,y1+0.5f, 0,0);
+  implSetPoint(p[1], x2+0.5f,y2+0.5f, 0,0);
   }
 
 void Painter::drawLine(const Point& a, const Point& b) {
@@ -490,6 +524,16 @@ void Painter::setFont(const Font &f) {
   s.fnt=f;
   }
 
+void Painter::setTextOutline(float width, const Color& c) {
+  s.fx.outline      = std::max(width,0.f);
+  s.fx.outlineColor = c;
+  }
+
+void Painter::setTextGlow(float width, const Color& c) {
+  s.fx.glow      = std::max(width,0.f);
+  s.fx.glowColor = c;
+  }
+
 void Painter::translate(const Point& p) {
   s.tr.mat.translate(p);
   }
@@ -523,33 +567,12 @@ void Painter::popState() {
 void Painter::drawText(int x, int y, const char *txt) {
   if(txt==nullptr)
     return;
-  auto pb = s.br;
-  auto fx = s.fnt;
-  const float kH = 1.f/s.tr.mat.scaleHintH();
-  const float kV = 1.f/s.tr.mat.scaleHintV();
-  fx.setPixelSize(std::ceil(fx.pixelSize()*s.tr.mat.scaleHint()));
-  Utf8Iterator i(txt);
-  while(i.hasData()) {
-    auto c = i.next();
-    if(c=='\0'){
-      setBrush(pb);
-      return;
-      }
-
-    auto l = s.fnt.letterGeometry(c);
-    if(!l.size.isEmpty()) {
-      auto& v     = fx.letter(c,ta);
-      float dposX = float(v.dpos.x*kH), dposY = float(v.dpos.y*kV);
-      float szX   = float(v.size.w*kH), szY   = float(v.size.h*kV);
-
-      setBrush(Brush(v.view,pb.color,PaintDevice::Alpha));
-      drawRect(float(x)+dposX,float(y)+dposY,szX,szY,
-               0.f,0.f,float(v.view.w()),float(v.view.h()));
-      }
+  auto l = TextLayout::get(s.fnt,txt,TextLayout::SingleLine,&ta,s.tr.mat);
+  drawText(x,y,*l);
+  }
 
-    x += l.advance.x;
-    }
-  setBrush(pb);
+void Painter::drawText(int x, int y, const TextLayout& l) {
+  implDrawText(float(x),float(y),l,0,NoAlign);
   }
 
 void Painter::drawText(int x, int y, const char16_t *txt) {
@@ -587,114 +610,44 @@ void Painter::drawText(int x, int y, const std::u16string &txt) {
   return drawText(x,y,txt.c_str());
   }
 
-static int calcLineWidth(Utf8Iterator i, Utf8Iterator eol, const Font& fnt, TextureAtlas& ta) {
-  int x = 0;
-  while(i!=eol){
-    auto c=i.next();
-    if(c=='\0')
-      return x;
-    if(c=='\n' || c=='\r')
-      continue;
-    auto l=fnt.letter(c,ta);
-    x += l.advance.x;
-    }
-  return x;
-  }
-
-static int calcTextHeight(const char* txt, const int w, int& l0, const Font& fnt) {
-  int x = 0,  y=0, cnt = 0;
-
-  Utf8Iterator i(txt);
-  while(i.hasData()) {
-    Utf8Iterator eol = i.advanceByLine(x,w,fnt);
-    if(i==eol)
-      break;
-    cnt++;
-    x = 0;
-    if(cnt>1) {
-      i = eol;
-      continue;
-      }
-    while(i!=eol){
-      auto c=i.next();
-      if(c=='\0'){
-        return y;
-        }
-      if(c=='\n' || c=='\r') {
-        continue;
-        }
-      auto l=fnt.letterGeometry(c);
-      y = std::max(l.size.h+l.dpos.y,y);
-      }
-    }
-
-  l0 = y;
-  if(cnt>1)
-    y += (cnt-1)*int(std::ceil(fnt.pixelSize()));
-  return y;
-  }
-
 void Painter::drawText(int rx, int ry, int w, int h, const char *txt, AlignFlag flg) {
   if(txt==nullptr)
     return;
-  auto pb = s.br;
-  auto fx = s.fnt;
-  const float kH = 1.f/s.tr.mat.scaleHintH();
-  const float kV = 1.f/s.tr.mat.scaleHintV();
-  fx.setPixelSize(std::ceil(fx.pixelSize()*s.tr.mat.scaleHint()));
-
-  int  x = 0, y = 0, pSz = int(std::ceil(s.fnt.pixelSize()));
+  auto l = TextLayout::get(s.fnt,txt,w,&ta,s.tr.mat);
 
+  int y = 0;
   if(flg!=0) {
-    int l0=0;
-    const int th = calcTextHeight(txt,w,l0,s.fnt);
+    const int th = l->height(), l0 = l->firstLine();
     if(flg & AlignVCenter)
       y = l0+(h-th)/2;
     else if(flg & AlignBottom)
       y = l0+(h-th);
     }
-
-  Utf8Iterator i(txt);
-  while(i.hasData()) {
-    // make next line
-    x = 0;
-    Utf8Iterator eol = i.advanceByLine(x,w,s.fnt);
-    if(i==eol)
-      break;
-
-    x = 0;
-    if(flg & AlignHCenter) {
-      int wl = calcLineWidth(i,eol,s.fnt,ta);
-      x += (w-wl)/2;
-      }
-    else if(flg & AlignRight) {
-      int wl = calcLineWidth(i,eol,s.fnt,ta);
-      x += (w-wl);
-      }
-
-    while(i!=eol) {
-      auto c=i.next();
-      if(c=='\0'){
-        setBrush(pb);
-        return;
-        }
-      if(c=='\n' || c=='\r')
+  implDrawText(float(rx),float(ry+y),*l,w,flg);
+  }
+
+void Painter::implDrawText(float x, float y, const TextLayout& l, int w, AlignFlag flg) {
+  auto  pb = s.br;
+  auto& g  = l.glyphs();
+  for(auto& ln:l.lines()) {
+    float dx = x;
+    if(flg & AlignHCenter)
+      dx += float((w-ln.width)/2);
+    else if(flg & AlignRight)
+      dx += float(w-ln.width);
+
+    for(size_t i=ln.begin; i<ln.end; ++i) {
+      auto& v = g[i];
+      if(v.view.isEmpty())
         continue;
-      auto l=s.fnt.letterGeometry(c);
-
-      if(!l.size.isEmpty()) {
-        auto& v     = fx.letter(c,ta);
-        float dposX = float(v.dpos.x*kH), dposY = float(v.dpos.y*kV);
-        float szX   = float(v.size.w*kH), szY   = float(v.size.h*kV);
-
-        setBrush(Brush(v.view,pb.color,PaintDevice::Alpha));
-        drawRect(float(rx)+float(x)+dposX,float(ry)+float(y)+dposY,szX,szY,
-                 0.f,0.f,float(v.view.w()),float(v.view.h()));
-        }
-
-      x += l.advance.x;
+      Brush br(v.view,pb.color,PaintDevice::Alpha);
+      br.distField = l.isDistanceField();
+      if(br.distField)
+        br.fx = s.fx;
+      setBrush(br);
+      drawRect(dx+v.x,y+v.y,v.w,v.h,
+               0.f,0.f,float(v.view.w()),float(v.view.h()));
       }
-    y+=pSz;
     }
   setBrush(pb);
   }
@@ -3,6 +3,7 @@
 #include <Tempest/PaintDevice>
 #include <Tempest/Transform>
 #include <Tempest/Font>
+#include <Tempest/TextLayout>
 #include <Tempest/Brush>
 #include <Tempest/Pen>
 
@@ -34,6 +35,10 @@ class Painter {
     void setPen  (const Pen&   p);
     void setFont (const Font&  f);
 
+    // distance-field text only, see Font::setDistanceField; zero width turns effect off
+    void setTextOutline(float width, const Color& c);
+    void setTextGlow   (float width, const Color& c);
+
     void translate(const Point& p);
     void translate(int x,int y);
 
@@ -74,6 +79,7 @@ class Painter {
 
     void drawText(int x,int y,const std::string& txt);
     void drawText(int x,int y,const std::u16string& txt);
+    void drawText(int x,int y,const TextLayout& txt);
 
     void drawText(int x,int y,int w,int h,const char* txt,AlignFlag flg=NoAlign);
     void drawText(int x,int y,int w,int h,const std::string& txt,AlignFlag flg=NoAlign);
@@ -103,6 +109,7 @@ class Painter {
       Tempest::Brush br;
       Tempest::Pen   pn;
       Tempest::Font  fnt;
+      PaintDevice::TextEffect fx;
       Tr             tr;
       ScissorRect    scRect;
 
@@ -116,6 +123,8 @@ class Painter {
     PaintDevice&       dev;
     TextureAtlas&      ta;
     PaintDevice::Point pt;
+    uint32_t           ptColor = 0; // pt color as PaintDevice::Quad::color
+    bool               ptTex   = false;
 
     State              state=StNo;
     InternalState      s;
@@ -129,19 +138,23 @@ class Painter {
     void implBrush(const Brush& b);
     void implPen  (const Pen&   p);
 
-    void implAddPoint(float x, float y, float u, float v);
-    void implAddPoint(int   x, int   y, float u, float v);
+    void implSetPoint(PaintDevice::Point& p, float x, float y, float u, float v) const;
     void implSetColor(float r,float g,float b,float a);
 
     void implDrawTrig( float x0, float y0, float u0, float v0,
                        float x1, float y1, float u1, float v1,
-                       float x2, float y2, float u2, float v2,
-                       FPoint *out, int stage);
+                       float x2, float y2, float u2, float v2 );
+    void implDrawQuad(const float x[4], const float y[4],
+                      float u1, float v1, float u2, float v2);
+    void implDrawPoly(const FPoint* p, size_t n);
     void implDrawRect(int x1, int y1, int x2, int y2,
                       float u1, float v1, float u2, float v2);
+    void implDrawRectAA(float x1, float y1, float x2, float y2,
+                        float u1, float v1, float u2, float v2);
     void implDrawRectF(float x1, float y1, float x2, float y2,
                        float u1, float v1, float u2, float v2);
     void implDrawWideLine(float width, int x1,int y1,int x2,int y2);
+    void implDrawText(float x, float y, const TextLayout& l, int w, AlignFlag flg);
 
     friend class Font;
   };
@@ -0,0 +1,422 @@
+#include "pathtessellator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+static constexpr float pi = 3.14159265358979323846f;
+
+static float cross(const Vec2& a, const Vec2& b) {
+  return a.x*b.y - a.y*b.x;
+  }
+
+static Vec2 unit(const Vec2& d) {
+  const float l = d.length();
+  return l>0.f ? Vec2(d.x/l,d.y/l) : Vec2();
+  }
+
+static Vec2 normal(const Vec2& d) {
+  return Vec2(-d.y,d.x);
+  }
+
+struct PathTessellator::Edge {
+  // y0<y1; dir is +1 for edges going down in the source path
+  float x0=0, y0=0;
+  float x1=0, y1=0;
+  int   dir=0;
+
+  float xAt(float y) const {
+    return x0 + (x1-x0)*((y-y0)/(y1-y0));
+    }
+  };
+
+PathTessellator::PathTessellator(float tolerance)
+  :tolerance(tolerance) {
+  }
+
+void PathTessellator::clear() {
+  pts.clear();
+  contours.clear();
+  }
+
+void PathTessellator::moveTo(float x, float y) {
+  Contour c;
+  c.begin = pts.size();
+  c.size  = 1;
+  contours.push_back(c);
+  pts.push_back(Vec2(x,y));
+  }
+
+void PathTessellator::lineTo(float x, float y) {
+  if(contours.empty()) {
+    moveTo(x,y);
+    return;
+    }
+  const Vec2 p(x,y);
+  if(pts.back()==p && contours.back().size>0)
+    return;
+  pts.push_back(p);
+  contours.back().size++;
+  }
+
+void PathTessellator::cubicTo(float x1, float y1, float x2, float y2, float x3, float y3) {
+  if(contours.empty())
+    moveTo(x1,y1);
+  flatten(pts.back(),Vec2(x1,y1),Vec2(x2,y2),Vec2(x3,y3),0);
+  }
+
+void PathTessellator::close() {
+  if(contours.empty())
+    return;
+  auto& c = contours.back();
+  // closing point duplicates the first one
+  if(c.size>1 && pts.back()==pts[c.begin]) {
+    pts.pop_back();
+    c.size--;
+    }
+  c.closed = true;
+  }
+
+void PathTessellator::flatten(Vec2 p0, Vec2 p1, Vec2 p2, Vec2 p3, int level) {
+  // de Casteljau split, until control points are within tolerance of the chord
+  const Vec2  d  = p3-p0;
+  const float d2 = std::fabs(cross(p1-p3,d));
+  const float d3 = std::fabs(cross(p2-p3,d));
+  if(level>10 || (d2+d3)*(d2+d3) < tolerance*(d.x*d.x+d.y*d.y)) {
+    lineTo(p3.x,p3.y);
+    return;
+    }
+
+  const Vec2 p01   = (p0+p1)*0.5f;
+  const Vec2 p12   = (p1+p2)*0.5f;
+  const Vec2 p23   = (p2+p3)*0.5f;
+  const Vec2 p012  = (p01+p12)*0.5f;
+  const Vec2 p123  = (p12+p23)*0.5f;
+  const Vec2 p0123 = (p012+p123)*0.5f;
+  flatten(p0,p01,p012,p0123,level+1);
+  flatten(p0123,p123,p23,p3,level+1);
+  }
+
+void PathTessellator::fill(FillRule rule, std::vector<Vec2>& out) const {
+  fill(pts,contours,rule,out);
+  }
+
+void PathTessellator::fill(const std::vector<Vec2>& pts, const std::vector<Contour>& cnt,
+                           FillRule rule, std::vector<Vec2>& out) {
+  // scanline trapezoidation: split the plane at every vertex and edge crossing,
+  // inside of each band spans between edges are trapezoids
+  std::vector<Edge>  edges;
+  std::vector<float> ys;
+  for(auto& c:cnt) {
+    if(c.size<3)
+      continue;
+    for(size_t i=0; i<c.size; ++i) {
+      const Vec2& a = pts[c.begin+i];
+      const Vec2& b = pts[c.begin+(i+1)%c.size];
+      ys.push_back(a.y);
+      if(a.y==b.y)
+        continue;
+      Edge e;
+      if(a.y<b.y)
+        e = Edge{a.x,a.y,b.x,b.y,1}; else
+        e = Edge{b.x,b.y,a.x,a.y,-1};
+      edges.push_back(e);
+      }
+    }
+  if(edges.empty())
+    return;
+
+  std::sort(ys.begin(),ys.end());
+  ys.erase(std::unique(ys.begin(),ys.end()),ys.end());
+  std::sort(edges.begin(),edges.end(),[](const Edge& a,const Edge& b){ return a.y0<b.y0; });
+
+  struct Span {
+    const Edge* e;
+    float       xa, xb;
+    };
+  std::vector<const Edge*> active;
+  std::vector<Span>        band;
+  size_t                   next = 0;
+
+  auto emit = [&out](float xa0, float xa1, float ya, float xb0, float xb1, float yb) {
+    // (xa0,ya)-(xa1,ya) top side, (xb0,yb)-(xb1,yb) bottom side
+    if(xa1-xa0>0.f) {
+      out.push_back(Vec2(xa0,ya));
+      out.push_back(Vec2(xa1,ya));
+      out.push_back(Vec2(xb1,yb));
+      }
+    if(xb1-xb0>0.f) {
+      out.push_back(Vec2(xa0,ya));
+      out.push_back(Vec2(xb1,yb));
+      out.push_back(Vec2(xb0,yb));
+      }
+    };
+
+  for(size_t yi=0; yi+1<ys.size(); ++yi) {
+    const float yEnd = ys[yi+1];
+    float       ya   = ys[yi];
+
+    active.erase(std::remove_if(active.begin(),active.end(),[ya](const Edge* e){ return e->y1<=ya; }),active.end());
+    while(next<edges.size() && edges[next].y0<=ya) {
+      if(edges[next].y1>ya)
+        active.push_back(&edges[next]);
+      ++next;
+      }
+    if(active.empty())
+      continue;
+
+    while(ya<yEnd) {
+      band.clear();
+      for(auto e:active)
+        band.push_back(Span{e,e->xAt(ya),e->xAt(yEnd)});
+      std::sort(band.begin(),band.end(),[](const Span& a,const Span& b){
+        return a.xa<b.xa || (a.xa==b.xa && a.xb<b.xb);
+        });
+
+      // first crossing is always between neighbours at the top of the band
+      float yb = yEnd;
+      for(size_t i=0; i+1<band.size(); ++i) {
+        const Span& l = band[i];
+        const Span& r = band[i+1];
+        if(l.xb<=r.xb)
+          continue;
+        const float t  = (r.xa-l.xa)/((l.xb-l.xa)-(r.xb-r.xa));
+        const float yc = ya+(yEnd-ya)*t;
+        if(yc>ya && yc<yb)
+          yb = yc;
+        }
+      if(yb<yEnd && yb-ya<1e-4f*std::max(1.f,std::fabs(ya)))
+        yb = std::min(yEnd, ya+1e-4f*std::max(1.f,std::fabs(ya)));
+
+      if(yb<yEnd) {
+        for(auto& s:band)
+          s.xb = s.e->xAt(yb);
+        std::sort(band.begin(),band.end(),[](const Span& a,const Span& b){
+          return (a.xa+a.xb)<(b.xa+b.xb);
+          });
+        }
+
+      int winding = 0;
+      for(size_t i=0; i<band.size(); ++i) {
+        const bool in0 = (rule==NonZero) ? winding!=0 : (winding&1)!=0;
+        winding += band[i].e->dir;
+        const bool in1 = (rule==NonZero) ? winding!=0 : (winding&1)!=0;
+        if(!in0 && in1) {
+          size_t j = i+1;
+          for(; j<band.size(); ++j) {
+            winding += band[j].e->dir;
+            if(!((rule==NonZero) ? winding!=0 : (winding&1)!=0))
+              break;
+            }
+          if(j==band.size())
+            break;
+          emit(band[i].xa,band[j].xa,ya,band[i].xb,band[j].xb,yb);
+          i = j;
+          }
+        }
+      ya = yb;
+      }
+    }
+  }
+
+void PathTessellator::stroke(const Stroke& st, std::vector<Vec2>& out) const {
+  if(!(st.width>0.f))
+    return;
+
+  // every segment, join and cap is a ccw polygon; their nonzero union is the stroke
+  std::vector<Vec2>    poly;
+  std::vector<Contour> cnt;
+  for(auto& c:contours) {
+    if(st.dashCount>0)
+      dashContour(&pts[c.begin],c.size,c.closed,st,poly,cnt); else
+      strokeContour(&pts[c.begin],c.size,c.closed,st,poly,cnt);
+    }
+  fill(poly,cnt,NonZero,out);
+  }
+
+void PathTessellator::dashContour(const Vec2* p, size_t n, bool closed, const Stroke& st,
+                                  std::vector<Vec2>& poly, std::vector<Contour>& cnt) const {
+  // odd dash lists are repeated, as in svg
+  const size_t count = (st.dashCount%2==1) ? st.dashCount*2 : st.dashCount;
+  float        total = 0;
+  for(size_t i=0; i<count; ++i)
+    total += std::max(0.f,st.dash[i%st.dashCount]);
+  if(!(total>0.f)) {
+    strokeContour(p,n,closed,st,poly,cnt);
+    return;
+    }
+
+  auto dashLen = [&st](size_t i) { return std::max(0.f,st.dash[i%st.dashCount]); };
+
+  size_t id   = 0;
+  float  left = std::fmod(st.dashOffset,total);
+  if(left<0)
+    left += total;
+  while(left>=dashLen(id)) {
+    left -= dashLen(id);
+    id    = (id+1)%count;
+    }
+  left = dashLen(id)-left;
+
+  std::vector<Vec2> dash;
+  if(id%2==0)
+    dash.push_back(p[0]);
+
+  const size_t segs = closed ? n : n-1;
+  for(size_t i=0; i<segs; ++i) {
+    Vec2        a   = p[i];
+    const Vec2  b   = p[(i+1)%n];
+    float       len = (b-a).length();
+    while(len>left) {
+      a    = a+(b-a)*(left/len);
+      len -= left;
+      dash.push_back(a);
+      if(id%2==0) {
+        strokeContour(dash.data(),dash.size(),false,st,poly,cnt);
+        dash.clear();
+        }
+      id   = (id+1)%count;
+      left = dashLen(id);
+      }
+    left -= len;
+    if(id%2==0)
+      dash.push_back(b);
+    }
+  if(id%2==0 && dash.size()>1)
+    strokeContour(dash.data(),dash.size(),false,st,poly,cnt);
+  }
+
+void PathTessellator::arc(Vec2 c, float r, float a0, float a1, std::vector<Vec2>& poly) const {
+  const float da  = 2.f*std::acos(std::max(-1.f,1.f-tolerance/std::max(r,tolerance)));
+  const int   seg = std::max(1,std::min(256,int(std::ceil(std::fabs(a1-a0)/std::max(da,1e-3f)))));
+  for(int i=0; i<=seg; ++i) {
+    const float a = a0+(a1-a0)*float(i)/float(seg);
+    poly.push_back(Vec2(c.x+std::cos(a)*r,c.y+std::sin(a)*r));
+    }
+  }
+
+void PathTessellator::strokeContour(const Vec2* src, size_t n, bool closed, const Stroke& st,
+                                    std::vector<Vec2>& poly, std::vector<Contour>& cnt) const {
+  const float hw = st.width*0.5f;
+
+  auto commit = [&poly,&cnt](size_t begin) {
+    Contour c;
+    c.begin  = begin;
+    c.size   = poly.size()-begin;
+    c.closed = true;
+    float area = 0;
+    for(size_t i=0; i<c.size; ++i)
+      area += cross(poly[begin+i],poly[begin+(i+1)%c.size]);
+    if(area<0)
+      std::reverse(poly.begin()+ptrdiff_t(begin),poly.end());
+    cnt.push_back(c);
+    };
+
+  std::vector<Vec2> p;
+  p.reserve(n);
+  for(size_t i=0; i<n; ++i)
+    if(p.empty() || p.back()!=src[i])
+      p.push_back(src[i]);
+  if(closed && p.size()>1 && p.back()==p.front())
+    p.pop_back();
+
+  if(p.size()==1) {
+    // zero length subpath: only caps are visible
+    const size_t b = poly.size();
+    if(st.cap==RoundCap) {
+      arc(p[0],hw,0,2.f*pi,poly);
+      poly.pop_back();
+      commit(b);
+      }
+    else if(st.cap==SquareCap) {
+      poly.push_back(Vec2(p[0].x-hw,p[0].y-hw));
+      poly.push_back(Vec2(p[0].x+hw,p[0].y-hw));
+      poly.push_back(Vec2(p[0].x+hw,p[0].y+hw));
+      poly.push_back(Vec2(p[0].x-hw,p[0].y+hw));
+      commit(b);
+      }
+    return;
+    }
+  if(p.size()<2)
+    return;
+
+  const size_t segs = closed ? p.size() : p.size()-1;
+  for(size_t i=0; i<segs; ++i) {
+    const Vec2 a = p[i];
+    const Vec2 b = p[(i+1)%p.size()];
+    const Vec2 d = unit(b-a);
+    const Vec2 o = normal(d)*hw;
+
+    const size_t beg = poly.size();
+    poly.push_back(a+o);
+    poly.push_back(b+o);
+    poly.push_back(b-o);
+    poly.push_back(a-o);
+    commit(beg);
+    }
+
+  // joins
+  const size_t first = closed ? 0 : 1;
+  const size_t last  = closed ? p.size() : p.size()-1;
+  for(size_t i=first; i<last; ++i) {
+    const Vec2  c  = p[i];
+    const Vec2  d0 = unit(c-p[(i+p.size()-1)%p.size()]);
+    const Vec2  d1 = unit(p[(i+1)%p.size()]-c);
+    const float cr = cross(d0,d1);
+    const float dt = Vec2::dotProduct(d0,d1);
+    if(std::fabs(cr)<1e-6f && dt>0)
+      continue;
+
+    // outer side of the turn
+    const float s  = cr>0 ? -1.f : 1.f;
+    const Vec2  o0 = normal(d0)*(hw*s);
+    const Vec2  o1 = normal(d1)*(hw*s);
+
+    const size_t beg = poly.size();
+    if(st.join==RoundJoin) {
+      // short way from o0 to o1 is the outer side
+      const float a0 = std::atan2(o0.y,o0.x);
+      const float a1 = a0+std::atan2(cross(o0,o1),Vec2::dotProduct(o0,o1));
+      poly.push_back(c);
+      arc(c,hw,a0,a1,poly);
+      }
+    else {
+      poly.push_back(c);
+      poly.push_back(c+o0);
+      const float cosHalf = std::sqrt(std::max(0.f,(1.f+dt)*0.5f));
+      if(st.join==MiterJoin && cosHalf>1e-6f && 1.f/cosHalf<=st.miterLimit) {
+        const Vec2 m = unit(o0+o1)*(hw/cosHalf);
+        poly.push_back(c+m);
+        }
+      poly.push_back(c+o1);
+      }
+    commit(beg);
+    }
+
+  if(closed)
+    return;
+
+  // caps
+  for(int side=0; side<2; ++side) {
+    const Vec2 c = side==0 ? p.front() : p.back();
+    const Vec2 d = side==0 ? unit(p[0]-p[1]) : unit(p[p.size()-1]-p[p.size()-2]);
+    const Vec2 o = normal(d)*hw;
+
+    const size_t beg = poly.size();
+    if(st.cap==RoundCap) {
+      const float a = std::atan2(o.y,o.x);
+      arc(c,hw,a,a-pi,poly);
+      commit(beg);
+      }
+    else if(st.cap==SquareCap) {
+      poly.push_back(c+o);
+      poly.push_back(c+o+d*hw);
+      poly.push_back(c-o+d*hw);
+      poly.push_back(c-o);
+      commit(beg);
+      }
+    }
+  }
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Tempest/Point>
+
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+class PathTessellator final {
+  public:
+    enum FillRule : uint8_t {
+      NonZero,
+      EvenOdd,
+      };
+
+    enum Join : uint8_t {
+      MiterJoin,
+      RoundJoin,
+      BevelJoin,
+      };
+
+    enum Cap : uint8_t {
+      ButtCap,
+      RoundCap,
+      SquareCap,
+      };
+
+    struct Stroke {
+      float        width      = 1.f;
+      Join         join       = MiterJoin;
+      Cap          cap        = ButtCap;
+      float        miterLimit = 4.f;
+      const float* dash       = nullptr;
+      size_t       dashCount  = 0;
+      float        dashOffset = 0.f;
+      };
+
+    // max distance between a curve and its polyline, in path units
+    explicit PathTessellator(float tolerance = 0.25f);
+
+    void clear();
+    void moveTo (float x, float y);
+    void lineTo (float x, float y);
+    void cubicTo(float x1, float y1, float x2, float y2, float x3, float y3);
+    void close();
+
+    // output is a triangle list, without overlaps
+    void fill  (FillRule rule, std::vector<Vec2>& out) const;
+    void stroke(const Stroke& st, std::vector<Vec2>& out) const;
+
+  private:
+    struct Contour {
+      size_t begin  = 0;
+      size_t size   = 0;
+      bool   closed = false;
+      };
+
+    struct Edge;
+
+    void flatten(Vec2 p0, Vec2 p1, Vec2 p2, Vec2 p3, int level);
+
+    static void fill(const std::vector<Vec2>& pts, const std::vector<Contour>& cnt, FillRule rule, std::vector<Vec2>& out);
+
+    void strokeContour(const Vec2* p, size_t n, bool closed, const Stroke& st,
+                       std::vector<Vec2>& poly, std::vector<Contour>& cnt) const;
+    void dashContour  (const Vec2* p, size_t n, bool closed, const Stroke& st,
+                       std::vector<Vec2>& poly, std::vector<Contour>& cnt) const;
+    void arc          (Vec2 c, float r, float a0, float a1, std::vector<Vec2>& poly) const;
+
+    float             tolerance = 0.25f;
+    std::vector<Vec2> pts;
+    std::vector<Contour> contours;
+  };
+
+}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+// cpu copy of gpu buffer: doesn't shrink and grows twice at least, to not be recreated on every change
+template<class T>
+void growShadow(std::vector<T>& shadow, const std::vector<T>& src) {
+  shadow.resize(std::max(src.size(),shadow.size()*2));
+  std::copy(src.begin(),src.end(),shadow.begin());
+  }
+
+// copies src to the shadow, calls fn with byte ranges, that changed; returns size of them
+template<class T, class Fn>
+size_t updateDirty(std::vector<T>& shadow, const std::vector<T>& src, Fn fn) {
+  static constexpr size_t Chunk = 16;
+  auto*        dst  = reinterpret_cast<uint8_t*>(shadow.data());
+  auto*        from = reinterpret_cast<const uint8_t*>(src.data());
+  const size_t size = src.size()*sizeof(T);
+  const size_t step = Chunk*sizeof(T);
+
+  size_t total = 0;
+  for(size_t i=0; i<size;) {
+    if(std::memcmp(dst+i,from+i,std::min(step,size-i))==0) {
+      i += step;
+      continue;
+      }
+    // adjacent chunks, that changed, go in one update
+    size_t end = std::min(i+step,size);
+    while(end<size && std::memcmp(dst+end,from+end,std::min(step,size-end))!=0)
+      end = std::min(end+step,size);
+    std::memcpy(dst+i,from+i,end-i);
+    fn(i,end-i);
+    total += end-i;
+    i      = end;
+    }
+  return total;
+  }
+
+}
+}
@@ -6,15 +6,32 @@
 #include <Tempest/Event>
 #include <Tempest/Encoder>
 
+#include "../io/mappedfile.h"
+#include "pathtessellator.h"
+#include "shadowbuffer.h"
+
 #define  NANOSVG_IMPLEMENTATION
 #include "thirdparty/nanosvg.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
 using namespace Tempest;
 
 void VectorImage::beginPaint(bool clr, uint32_t w, uint32_t h) {
+  // first painter after clear() defines size: window paints with Painter::Preserve
+  const bool empty = buf.empty() && quads.empty();
   if(clr || blocks.size()==0)
     clear();
-  if(clr) {
+  if(clr || empty) {
     info.w=w;
     info.h=h;
     }
@@ -42,9 +59,9 @@ void VectorImage::popState(size_t id) {
     b=s;
     } else {
     blocks.emplace_back(s);
-    blocks.back().begin =buf.size();
     blocks.back().size  =0;
     }
+  blocks.back().begin = tail(blocks.back());
   stateStk.resize(id);
   }
 
@@ -56,13 +73,14 @@ void VectorImage::setState(const T &t) {
 
   if(blocks.back().size==0){
     blocks.back().*param=t;
+    blocks.back().begin =tail(blocks.back());
     return;
     }
 
   blocks.push_back(blocks.back());
-  blocks.back().begin =buf.size();
-  blocks.back().size  =0;
   blocks.back().*param=t;
+  blocks.back().begin =tail(blocks.back());
+  blocks.back().size  =0;
   }
 
 void VectorImage::setState(const TexPtr &t, const Color&, TextureFormat frm, ClampMode clamp) {
@@ -71,8 +89,8 @@ void VectorImage::setState(const TexPtr &t, const Color&, TextureFormat frm, Cla
   blocks.back().hasImg=bool(t);
   }
 
-void VectorImage::setState(const Sprite &s, const Color&) {
-  Texture tex={TexPtr(),TextureFormat::Undefined,ClampMode::Repeat,s};
+void VectorImage::setState(const Sprite &s, const Color&, bool distanceField, const TextEffect& fx) {
+  Texture tex={TexPtr(),TextureFormat::Undefined,ClampMode::Repeat,s,distanceField,distanceField ? fx : TextEffect()};
   setState<Texture,&State::tex>(tex);
   blocks.back().hasImg=!s.isEmpty();
 
@@ -88,18 +106,183 @@ void VectorImage::setBlend(const Painter::Blend b) {
   }
 
 void VectorImage::clear() {
+  if(retained && !ranges.empty()) {
+    std::swap(prev.blocks,blocks);
+    std::swap(prev.buf,   buf);
+    std::swap(prev.quads, quads);
+    std::swap(prev.ranges,ranges);
+    prevAt = 0;
+    }
   buf.clear();
+  quads.clear();
   blocks.resize(1);
   blocks.back()=Block();
   stateStk.clear();
   slock.clear();
+  ranges.clear();
+  rangeStk.clear();
+  }
+
+void VectorImage::setRetained(bool r) {
+  retained = r;
+  if(!retained)
+    prev = Frame();
+  }
+
+void VectorImage::cut() {
+  // next geometry goes to a new block, so ranges don't share blocks
+  if(blocks.back().size!=0) {
+    blocks.push_back(blocks.back());
+    blocks.back().size = 0;
+    }
+  blocks.back().begin = tail(blocks.back());
+  }
+
+void VectorImage::beginRange(const RangeKey& k) {
+  if(!retained)
+    return;
+  cut();
+  rangeStk.push_back(ranges.size());
+  ranges.emplace_back();
+  ranges.back().key   = k;
+  ranges.back().begin = blocks.size()-1;
+  }
+
+void VectorImage::endRange() {
+  if(rangeStk.empty())
+    return;
+  cut();
+  auto& r = ranges[rangeStk.back()];
+  r.end    = blocks.size()-1;
+  r.nested = ranges.size()-rangeStk.back()-1;
+  rangeStk.pop_back();
+  }
+
+bool VectorImage::replayRange(const RangeKey& k) {
+  if(!retained || prev.ranges.empty())
+    return false;
+
+  // widgets are painted in same order, as on previous frame: search starts after last hit
+  const size_t cnt = prev.ranges.size();
+  size_t       id  = cnt;
+  for(size_t i=0; i<cnt; ++i) {
+    const size_t at = (prevAt+i)%cnt;
+    if(prev.ranges[at].key==k) {
+      id = at;
+      break;
+      }
+    }
+  if(id==cnt && k.movable)
+    id = findMoved(k);
+  if(id==cnt)
+    return false;
+
+  const Range& r  = prev.ranges[id];
+  const int32_t dx = k.x-r.key.x;
+  const int32_t dy = k.y-r.key.y;
+  prevAt = id+r.nested+1;
+
+  cut();
+  if(blocks.size()>1)
+    blocks.pop_back();
+  const size_t base = blocks.size();
+  const size_t end  = std::min(r.end,prev.blocks.size());
+  for(size_t i=r.begin; i<end; ++i) {
+    const Block& b = prev.blocks[i];
+    blocks.push_back(b);
+    if(b.instanced) {
+      blocks.back().begin = quads.size();
+      quads.insert(quads.end(),prev.quads.begin()+ptrdiff_t(b.begin),prev.quads.begin()+ptrdiff_t(b.begin+b.size));
+      } else {
+      blocks.back().begin = buf.size();
+      buf.insert(buf.end(),prev.buf.begin()+ptrdiff_t(b.begin),prev.buf.begin()+ptrdiff_t(b.begin+b.size));
+      }
+    if(dx!=0 || dy!=0)
+      translate(blocks.back(),dx,dy,k);
+    if(b.hasImg && !b.tex.brush)
+      slock.insert(b.tex.sprite);
+    }
+  if(blocks.empty())
+    blocks.emplace_back();
+
+  // nested ranges stay retained on their own
+  for(size_t i=id; i<=id+r.nested && i<cnt; ++i) {
+    Range n = prev.ranges[i];
+    n.begin  = n.begin-r.begin+base;
+    n.end    = n.end  -r.begin+base;
+    n.key.x += dx;
+    n.key.y += dy;
+    ranges.push_back(n);
+    }
+  cut();
+  return true;
+  }
+
+size_t VectorImage::findMoved(const RangeKey& k) const {
+  const size_t cnt = prev.ranges.size();
+  for(size_t i=0; i<cnt; ++i) {
+    const size_t    at = (prevAt+i)%cnt;
+    const RangeKey& p  = prev.ranges[at].key;
+    if(p.owner==k.owner && p.movable && p.vx==k.vx && p.vy==k.vy && p.vw==k.vw && p.vh==k.vh && p.w==k.w && p.h==k.h)
+      return at;
+    }
+  return cnt;
+  }
+
+void VectorImage::translate(const Block& b, int32_t dx, int32_t dy, const RangeKey& k) {
+  // points are in normalized device coordinates
+  const float tx = float(dx)*2.f/float(k.w);
+  const float ty = float(dy)*2.f/float(k.h);
+  if(b.instanced) {
+    for(size_t i=b.begin; i<b.begin+b.size; ++i) {
+      Quad& q = quads[i];
+      q.x0 += tx;
+      q.x1 += tx;
+      q.y0 += ty;
+      q.y1 += ty;
+      }
+    } else {
+    for(size_t i=b.begin; i<b.begin+b.size; ++i) {
+      buf[i].x += tx;
+      buf[i].y += ty;
+      }
+    }
   }
 
 void VectorImage::addPoint(const PaintDevice::Point &p) {
+  if(T_UNLIKELY(blocks.back().instanced))
+    setState<bool,&State::instanced>(false);
   buf.push_back(p);
   blocks.back().size++;
   }
 
+void VectorImage::addPoints(const PaintDevice::Point* p, size_t count) {
+  if(T_UNLIKELY(blocks.back().instanced))
+    setState<bool,&State::instanced>(false);
+  buf.insert(buf.end(),p,p+count);
+  blocks.back().size+=count;
+  }
+
+PaintDevice::Point* VectorImage::allocPoints(size_t count) {
+  if(T_UNLIKELY(blocks.back().instanced))
+    setState<bool,&State::instanced>(false);
+  const size_t at = buf.size();
+  buf.resize(at+count);
+  blocks.back().size+=count;
+  return buf.data()+at;
+  }
+
+PaintDevice::Quad* VectorImage::allocQuads(size_t count) {
+  static_assert(sizeof(Quad)==32, "must match Quad in brush.vert");
+  if(blocks.back().tp!=Triangles)
+    return nullptr;
+  setState<bool,&State::instanced>(true);
+  const size_t at = quads.size();
+  quads.resize(at+count);
+  blocks.back().size+=count;
+  return quads.data()+at;
+  }
+
 void VectorImage::commitPoints() {
   blocks.resize(blocks.size());
 
@@ -110,9 +293,34 @@ void VectorImage::commitPoints() {
     }
   }
 
-const RenderPipeline& VectorImage::pipelineOf(Device& dev, const VectorImage::Block& b) const {
+const RenderPipeline& VectorImage::pipelineOf(Device& dev, const VectorImage::Block& b, bool pages) const {
   const RenderPipeline* p;
-  if(b.hasImg) {
+  if(pages) {
+    auto& it = b.tex.distField ? dev.builtin().distanceField() : dev.builtin().texture2d();
+    if(b.tex.distField || b.blend==Alpha)
+      p=&it.pagesB; else
+    if(b.blend==NoBlend)
+      p=&it.pages; else
+      p=&it.pagesA;
+    return *p;
+    }
+  if(b.instanced) {
+    if(b.hasImg && b.tex.distField)
+      return dev.builtin().distanceField().quadB;
+    auto& it = b.hasImg ? dev.builtin().texture2d() : dev.builtin().empty();
+    if(b.blend==NoBlend)
+      p=&it.quad; else
+    if(b.blend==Alpha)
+      p=&it.quadB; else
+      p=&it.quadA;
+    return *p;
+    }
+  if(b.hasImg && b.tex.distField) {
+    if(b.tp==Triangles)
+      p=&dev.builtin().distanceField().brushB; else
+      p=&dev.builtin().distanceField().penB;
+    }
+  else if(b.hasImg) {
     if(b.tp==Triangles){
       if(b.blend==NoBlend)
         p=&dev.builtin().texture2d().brush; else
@@ -144,26 +352,495 @@ const RenderPipeline& VectorImage::pipelineOf(Device& dev, const VectorImage::Bl
   return *p;
   }
 
+VectorImage::Bounds VectorImage::boundsOf(const Block& b) const {
+  Bounds r = {1.f,1.f,-1.f,-1.f};
+  if(b.instanced) {
+    for(size_t i=b.begin; i<b.begin+b.size; ++i) {
+      auto& q = quads[i];
+      r.x0 = std::min(r.x0,q.x0);
+      r.y0 = std::min(r.y0,q.y0);
+      r.x1 = std::max(r.x1,q.x1);
+      r.y1 = std::max(r.y1,q.y1);
+      }
+    } else {
+    for(size_t i=b.begin; i<b.begin+b.size; ++i) {
+      auto& p = buf[i];
+      r.x0 = std::min(r.x0,p.x);
+      r.y0 = std::min(r.y0,p.y);
+      r.x1 = std::max(r.x1,p.x);
+      r.y1 = std::max(r.y1,p.y);
+      }
+    }
+  if(b.tp==Lines) {
+    // lines are rasterized with width, even when axis-aligned
+    const float px = 4.f/float(std::max<uint32_t>(std::min(info.w,info.h),1));
+    r = {r.x0-px, r.y0-px, r.x1+px, r.y1+px};
+    }
+  return r;
+  }
+
+bool VectorImage::Batch::intersects(const Bounds& b) const {
+  for(uint8_t i=0; i<boxes; ++i)
+    if(box[i].intersects(b))
+      return true;
+  return false;
+  }
+
+void VectorImage::Batch::add(const Bounds& b) {
+  auto unite = [](const Bounds& a, const Bounds& b) {
+    return Bounds{std::min(a.x0,b.x0), std::min(a.y0,b.y0), std::max(a.x1,b.x1), std::max(a.y1,b.y1)};
+    };
+  auto area  = [](const Bounds& a) { return (a.x1-a.x0)*(a.y1-a.y0); };
+
+  if(boxes<std::size(box)) {
+    box[boxes++] = b;
+    return;
+    }
+  // grow the box, that grows least
+  size_t id   = 0;
+  float  cost = std::numeric_limits<float>::max();
+  for(size_t i=0; i<std::size(box); ++i) {
+    const float c = area(unite(box[i],b)) - area(box[i]);
+    if(c<cost) {
+      cost = c;
+      id   = i;
+      }
+    }
+  box[id] = unite(box[id],b);
+  }
+
+bool VectorImage::merge(Batch& bt, const Block& b, uint8_t& slot) const {
+  const Block& a = blocks[bt.block];
+  slot = 0;
+  if(a.tp!=b.tp || a.blend!=b.blend || a.instanced!=b.instanced || a.hasImg!=b.hasImg)
+    return false;
+  if(!a.hasImg)
+    return true;
+  if(a.tex.distField!=b.tex.distField || a.tex.brush!=b.tex.brush || !(a.tex.fx==b.tex.fx))
+    return false;
+  if(a.tex.brush)
+    return a.tex.frm==b.tex.frm && a.tex.clamp==b.tex.clamp;
+
+  const void* id = b.tex.sprite.pageId();
+  for(uint8_t i=0; i<bt.pages; ++i)
+    if(bt.page[i]->pageId()==id) {
+      slot = i;
+      return true;
+      }
+  // only quads carry a page index
+  if(!a.instanced || bt.pages>=MaxPages)
+    return false;
+  slot = bt.pages;
+  bt.page[bt.pages++] = &b.tex.sprite;
+  return true;
+  }
+
+void VectorImage::batch(std::vector<Batch>& out, std::vector<Point>& pts, std::vector<Quad>& qs) const {
+  // block moves back to an earlier batch, if no batch in between overlaps it
+  static constexpr size_t Window = 32;
+  static constexpr uint32_t None = uint32_t(-1);
+
+  struct Dst {
+    uint32_t batch = None;
+    uint8_t  slot  = 0;
+    };
+  std::vector<Dst> dst(blocks.size());
+
+  out.clear();
+  for(size_t i=0; i<blocks.size(); ++i) {
+    auto& b = blocks[i];
+    if(b.size==0)
+      continue;
+    const Bounds box = boundsOf(b);
+    size_t       at  = out.size();
+    for(size_t j=out.size(); j>0 && out.size()-j<Window;) {
+      --j;
+      if(merge(out[j],b,dst[i].slot)) {
+        at = j;
+        break;
+        }
+      if(out[j].intersects(box))
+        break;
+      }
+
+    if(at==out.size()) {
+      out.emplace_back();
+      auto& bt = out.back();
+      bt.block = i;
+      if(b.hasImg && !b.tex.brush) {
+        bt.page[0] = &b.tex.sprite;
+        bt.pages   = 1;
+        }
+      }
+    out[at].add(box);
+    out[at].size += b.size;
+    dst[i].batch  = uint32_t(at);
+    }
+
+  size_t np = 0, nq = 0;
+  for(auto& bt:out) {
+    size_t& n = blocks[bt.block].instanced ? nq : np;
+    bt.begin = n;
+    n       += bt.size;
+    bt.size  = 0;
+    }
+  pts.resize(np);
+  qs .resize(nq);
+
+  for(size_t i=0; i<blocks.size(); ++i) {
+    auto& b = blocks[i];
+    if(dst[i].batch==None)
+      continue;
+    auto& bt = out[dst[i].batch];
+    if(b.instanced) {
+      Quad* q = qs.data()+bt.begin+bt.size;
+      std::copy(quads.begin()+ptrdiff_t(b.begin),quads.begin()+ptrdiff_t(b.begin+b.size),q);
+      for(size_t r=0; r<b.size; ++r)
+        q[r].page = dst[i].slot;
+      } else {
+      std::copy(buf.begin()+ptrdiff_t(b.begin),buf.begin()+ptrdiff_t(b.begin+b.size),pts.data()+bt.begin+bt.size);
+      }
+    bt.size += b.size;
+    }
+  }
+
+namespace {
+
+struct SvgPaint {
+  const NSVGpaint* paint   = nullptr;
+  float            opacity = 1.f;
+
+  static void unpack(unsigned int c, float opacity, float* rgba) {
+    rgba[0] = float((c    )&0xFF)/255.f;
+    rgba[1] = float((c>> 8)&0xFF)/255.f;
+    rgba[2] = float((c>>16)&0xFF)/255.f;
+    rgba[3] = float((c>>24)&0xFF)/255.f*opacity;
+    }
+
+  bool isGradient() const {
+    return paint->type==NSVG_PAINT_LINEAR_GRADIENT || paint->type==NSVG_PAINT_RADIAL_GRADIENT;
+    }
+
+  // gradient coordinate of a point, before spread is applied
+  float param(float x, float y) const {
+    const float* t  = paint->gradient->xform;
+    const float  gy = x*t[1] + y*t[3] + t[5];
+    if(paint->type==NSVG_PAINT_LINEAR_GRADIENT)
+      return gy;
+    const float  gx = x*t[0] + y*t[2] + t[4];
+    return std::sqrt(gx*gx+gy*gy);
+    }
+
+  // mid: any value inside of the piece being shaded, selects the spread period
+  void color(float t, float mid, float* rgba) const {
+    if(!isGradient()) {
+      unpack(paint->color,opacity,rgba);
+      return;
+      }
+    const NSVGgradient& g = *paint->gradient;
+    if(g.spread==NSVG_SPREAD_REPEAT) {
+      t -= std::floor(mid);
+      }
+    else if(g.spread==NSVG_SPREAD_REFLECT) {
+      const float k = 2.f*std::floor(mid*0.5f);
+      t -= k;
+      if(mid-k>1.f)
+        t = 2.f-t;
+      }
+    t = std::max(0.f,std::min(t,1.f));
+
+    const NSVGgradientStop* s = g.stops;
+    if(g.nstops<=1 || t<=s[0].offset) {
+      unpack(s[0].color,opacity,rgba);
+      return;
+      }
+    for(int i=1; i<g.nstops; ++i) {
+      if(t>s[i].offset)
+        continue;
+      float a[4], b[4];
+      unpack(s[i-1].color,opacity,a);
+      unpack(s[i  ].color,opacity,b);
+      const float d = s[i].offset-s[i-1].offset;
+      const float k = d>0.f ? (t-s[i-1].offset)/d : 1.f;
+      for(int c=0; c<4; ++c)
+        rgba[c] = a[c]+(b[c]-a[c])*k;
+      return;
+      }
+    unpack(s[g.nstops-1].color,opacity,rgba);
+    }
+
+  // values of t in (t0,t1), where color stops being linear in t
+  void cuts(float t0, float t1, std::vector<float>& out) const {
+    out.clear();
+    const NSVGgradient& g = *paint->gradient;
+    if(g.spread!=NSVG_SPREAD_REPEAT && g.spread!=NSVG_SPREAD_REFLECT) {
+      for(int i=0; i<g.nstops; ++i)
+        if(t0<g.stops[i].offset && g.stops[i].offset<t1)
+          out.push_back(g.stops[i].offset);
+      return;
+      }
+
+    const float k0 = std::floor(t0);
+    const float k1 = std::min(std::floor(t1),k0+64.f);
+    for(float k=k0; k<=k1; k+=1.f) {
+      const bool mirror = (g.spread==NSVG_SPREAD_REFLECT) && std::fmod(std::fabs(k),2.f)==1.f;
+      if(t0<k && k<t1)
+        out.push_back(k);
+      for(int i=0; i<g.nstops; ++i) {
+        const float c = mirror ? k+1.f-g.stops[i].offset : k+g.stops[i].offset;
+        if(t0<c && c<t1)
+          out.push_back(c);
+        }
+      }
+    std::sort(out.begin(),out.end());
+    }
+  };
+
+struct SvgCache {
+  struct Entry {
+    uint64_t                           hash = 0;
+    // whole file: equal hash doesn't mean equal content
+    std::string                        text;
+    std::shared_ptr<const VectorImage> img;
+    };
+
+  enum { MaxEntries = 256 };
+
+  std::mutex       sync;
+  std::list<Entry> lru;
+
+  std::shared_ptr<const VectorImage> find(uint64_t hash, const uint8_t* data, size_t size) {
+    std::lock_guard<std::mutex> guard(sync);
+    for(auto i=lru.begin(); i!=lru.end(); ++i)
+      if(i->hash==hash && i->text.size()==size && std::memcmp(i->text.data(),data,size)==0) {
+        lru.splice(lru.begin(),lru,i);
+        return i->img;
+        }
+    return nullptr;
+    }
+
+  void insert(uint64_t hash, std::string text, std::shared_ptr<const VectorImage> img) {
+    std::lock_guard<std::mutex> guard(sync);
+    lru.push_front(Entry{hash,std::move(text),std::move(img)});
+    if(lru.size()>MaxEntries)
+      lru.pop_back();
+    }
+
+  void clear() {
+    std::lock_guard<std::mutex> guard(sync);
+    lru.clear();
+    }
+  };
+
+SvgCache& svgCache() {
+  static SvgCache c;
+  return c;
+  }
+
+uint64_t fnv1a(const uint8_t* data, size_t size) {
+  uint64_t h = 0xcbf29ce484222325ull;
+  for(size_t i=0; i<size; ++i) {
+    h ^= data[i];
+    h *= 0x100000001b3ull;
+    }
+  return h;
+  }
+
+}
+
 bool VectorImage::load(const char *file) {
-  NSVGimage* image = nsvgParseFromFile(file,"px",96);
+  std::string text;
+  uint64_t    hash = 0;
+  try {
+    MappedFile f(file);
+    hash = fnv1a(f.data(),f.size());
+    if(auto img = svgCache().find(hash,f.data(),f.size())) {
+      *this = *img;
+      return true;
+      }
+    text.assign(reinterpret_cast<const char*>(f.data()),f.size());
+    }
+  catch(...) {
+    return false;
+    }
+
+  // nanosvg parses in-place
+  std::string src   = text;
+  NSVGimage*  image = nsvgParse(&text[0],"px",96);
   if(image==nullptr)
     return false;
 
   try {
     VectorImage img;
-    //PaintEvent  event(img,int(image->width),int(image->height));
-    //Painter     p(event);
+    const float w = std::max(1.f,std::ceil(image->width));
+    const float h = std::max(1.f,std::ceil(image->height));
+    img.beginPaint(true,uint32_t(w),uint32_t(h));
+    img.setTopology(Triangles);
+    img.setBlend(Alpha);
+
+    auto vertex = [w,h](PaintDevice::Point& pt, float x, float y, const float* rgba) {
+      pt.x = x*2.f/w-1.f;
+      pt.y = y*2.f/h-1.f;
+      pt.r = rgba[0];
+      pt.g = rgba[1];
+      pt.b = rgba[2];
+      pt.a = rgba[3];
+      };
+
+    // gradients are evaluated per vertex: triangles are cut along stop lines,
+    // radial ones are also refined until the distance is close to linear
+    struct GVert {
+      Vec2  p;
+      float t = 0;
+      };
+    std::vector<float> cut;
+    std::vector<GVert> below, above, rest;
+
+    auto shade = [&](const std::vector<GVert>& poly, const SvgPaint& paint, float mid) {
+      auto* pt = img.allocPoints((poly.size()-2)*3);
+      for(size_t i=1; i+1<poly.size(); ++i) {
+        const GVert* v[3] = {&poly[0],&poly[i],&poly[i+1]};
+        for(auto pv:v) {
+          float rgba[4];
+          paint.color(pv->t,mid,rgba);
+          vertex(*pt,pv->p.x,pv->p.y,rgba);
+          ++pt;
+          }
+        }
+      };
+
+    auto gradient = [&](const GVert* tri, const SvgPaint& paint) {
+      const float t0 = std::min(tri[0].t,std::min(tri[1].t,tri[2].t));
+      const float t1 = std::max(tri[0].t,std::max(tri[1].t,tri[2].t));
+      paint.cuts(t0,t1,cut);
+
+      rest.assign(tri,tri+3);
+      float lo = t0;
+      for(float c:cut) {
+        below.clear();
+        above.clear();
+        for(size_t i=0; i<rest.size(); ++i) {
+          const GVert& a = rest[i];
+          const GVert& b = rest[(i+1)%rest.size()];
+          if(a.t<=c)
+            below.push_back(a);
+          if(a.t>=c)
+            above.push_back(a);
+          if((a.t<c && b.t>c) || (a.t>c && b.t<c)) {
+            const float k = (c-a.t)/(b.t-a.t);
+            GVert x;
+            x.p = a.p+(b.p-a.p)*k;
+            x.t = c;
+            below.push_back(x);
+            above.push_back(x);
+            }
+          }
+        if(below.size()>=3)
+          shade(below,paint,(lo+c)*0.5f);
+        rest.swap(above);
+        lo = c;
+        if(rest.size()<3)
+          return;
+        }
+      shade(rest,paint,(lo+t1)*0.5f);
+      };
+
+    std::function<void(const GVert*, const SvgPaint&, int)> radial;
+    radial = [&](const GVert* v, const SvgPaint& paint, int depth) {
+      GVert m[3];
+      float err = 0;
+      for(int i=0; i<3; ++i) {
+        m[i].p = (v[i].p+v[(i+1)%3].p)*0.5f;
+        m[i].t = paint.param(m[i].p.x,m[i].p.y);
+        err    = std::max(err,std::fabs(m[i].t-(v[i].t+v[(i+1)%3].t)*0.5f));
+        }
+      const Vec2 c = (v[0].p+v[1].p+v[2].p)/3.f;
+      err = std::max(err,std::fabs(paint.param(c.x,c.y)-(v[0].t+v[1].t+v[2].t)/3.f));
+      if(depth>=6 || err<1.f/128.f) {
+        gradient(v,paint);
+        return;
+        }
+      const GVert sub[4][3] = {{v[0],m[0],m[2]}, {m[0],v[1],m[1]}, {m[2],m[1],v[2]}, {m[0],m[1],m[2]}};
+      for(auto& i:sub)
+        radial(i,paint,depth+1);
+      };
+
+    auto emit = [&](const std::vector<Vec2>& tri, const NSVGpaint& p, float opacity) {
+      SvgPaint paint;
+      paint.paint   = &p;
+      paint.opacity = opacity;
+      if(!paint.isGradient()) {
+        float rgba[4];
+        paint.color(0,0,rgba);
+        auto* pt = img.allocPoints(tri.size());
+        for(auto& v:tri) {
+          vertex(*pt,v.x,v.y,rgba);
+          ++pt;
+          }
+        return;
+        }
+      for(size_t i=0; i+2<tri.size(); i+=3) {
+        GVert v[3];
+        for(int k=0; k<3; ++k) {
+          v[k].p = tri[i+k];
+          v[k].t = paint.param(v[k].p.x,v[k].p.y);
+          }
+        if(p.type==NSVG_PAINT_RADIAL_GRADIENT)
+          radial(v,paint,0); else
+          gradient(v,paint);
+        }
+      };
 
+    Detail::PathTessellator tess;
+    std::vector<Vec2>       tri;
     for(NSVGshape* shape=image->shapes; shape!=nullptr; shape=shape->next) {
+      if((shape->flags & NSVG_FLAGS_VISIBLE)==0)
+        continue;
+
+      tess.clear();
       for(NSVGpath* path=shape->paths; path!=nullptr; path=path->next) {
+        tess.moveTo(path->pts[0],path->pts[1]);
         for(int i=0; i<path->npts-1; i+=3) {
           const float* p = &path->pts[i*2];
-          //drawCubicBez(p[0],p[1], p[2],p[3], p[4],p[5], p[6],p[7]);
+          tess.cubicTo(p[2],p[3], p[4],p[5], p[6],p[7]);
+          }
+        if(path->closed)
+          tess.close();
+        }
+
+      if(shape->fill.type!=NSVG_PAINT_NONE) {
+        tri.clear();
+        tess.fill(shape->fillRule==NSVG_FILLRULE_EVENODD ? Detail::PathTessellator::EvenOdd : Detail::PathTessellator::NonZero, tri);
+        emit(tri,shape->fill,shape->opacity);
+        }
+
+      if(shape->stroke.type!=NSVG_PAINT_NONE && shape->strokeWidth>0.f) {
+        Detail::PathTessellator::Stroke st;
+        st.width      = shape->strokeWidth;
+        st.miterLimit = shape->miterLimit;
+        st.dash       = shape->strokeDashArray;
+        st.dashCount  = size_t(shape->strokeDashCount);
+        st.dashOffset = shape->strokeDashOffset;
+        switch(shape->strokeLineJoin) {
+          case NSVG_JOIN_ROUND: st.join = Detail::PathTessellator::RoundJoin; break;
+          case NSVG_JOIN_BEVEL: st.join = Detail::PathTessellator::BevelJoin; break;
+          default:              st.join = Detail::PathTessellator::MiterJoin; break;
           }
+        switch(shape->strokeLineCap) {
+          case NSVG_CAP_ROUND:  st.cap = Detail::PathTessellator::RoundCap;  break;
+          case NSVG_CAP_SQUARE: st.cap = Detail::PathTessellator::SquareCap; break;
+          default:              st.cap = Detail::PathTessellator::ButtCap;   break;
+          }
+        tri.clear();
+        tess.stroke(st,tri);
+        emit(tri,shape->stroke,shape->opacity);
         }
       }
 
-    *this=std::move(img);
+    img.commitPoints();
+    img.endPaint();
+    *this = img;
+    svgCache().insert(hash,std::move(src),std::make_shared<const VectorImage>(std::move(img)));
     }
   catch(...){
     nsvgDelete(image);
@@ -173,22 +850,76 @@ bool VectorImage::load(const char *file) {
   return true;
   }
 
+void VectorImage::clearCache() {
+  svgCache().clear();
+  }
+
+VectorImage::Mesh::TextFx VectorImage::Mesh::textFx(const TextEffect& e) {
+  // pixels of distance field to its units: 0.5 at the edge, DistanceFieldPadding pixels span 128 of 255
+  const float pad = float(FontElement::DistanceFieldPadding);
+  const float k   = 128.f/(pad*255.f);
+  const float ol  = std::min(e.outline,pad);
+  const float gl  = std::min(e.glow,pad-ol);
+
+  TextFx fx;
+  for(int i=0; i<4; ++i) {
+    fx.outlineColor[i] = e.outlineColor[i];
+    fx.glowColor[i]    = e.glowColor[i];
+    }
+  fx.outline = ol*k;
+  fx.glow    = gl*k;
+  return fx;
+  }
 
 void VectorImage::Mesh::update(Device& dev, const VectorImage& src, BufferHeap heap) {
-  if(vbo.size()==src.buf.size())
-    vbo.update(src.buf); else
-    vbo=dev.vbo(heap,src.buf);
+  src.batch(batches,batchPoints,batchQuads);
 
-  blocks.resize(src.blocks.size());
+  uploaded = 0;
+  if(batchPoints.size()>shadowPoints.size()) {
+    Detail::growShadow(shadowPoints,batchPoints);
+    vbo      = dev.vbo(heap,shadowPoints);
+    uploaded+= shadowPoints.size()*sizeof(Point);
+    } else {
+    uploaded+= Detail::updateDirty(shadowPoints,batchPoints,[this](size_t off, size_t size){
+      vbo.update(reinterpret_cast<const uint8_t*>(shadowPoints.data())+off,off,size);
+      });
+    }
 
+  if(batchQuads.size()>shadowQuads.size()) {
+    Detail::growShadow(shadowQuads,batchQuads);
+    quads    = dev.ssbo(heap,shadowQuads);
+    uploaded+= shadowQuads.size()*sizeof(Quad);
+    } else {
+    uploaded+= Detail::updateDirty(shadowQuads,batchQuads,[this](size_t off, size_t size){
+      quads.update(reinterpret_cast<const uint8_t*>(shadowQuads.data())+off,off,size);
+      });
+    }
+
+  blocks.resize(batches.size());
+  try {
+    updateBlocks(dev,src);
+    }
+  catch(...) {
+    // atlas page didn't fit in memory: draw nothing, rather than old blocks over new vertices
+    blocks.clear();
+    throw;
+    }
+  }
+
+void VectorImage::Mesh::updateBlocks(Device& dev, const VectorImage& src) {
   for(size_t i=0;i<blocks.size();++i){
-    auto& b  = src.blocks[i];
+    auto& bt = batches[i];
+    auto& b  = src.blocks[bt.block];
     auto& ux = blocks[i];
 
-    ux.begin = b.begin;
-    ux.size  = b.size;
+    ux.begin     = bt.begin;
+    ux.size      = bt.size;
+    ux.instanced = b.instanced;
+    ux.distField = b.hasImg && b.tex.distField;
+    ux.fx        = textFx(b.tex.fx);
+    ux.sprites.clear();
 
-    auto& p = src.pipelineOf(dev,b);
+    auto& p = src.pipelineOf(dev,b,bt.pages>1);
     if(ux.desc.isEmpty() || ux.pipeline!=&p){
       ux.desc     = dev.descriptors(p.layout());
       ux.pipeline = &p;
@@ -211,11 +942,25 @@ void VectorImage::Mesh::update(Device& dev, const VectorImage& src, BufferHeap h
         s.uClamp = b.tex.clamp;
         s.vClamp = b.tex.clamp;
         ux.desc.set(0,b.tex.brush,s);
-        } else {
-        ux.desc.set(0,b.tex.sprite.pageRawData(dev)); //TODO: oom
-        ux.sprite = b.tex.sprite;
+        }
+      else if(bt.pages>1) {
+        // unused slots repeat first page
+        const Texture2d* tex[MaxPages] = {};
+        for(uint8_t r=0; r<MaxPages; ++r) {
+          auto& spr = *bt.page[r<bt.pages ? r : 0];
+          tex[r] = &spr.pageRawData(dev);
+          if(r<bt.pages)
+            ux.sprites.push_back(spr);
+          }
+        ux.desc.set(0,tex,MaxPages,Sampler::anisotrophy());
+        }
+      else {
+        ux.desc.set(0,b.tex.sprite.pageRawData(dev));
+        ux.sprites.push_back(b.tex.sprite);
         }
       }
+    if(b.instanced)
+      ux.desc.set(b.hasImg ? 1 : 0,quads);
     }
   }
 
@@ -224,7 +969,11 @@ void VectorImage::Mesh::draw(Encoder<CommandBuffer>& cmd) const {
     auto& b = blocks[i];
     if(b.size==0)
       continue;
-    cmd.setUniforms(*b.pipeline,b.desc);
-    cmd.draw(vbo,b.begin,b.size);
+    if(b.distField)
+      cmd.setUniforms(*b.pipeline,b.desc,&b.fx,sizeof(b.fx)); else
+      cmd.setUniforms(*b.pipeline,b.desc);
+    if(b.instanced)
+      cmd.draw(6,b.begin,b.size); else
+      cmd.draw(vbo,b.begin,b.size);
     }
   }
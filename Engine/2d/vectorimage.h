@@ -13,37 +13,81 @@ namespace Tempest {
 template<class T>
 class Encoder;
 
+namespace Detail {
+class VectorImageAccess;
+}
+
 class VectorImage : public Tempest::PaintDevice {
+  private:
+    struct Batch;
+
   public:
     VectorImage()=default;
 
     class Mesh {
+      private:
+        // push constant of distance-field pipelines, UboPush in brush.frag
+        struct TextFx {
+          float outlineColor[4] = {};
+          float glowColor[4]    = {};
+          float outline         = 0;
+          float glow            = 0;
+          };
+
       public:
-        void update(Device& dev, const VectorImage& src, BufferHeap heap = BufferHeap::Upload);
-        void draw  (Encoder<CommandBuffer>& cmd) const;
+        void   update(Device& dev, const VectorImage& src, BufferHeap heap = BufferHeap::Upload);
+        void   draw  (Encoder<CommandBuffer>& cmd) const;
+        size_t drawCount() const { return blocks.size(); }
+        // bytes written to gpu buffers by last update
+        size_t uploadSize() const { return uploaded; }
 
       private:
+        static TextFx textFx(const TextEffect& e);
+        void          updateBlocks(Device& dev, const VectorImage& src);
+
         struct Block {
           size_t                begin = 0;
           size_t                size  = 0;
 
           DescriptorSet         desc;
           const RenderPipeline* pipeline = nullptr;
-          // strong reference to sprite
-          Sprite                sprite;
+          // strong reference to sprites
+          std::vector<Sprite>   sprites;
+          bool                  instanced = false;
+          bool                  distField = false;
+          TextFx                fx;
           };
         Tempest::VertexBuffer<Point> vbo;
+        Tempest::StorageBuffer       quads;
         std::vector<Block>           blocks;
+
+        std::vector<Batch>           batches;
+        std::vector<Point>           batchPoints;
+        std::vector<Quad>            batchQuads;
+
+        // contents of vbo and quads, only changed parts of them are uploaded
+        std::vector<Point>           shadowPoints;
+        std::vector<Quad>            shadowQuads;
+        size_t                       uploaded = 0;
       };
 
     uint32_t w() const { return info.w; }
     uint32_t h() const { return info.h; }
 
     bool     load(const char* path);
+    // drops images, shared by load() of same file content
+    static void clearCache();
     void     clear() override;
 
+    // keep geometry of previous frame: widgets, that did not change, copy it instead of painting again
+    void     setRetained(bool r);
+    bool     isRetained() const { return retained; }
+
   private:
     void   addPoint(const Point& p) override;
+    void   addPoints(const Point* p, size_t count) override;
+    Point* allocPoints(size_t count) override;
+    Quad*  allocQuads(size_t count) override;
     void   commitPoints() override;
 
     void   beginPaint(bool clear,uint32_t w,uint32_t h) override;
@@ -53,10 +97,14 @@ class VectorImage : public Tempest::PaintDevice {
     void   popState(size_t id) override;
 
     void   setState(const TexPtr& t, const Color& c, TextureFormat frm, ClampMode clamp) override;
-    void   setState(const Sprite& s, const Color& c) override;
+    void   setState(const Sprite& s, const Color& c, bool distanceField, const TextEffect& fx) override;
     void   setTopology(Topology t) override;
     void   setBlend(const Blend b) override;
 
+    void   beginRange(const RangeKey& k) override;
+    void   endRange() override;
+    bool   replayRange(const RangeKey& k) override;
+
     struct SpriteLock {
       std::vector<Sprite> spr;
       void insert(const Sprite& s) {
@@ -78,9 +126,11 @@ class VectorImage : public Tempest::PaintDevice {
       TextureFormat frm;
       ClampMode     clamp;
       Sprite        sprite; //TODO: dangling sprites
+      bool          distField = false;
+      TextEffect    fx;
 
       bool     operator==(const Texture& t) const {
-        return brush==t.brush && sprite.pageId()==t.sprite.pageId();
+        return brush==t.brush && sprite.pageId()==t.sprite.pageId() && distField==t.distField && fx==t.fx;
         }
       };
 
@@ -88,9 +138,11 @@ class VectorImage : public Tempest::PaintDevice {
       Topology       tp    = Triangles;
       Blend          blend = NoBlend;
       Texture        tex;
+      // block holds quads instead of points
+      bool           instanced = false;
 
       bool operator == (const State& s) const {
-        return tp==s.tp && blend==s.blend && tex==s.tex;
+        return tp==s.tp && blend==s.blend && tex==s.tex && instanced==s.instanced;
         }
       };
 
@@ -112,17 +164,71 @@ class VectorImage : public Tempest::PaintDevice {
     std::vector<State>          stateStk;
     std::vector<Block>          blocks;
     std::vector<Point>          buf;
+    std::vector<Quad>           quads;
     SpriteLock                  slock;
 
+    struct Range {
+      RangeKey key;
+      size_t   begin  = 0; // blocks
+      size_t   end    = 0;
+      size_t   nested = 0; // ranges, that follow this one and are inside of it
+      };
+
+    struct Frame {
+      std::vector<Block>        blocks;
+      std::vector<Point>        buf;
+      std::vector<Quad>         quads;
+      std::vector<Range>        ranges;
+      };
+
+    bool                        retained = false;
+    std::vector<Range>          ranges;
+    std::vector<size_t>         rangeStk;
+    Frame                       prev;
+    size_t                      prevAt = 0;
+
+    // atlas pages, that one draw of instanced quads can sample; texSampler[] in brush.frag
+    static constexpr uint8_t MaxPages = 8;
+
+    struct Bounds {
+      float x0=0, y0=0, x1=0, y1=0;
+      bool  intersects(const Bounds& b) const { return x0<b.x1 && b.x0<x1 && y0<b.y1 && b.y0<y1; }
+      };
+
+    // blocks of compatible state, merged where draw order permits
+    struct Batch {
+      size_t        begin = 0;
+      size_t        size  = 0;
+      size_t        block = 0; // first block, defines state of batch
+      uint8_t       pages = 0;
+      const Sprite* page[MaxPages] = {};
+      // coarse area of batch, few boxes to not cover gaps between widgets
+      uint8_t       boxes = 0;
+      Bounds        box[16];
+
+      bool intersects(const Bounds& b) const;
+      void add(const Bounds& b);
+      };
+
     struct Info {
       uint32_t w=0,h=0;
       };
     Info   info;
     size_t paintScope = 0;
 
-    const RenderPipeline& pipelineOf(Device& dev, const Block& b) const;
+    const RenderPipeline& pipelineOf(Device& dev, const Block& b, bool pages) const;
+    Bounds                boundsOf(const Block& b) const;
+    bool                  merge(Batch& bt, const Block& b, uint8_t& slot) const;
+    void                  batch(std::vector<Batch>& out, std::vector<Point>& pts, std::vector<Quad>& qs) const;
+    size_t                tail(const State& s) const { return s.instanced ? quads.size() : buf.size(); }
+    size_t                findMoved(const RangeKey& k) const;
+    void                  translate(const Block& b, int32_t dx, int32_t dy, const RangeKey& k);
+    void                  cut();
 
     template<class T,T State::*param>
     void setState(const T& t);
+
+  // reads geometry on cpu, in tests
+  friend class Detail::VectorImageAccess;
   };
 }
@@ -4,160 +4,272 @@
 #include <Tempest/Painter>
 #include <Tempest/Platform>
 #include <Tempest/Log>
+#include <Tempest/TextCodec>
+#include "../io/mappedfile.h"
 #include "../utility/utf8_helper.h"
+#include "textlayout.h"
+#include "fontcollection.h"
 #include "thirdparty/stb_truetype.h"
 
 #include <unordered_map>
-#include <bitset>
+#include <atomic>
+#include <mutex>
+#include <vector>
 #include <algorithm>
+#include <cmath>
+#include <thread>
 
-#ifdef __WINDOWS__
-#include <Shlobj.h>
-#endif
 
 using namespace Tempest;
 
-namespace Tempest {
-namespace Detail {
-  template<size_t lvl>
-  struct Bucket {
-    std::unique_ptr<Bucket<lvl-1>> next[256];
+
+// Read-mostly glyph cache: lookups are a few atomic loads, inserts are CAS-published.
+// Nothing is freed before the table itself, so references handed out stay valid.
+struct FontElement::LetterTable {
+  struct Entry {
+    Letter letter;
+    Entry* retired = nullptr;
     };
 
-  template<>
-  struct Bucket<1> {
-    FontElement::Letter     letter[256];
-    std::bitset<256>        ex;
+  struct Block {
+    std::atomic<Entry*> letter[256] = {};
     };
 
-  static std::string getFontFolderPath() {
-#ifdef __WINDOWS__
-    char   path[MAX_PATH]={};
-    SHGetSpecialFolderPathA(nullptr,path,CSIDL_FONTS,false);
-    return path;
-#else
-    return "";
-#endif
-    }
+  struct Page {
+    std::atomic<Block*> block[256] = {};
+    };
 
-  static std::string getFallbackFont() {
-#ifdef __WINDOWS__
-    return getFontFolderPath()+"\\georgia.ttf";
-#else
-    return "";
-#endif
-    }
-  }
+  struct Chunk {
+    explicit Chunk(uint32_t size):size(size){}
+    ~Chunk() {
+      for(auto& i:page) {
+        Page* p = i.load(std::memory_order_relaxed);
+        if(p==nullptr)
+          continue;
+        for(auto& b:p->block)
+          free(b.load(std::memory_order_relaxed));
+        delete p;
+        }
+      for(auto& l:latin.letter)
+        delete l.load(std::memory_order_relaxed);
+      }
 
-}
+    static void free(Block* b) {
+      if(b==nullptr)
+        return;
+      for(auto& l:b->letter)
+        delete l.load(std::memory_order_relaxed);
+      delete b;
+      }
 
-struct FontElement::LetterTable {
-  struct Chunk {
-    uint32_t          size=0;
-    Detail::Bucket<3> next[256];
+    const uint32_t      size;
+    Chunk*              next = nullptr;
+    // direct-mapped ASCII/Latin-1
+    Block               latin;
+    // codepoints up to U+10FFFF: plane -> block -> letter
+    std::atomic<Page*>  page[17] = {};
     };
 
-  std::vector<Chunk> chunk;
+  ~LetterTable() {
+    Chunk* c = chunk.load(std::memory_order_relaxed);
+    while(c!=nullptr) {
+      Chunk* n = c->next;
+      delete c;
+      c = n;
+      }
+    Entry* r = retired.load(std::memory_order_relaxed);
+    while(r!=nullptr) {
+      Entry* n = r->retired;
+      delete r;
+      r = n;
+      }
+    }
 
-  Letter& at(float sz,char32_t ch){
-    return *implFind(sz,ch,true);
+  const Letter* find(float sz, char32_t ch) const {
+    const Chunk* c = findChunk(uint32_t(sz*100));
+    if(c==nullptr)
+      return nullptr;
+    const std::atomic<Entry*>* slot = findSlot(*c,uint32_t(ch));
+    if(slot==nullptr)
+      return nullptr;
+    const Entry* e = slot->load(std::memory_order_acquire);
+    return e==nullptr ? nullptr : &e->letter;
     }
 
-  Letter* find(float sz,char32_t ch){
-    return implFind(sz,ch,false);
+  // publishes letter, unless an equal or better one is already there
+  const Letter& insert(float sz, char32_t ch, Letter&& l) {
+    Chunk&               c    = chunkAt(uint32_t(sz*100));
+    std::atomic<Entry*>& slot = slotAt(c,uint32_t(ch));
+
+    Entry* e   = new Entry();
+    e->letter  = std::move(l);
+    Entry* cur = slot.load(std::memory_order_acquire);
+    while(true) {
+      if(cur!=nullptr && (cur->letter.hasView || !e->letter.hasView)) {
+        delete e;
+        return cur->letter;
+        }
+      if(slot.compare_exchange_weak(cur,e,std::memory_order_acq_rel,std::memory_order_acquire))
+        break;
+      }
+    if(cur!=nullptr)
+      retire(cur);
+    return e->letter;
     }
 
-  Letter* implFind(float sz,char32_t ch,bool create){
-    uint32_t size = uint32_t(sz*100);
+  private:
+    const Chunk* findChunk(uint32_t size) const {
+      for(const Chunk* c=chunk.load(std::memory_order_acquire); c!=nullptr; c=c->next)
+        if(c->size==size)
+          return c;
+      return nullptr;
+      }
 
-    for(auto& i:chunk)
-      if(i.size==size)
-        return implFind(i,uint32_t(ch),create);
+    Chunk& chunkAt(uint32_t size) {
+      Chunk* head = chunk.load(std::memory_order_acquire);
+      Chunk* c    = nullptr;
+      while(true) {
+        for(Chunk* i=head; i!=nullptr; i=i->next)
+          if(i->size==size) {
+            delete c;
+            return *i;
+            }
+        if(c==nullptr)
+          c = new Chunk(size);
+        c->next = head;
+        if(chunk.compare_exchange_weak(head,c,std::memory_order_acq_rel,std::memory_order_acquire))
+          return *c;
+        }
+      }
 
-    chunk.emplace_back();
-    chunk.back().size=size;
-    return implFind(chunk.back(),uint32_t(ch),create);
-    }
+    static const std::atomic<Entry*>* findSlot(const Chunk& c, uint32_t ch) {
+      if(ch<256)
+        return &c.latin.letter[ch];
+      if(ch>0x10FFFF)
+        return nullptr;
+      const Page* p = c.page[ch>>16].load(std::memory_order_acquire);
+      if(p==nullptr)
+        return nullptr;
+      const Block* b = p->block[(ch>>8)&0xFF].load(std::memory_order_acquire);
+      if(b==nullptr)
+        return nullptr;
+      return &b->letter[ch&0xFF];
+      }
 
-  Letter* implFind(Chunk& c,uint32_t ch,bool create){
-    uint8_t* key = reinterpret_cast<uint8_t*>(&ch);
-    auto&    b   = c.next[*key];
-    return implFind(b,key+1,create);
-    }
+    static std::atomic<Entry*>& slotAt(Chunk& c, uint32_t ch) {
+      if(ch<256)
+        return c.latin.letter[ch];
+      if(ch>0x10FFFF)
+        ch = 0xFFFD;
+      Page&  p = *publish(c.page[ch>>16]);
+      Block& b = *publish(p.block[(ch>>8)&0xFF]);
+      return b.letter[ch&0xFF];
+      }
 
-  template<size_t lvl>
-  Letter* implFind(Detail::Bucket<lvl>& b,const uint8_t* k,bool create){
-    auto& ptr = b.next[*k];
-    if(ptr==nullptr && create)
-      ptr.reset(new Detail::Bucket<lvl-1>());
-    if(ptr==nullptr)
-      return nullptr;
-    return implFind(*b.next[*k],k+1,create);
-    }
+    template<class T>
+    static T* publish(std::atomic<T*>& at) {
+      T* cur = at.load(std::memory_order_acquire);
+      if(cur!=nullptr)
+        return cur;
+      T* n = new T();
+      if(at.compare_exchange_strong(cur,n,std::memory_order_acq_rel,std::memory_order_acquire))
+        return n;
+      delete n;
+      return cur;
+      }
 
-  Letter* implFind(Detail::Bucket<1>& b,const uint8_t* pk,bool create){
-    auto k = *pk;
-    if(!b.ex[k]){
-      if(create){
-        b.ex[k]=true;
-        return &b.letter[k];
-        }
-      return nullptr;
+    void retire(Entry* e) {
+      Entry* head = retired.load(std::memory_order_relaxed);
+      do {
+        e->retired = head;
+        } while(!retired.compare_exchange_weak(head,e,std::memory_order_release,std::memory_order_relaxed));
       }
-    return &b.letter[k];
-    }
+
+    std::atomic<Chunk*> chunk{nullptr};
+    std::atomic<Entry*> retired{nullptr};
   };
 
 struct FontElement::Impl {
-  enum { MIN_BUF_SZ=512 };
+  enum { MIN_BUF_SZ=512, KernCacheSize=4096 };
 
   template<class CharT>
   Impl(const CharT *filename) {
     if(filename==nullptr)
       return;
 
-    RFile file(filename);
-    size = uint32_t(file.size());
-    data = new uint8_t[size];
-
-    if(file.read(data,size)!=size) {
-      delete[] data;
-      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
-      }
-    if(stbtt_InitFont(&info,data,0)==0) {
-      delete[] data;
+    file = mapFile(filename);
+    data = file->data();
+    size = file->size();
+    if(!initFont())
       throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
-      }
     stbtt_GetFontVMetrics(&info,&metrics0.ascent,&metrics0.descent,&lineGap);
+    for(int i=0; i<256; ++i)
+      latinIndex[i] = stbtt_FindGlyphIndex(&info,i);
     }
 
   Impl(const void *d, size_t sz) {
+    copy.reset(new uint8_t[sz]);
+    std::memcpy(copy.get(), d, sz);
+    data = copy.get();
     size = sz;
-    data = new uint8_t[size];
-    std::memcpy(data, d, size);
 
-    if(stbtt_InitFont(&info,data,0)==0) {
-      delete[] data;
+    if(!initFont())
       throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
-      }
     stbtt_GetFontVMetrics(&info,&metrics0.ascent,&metrics0.descent,&lineGap);
+    for(int i=0; i<256; ++i)
+      latinIndex[i] = stbtt_FindGlyphIndex(&info,i);
     }
 
-  ~Impl() {
-    delete[] data;
-    std::free(rasterBuf);
+  // same font data, with glyph tables of its own: they cache letters of fallback fonts
+  Impl(const Impl& base, const FontCollection& fb)
+    :file(base.file), copy(base.copy), data(base.data), size(base.size), info(base.info),
+     metrics0(base.metrics0), lineGap(base.lineGap), fallback(std::make_shared<const FontCollection>(fb)) {
+    std::copy(std::begin(base.latinIndex),std::end(base.latinIndex),std::begin(latinIndex));
     }
 
-  uint8_t* ttfMalloc(size_t sz){
-    if(sz<rasterSz)
-      return rasterBuf;
-    sz = std::max<size_t>(sz,MIN_BUF_SZ);
-    void* p=std::realloc(rasterBuf,sz);
-    if(p==nullptr)
-      return nullptr;
-    rasterBuf=reinterpret_cast<uint8_t*>(p);
-    rasterSz =sz;
-    return rasterBuf;
+  static std::shared_ptr<const MappedFile> mapFile(const char16_t* path) {
+    return mapFile(TextCodec::toUtf8(path).c_str());
+    }
+
+  static std::shared_ptr<const MappedFile> mapFile(const char* path) {
+    // one read-only mapping per file in the process, shared by every FontElement over it
+    static std::mutex sync;
+    static std::unordered_map<std::string,std::weak_ptr<const MappedFile>> files;
+
+    std::lock_guard<std::mutex> guard(sync);
+    auto it = files.find(path);
+    if(it!=files.end()) {
+      if(auto f = it->second.lock())
+        return f;
+      }
+
+    for(auto i=files.begin(); i!=files.end();) {
+      if(i->second.expired())
+        i = files.erase(i); else
+        ++i;
+      }
+
+    auto f = std::make_shared<const MappedFile>(path);
+    if(f->isEmpty())
+      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    files[path] = f;
+    return f;
+    }
+
+  bool initFont() {
+    // first face of .ttc collections
+    const int offset = stbtt_GetFontOffsetForIndex(data,0);
+    if(offset<0)
+      return false;
+    return stbtt_InitFont(&info,data,offset)!=0;
+    }
+
+  static uint8_t* ttfMalloc(size_t sz){
+    // per-thread scratch: glyphs of one font can be rasterized concurrently
+    thread_local std::vector<uint8_t> rasterBuf;
+    if(sz>rasterBuf.size())
+      rasterBuf.resize(std::max<size_t>(sz,MIN_BUF_SZ));
+    return rasterBuf.data();
     }
 
   uint8_t* getGlyphBitmapSubpixel(stbtt_fontinfo *info,
@@ -201,34 +313,57 @@ struct FontElement::Impl {
     }
 
   const Letter& letter(char32_t ch,float size,TextureAtlas* tex) {
-    {
-    std::lock_guard<std::mutex> guard(syncMap);
     auto cc=map.find(size,ch);
     if(cc!=nullptr){
       if(cc->hasView || tex==nullptr)
         return *cc;
       }
-    }
 
     if(this->size==0)
       return nullLater();
     return allocLetter(ch,size,tex,false);
     }
 
+  const Letter& glyph(uint32_t index,float size,TextureAtlas* tex) {
+    auto cc=glyphs.find(size,index);
+    if(cc!=nullptr){
+      if(cc->hasView || tex==nullptr)
+        return *cc;
+      }
+
+    if(this->size==0)
+      return nullLater();
+    Letter lt;
+    rasterize(int(index),size,tex,lt);
+    return glyphs.insert(size,index,std::move(lt));
+    }
+
   const Letter& allocLetter(char32_t ch,float size,TextureAtlas* tex,bool fallback) {
+    const int index = glyphIndex(ch);
+    if(index==0 && !fallback) {
+      if(Impl* fb = fallbackFont(ch)) {
+        Letter lf = fb->allocLetter(ch,size,tex,true);
+        return map.insert(size,ch,std::move(lf));
+        }
+      }
+
+    Letter lt;
+    if(!rasterize(index,size,tex,lt))
+      lt.hasView = (tex!=nullptr);
+    return map.insert(size,ch,std::move(lt));
+    }
+
+  bool rasterize(int index,float size,TextureAtlas* tex,Letter& lt) {
     const float scale = stbtt_ScaleForPixelHeight(&info,size); //size/(ascent-descent);
     if(!(scale>0.f))
-      return nullLater();
+      return false;
 
     int w=0,h=0,dx=0,dy=0;
     int ax=0;
-
-    const int index = stbtt_FindGlyphIndex(&info,int(ch));
     stbtt_GetGlyphHMetrics(&info,index,&ax,nullptr);
 
     Sprite spr;
     if(tex!=nullptr){
-      std::lock_guard<std::mutex> guard(syncMem);
       uint8_t* bitmap=getGlyphBitmapSubpixel(&info,scale,index,w,h,dx,dy);
       if(bitmap!=nullptr)
         spr = tex->load(bitmap,uint32_t(w),uint32_t(h),TextureFormat::R8);
@@ -242,39 +377,221 @@ struct FontElement::Impl {
       dy = iy0;
       }
 
-    if((w<=0 || h<=0) && ax==0) {
-      if(!fallback)
-        return allocFallbackLetter(ch,size,tex);
+    if((w<=0 || h<=0) && ax==0)
+      return false;
+
+    lt.view    = std::move(spr);
+    lt.size    = Size(w,h);
+    lt.dpos    = Point(dx,dy);
+    lt.advance = Point(int(ax*scale),int(lineGap*scale));
+    lt.hasView = (tex!=nullptr);
+    return true;
+    }
+
+  const Letter& distanceField(char32_t ch,TextureAtlas& tex) {
+    auto cc=sdf.find(DistanceFieldSize,ch);
+    if(cc!=nullptr)
+      return *cc;
+
+    if(this->size==0)
+      return nullLater();
+    return allocDistanceField(ch,tex,false);
+    }
+
+  const Letter& distanceFieldGlyph(uint32_t index,TextureAtlas& tex) {
+    auto cc=sdfGlyphs.find(DistanceFieldSize,index);
+    if(cc!=nullptr)
+      return *cc;
+
+    if(this->size==0)
       return nullLater();
+    Letter lt;
+    rasterizeDistanceField(int(index),tex,lt);
+    return sdfGlyphs.insert(DistanceFieldSize,index,std::move(lt));
+    }
+
+  const Letter& allocDistanceField(char32_t ch,TextureAtlas& tex,bool fallback) {
+    const int index = glyphIndex(ch);
+    if(index==0 && !fallback) {
+      if(Impl* fb = fallbackFont(ch)) {
+        Letter lf = fb->allocDistanceField(ch,tex,true);
+        return sdf.insert(DistanceFieldSize,ch,std::move(lf));
+        }
       }
 
-    std::lock_guard<std::mutex> guard(syncMap);
-    Letter& lt = map.at(size,ch);
+    Letter lt;
+    rasterizeDistanceField(index,tex,lt);
+    lt.hasView = true;
+    return sdf.insert(DistanceFieldSize,ch,std::move(lt));
+    }
+
+  bool rasterizeDistanceField(int index,TextureAtlas& tex,Letter& lt) {
+    const float scale = stbtt_ScaleForPixelHeight(&info,DistanceFieldSize);
+    if(!(scale>0.f))
+      return false;
+
+    int w=0,h=0,dx=0,dy=0;
+    int ax=0;
+    stbtt_GetGlyphHMetrics(&info,index,&ax,nullptr);
+
+    // 0.5 at the outline, one unit of padding maps to the full [0..1] range
+    const float distScale = 128.f/float(DistanceFieldPadding);
+    uint8_t*    bitmap    = stbtt_GetGlyphSDF(&info,scale,index,DistanceFieldPadding,128,distScale,&w,&h,&dx,&dy);
+
+    Sprite spr;
+    if(bitmap!=nullptr) {
+      spr = tex.load(bitmap,uint32_t(w),uint32_t(h),TextureFormat::R8);
+      stbtt_FreeSDF(bitmap,info.userdata);
+      }
+
+    if(bitmap==nullptr && ax==0)
+      return false;
+
     lt.view    = std::move(spr);
     lt.size    = Size(w,h);
     lt.dpos    = Point(dx,dy);
     lt.advance = Point(int(ax*scale),int(lineGap*scale));
-    lt.hasView = (tex!=nullptr);
-    return lt;
+    lt.hasView = true;
+    return true;
     }
 
-  const Letter& allocFallbackLetter(char32_t ch,float size,TextureAtlas* tex) {
-    try {
-      std::lock_guard<std::mutex> guard(syncMap);
-      if(fallback==nullptr){
-        fallback.reset(new Impl(Detail::getFallbackFont().c_str()));
-        if(stbtt_InitFont(&fallback->info,fallback->data,0)==0)
-          throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+  struct Baked {
+    Impl*                owner = nullptr; // this font or a fallback, that has the glyph
+    char32_t             ch    = 0;
+    int                  index = 0;
+    std::vector<uint8_t> bitmap;
+    Letter               lt;
+    };
+
+  void prefetch(std::u32string_view chars, float sz, TextureAtlas& tex, bool distField) {
+    if(this->size==0)
+      return;
+    LetterTable& table = distField ? sdf : map;
+    const float  key   = distField ? DistanceFieldSize : sz;
+
+    std::vector<Baked> job;
+    for(char32_t ch:chars) {
+      auto cc = table.find(key,ch);
+      if(cc!=nullptr && cc->hasView)
+        continue;
+      Baked b;
+      b.owner = this;
+      b.ch    = ch;
+      b.index = glyphIndex(ch);
+      if(b.index==0) {
+        if(Impl* fb = fallbackFont(ch)) {
+          b.owner = fb;
+          b.index = fb->glyphIndex(ch);
+          }
         }
+      job.push_back(std::move(b));
+      }
+    std::sort(job.begin(),job.end(),[](const Baked& a,const Baked& b){ return a.ch<b.ch; });
+    job.erase(std::unique(job.begin(),job.end(),[](const Baked& a,const Baked& b){ return a.ch==b.ch; }),job.end());
+    if(job.empty())
+      return;
 
-      Letter  lf = fallback->allocLetter(ch,size,tex,true);
-      Letter& lt = map.at(size,ch);
-      lt = lf;
-      return lt;
+    // stbtt_fontinfo is read-only after init, scratch memory is per-thread
+    static const size_t minJob = 32;
+    std::atomic<size_t> next{0};
+    auto work = [&job,&next,key,distField]() {
+      for(size_t i=next.fetch_add(1); i<job.size(); i=next.fetch_add(1))
+        job[i].owner->bake(job[i],key,distField);
+      };
+    uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, uint32_t((job.size()+minJob-1)/minJob));
+
+    std::vector<std::thread> th;
+    th.reserve(threads-1);
+    for(uint32_t i=1; i<threads; ++i)
+      th.emplace_back(work);
+    work();
+    for(auto& t:th)
+      t.join();
+
+    std::vector<TextureAtlas::Image> img;
+    std::vector<size_t>              imgId;
+    for(size_t i=0; i<job.size(); ++i) {
+      auto& b = job[i];
+      if(b.bitmap.empty())
+        continue;
+      TextureAtlas::Image im;
+      im.data   = b.bitmap.data();
+      im.w      = uint32_t(b.lt.size.w);
+      im.h      = uint32_t(b.lt.size.h);
+      im.format = TextureFormat::R8;
+      img.push_back(im);
+      imgId.push_back(i);
       }
-    catch (...) {
-      return nullLater();
+
+    std::vector<Sprite> spr(img.size());
+    tex.load(img.data(),img.size(),spr.data());
+    for(size_t i=0; i<spr.size(); ++i)
+      job[imgId[i]].lt.view = std::move(spr[i]);
+
+    for(auto& b:job)
+      table.insert(key,b.ch,std::move(b.lt));
+    }
+
+  void bake(Baked& b, float sz, bool distField) {
+    b.lt.hasView = true;
+    const float scale = stbtt_ScaleForPixelHeight(&info,sz);
+    if(!(scale>0.f))
+      return;
+
+    int w=0,h=0,dx=0,dy=0;
+    int ax=0;
+    stbtt_GetGlyphHMetrics(&info,b.index,&ax,nullptr);
+
+    if(distField) {
+      const float distScale = 128.f/float(DistanceFieldPadding);
+      uint8_t*    bitmap    = stbtt_GetGlyphSDF(&info,scale,b.index,DistanceFieldPadding,128,distScale,&w,&h,&dx,&dy);
+      if(bitmap!=nullptr) {
+        b.bitmap.assign(bitmap,bitmap+size_t(w*h));
+        stbtt_FreeSDF(bitmap,info.userdata);
+        }
+      } else {
+      uint8_t* bitmap = getGlyphBitmapSubpixel(&info,scale,b.index,w,h,dx,dy);
+      if(bitmap!=nullptr)
+        b.bitmap.assign(bitmap,bitmap+size_t(w*h));
       }
+
+    if((w<=0 || h<=0) && ax==0)
+      return;
+    b.lt.size    = Size(w,h);
+    b.lt.dpos    = Point(dx,dy);
+    b.lt.advance = Point(int(ax*scale),int(lineGap*scale));
+    }
+
+  int glyphIndex(char32_t ch) const {
+    if(ch<256)
+      return latinIndex[ch];
+    return stbtt_FindGlyphIndex(&info,int(ch));
+    }
+
+  int kernAdvance(uint32_t a, uint32_t b) {
+    // direct-mapped pair cache: [valid:1][pad:15][pair:32][kern:16]
+    if((a|b)>0xFFFF)
+      return 0;
+    const uint64_t pair = (uint64_t(a)<<16) | b;
+    auto&          slot = kern[(pair*0x9E3779B1u >> 20) % KernCacheSize];
+    const uint64_t v    = slot.load(std::memory_order_relaxed);
+    if((v>>63)!=0 && ((v>>16) & 0xFFFFFFFF)==pair)
+      return int16_t(v & 0xFFFF);
+
+    const int k = stbtt_GetGlyphKernAdvance(&info,int(a),int(b));
+    slot.store((uint64_t(1)<<63) | (pair<<16) | uint16_t(int16_t(k)),std::memory_order_relaxed);
+    return k;
+    }
+
+  Impl* fallbackFont(char32_t ch) {
+    if(ch<0x20)
+      return nullptr;
+    auto& fc  = fallback!=nullptr ? *fallback : FontCollection::system();
+    auto  fnt = fc.find(ch);
+    if(fnt==nullptr || fnt->ptr.get()==this)
+      return nullptr;
+    return fnt->ptr.get();
     }
 
   Metrics       metrics(float size) const {
@@ -287,19 +604,22 @@ struct FontElement::Impl {
     return m;
     }
 
-  uint8_t*       data=nullptr;
-  size_t         size=0;
+  std::shared_ptr<const MappedFile> file;
+  std::shared_ptr<uint8_t[]>        copy;
+  const uint8_t*                    data=nullptr;
+  size_t                            size=0;
   stbtt_fontinfo info={};
 
-  std::mutex     syncMem;
-  uint8_t*       rasterBuf=nullptr;
-  size_t         rasterSz =0;
   Metrics        metrics0;
   int            lineGap=0;
+  std::shared_ptr<const FontCollection> fallback; // system fonts, if null
 
-  std::mutex                           syncMap;
   LetterTable                          map;
-  std::unique_ptr<Impl>                fallback;
+  LetterTable                          glyphs;
+  LetterTable                          sdf;
+  LetterTable                          sdfGlyphs;
+  int                                  latinIndex[256] = {};
+  std::atomic<uint64_t>                kern[KernCacheSize] = {};
   };
 
 FontElement::FontElement() {
@@ -336,6 +656,10 @@ FontElement::FontElement(const void* data, size_t size)
   :ptr(std::make_shared<Impl>(data,size)) {
   }
 
+void FontElement::setFallback(const FontCollection& fb) {
+  ptr = std::make_shared<Impl>(*ptr,fb);
+  }
+
 const FontElement::LetterGeometry& FontElement::letterGeometry(char32_t ch, float size) const { //FIXME: UB?
   return reinterpret_cast<const LetterGeometry&>(ptr->letter(ch,size,nullptr));
   }
@@ -344,11 +668,36 @@ const FontElement::Letter& FontElement::letter(char32_t ch, float size, TextureA
   return ptr->letter(ch,size,&tex);
   }
 
+const FontElement::Letter& FontElement::distanceField(char32_t ch, TextureAtlas& tex) const {
+  return ptr->distanceField(ch,tex);
+  }
+
+const FontElement::LetterGeometry& FontElement::glyphGeometry(uint32_t index, float size) const {
+  return reinterpret_cast<const LetterGeometry&>(ptr->glyph(index,size,nullptr));
+  }
+
+const FontElement::Letter& FontElement::glyph(uint32_t index, float size, TextureAtlas& tex) const {
+  return ptr->glyph(index,size,&tex);
+  }
+
+const FontElement::Letter& FontElement::distanceFieldGlyph(uint32_t index, TextureAtlas& tex) const {
+  return ptr->distanceFieldGlyph(index,tex);
+  }
+
+void FontElement::prefetch(std::u32string_view chars, float size, TextureAtlas& tex) const {
+  ptr->prefetch(chars,size,tex,false);
+  }
+
+void FontElement::prefetchDistanceField(std::u32string_view chars, TextureAtlas& tex) const {
+  ptr->prefetch(chars,DistanceFieldSize,tex,true);
+  }
+
 Size FontElement::textSize(const char *text, float fontSize) const {
   Utf8Iterator i(text);
 
   Size ret;
   int  minY = 0;
+  uint32_t prev = 0;
   while(i.hasData()){
     char32_t c = i.next();
     if(c=='\0')
@@ -358,12 +707,46 @@ Size FontElement::textSize(const char *text, float fontSize) const {
     ret.h = std::max(ret.h,-g.dpos.y);
     minY  = std::min(minY, -g.dpos.y-g.size.h);
     ret.w += g.advance.x;
+
+    const uint32_t index = glyphIndex(c);
+    ret.w += kernAdvance(prev,index,fontSize);
+    prev   = index;
     }
 
   ret.h+=minY;
   return ret;
   }
 
+uint32_t FontElement::glyphIndex(char32_t ch) const {
+  if(ptr->size==0)
+    return 0;
+  return uint32_t(ptr->glyphIndex(ch));
+  }
+
+int FontElement::kernAdvance(uint32_t a, uint32_t b, float size) const {
+  if(ptr->size==0 || a==0 || b==0)
+    return 0;
+  const int k = ptr->kernAdvance(a,b);
+  if(k==0)
+    return 0;
+  return int(std::round(float(k)*scale(size)));
+  }
+
+float FontElement::scale(float size) const {
+  if(ptr->size==0)
+    return 0.f;
+  return stbtt_ScaleForPixelHeight(&ptr->info,size);
+  }
+
+const uint8_t* FontElement::rawData(size_t& sz) const {
+  sz = ptr->size;
+  return ptr->data;
+  }
+
+bool FontElement::hasGlyph(char32_t ch) const {
+  return glyphIndex(ch)!=0;
+  }
+
 bool FontElement::isEmpty() const {
   return ptr->size==0;
   }
@@ -424,6 +807,28 @@ bool Font::isItalic() const {
   return italic;
   }
 
+void Font::setFallback(const FontCollection& fb) {
+  // styles, that share one element, keep sharing it
+  FontElement* el [4] = {&fnt[0][0],&fnt[0][1],&fnt[1][0],&fnt[1][1]};
+  FontElement  src[4] = {*el[0],*el[1],*el[2],*el[3]};
+  for(int i=0; i<4; ++i) {
+    int j = 0;
+    while(j<i && src[j].ptr!=src[i].ptr)
+      ++j;
+    if(j<i)
+      *el[i] = *el[j]; else
+      el[i]->setFallback(fb);
+    }
+  }
+
+void Font::setDistanceField(bool d) {
+  sdf = d ? 1 : 0;
+  }
+
+bool Font::isDistanceField() const {
+  return sdf!=0;
+  }
+
 bool Font::isEmpty() const {
   return fnt[0][0].isEmpty() || fnt[0][1].isEmpty() ||
          fnt[1][0].isEmpty() || fnt[1][1].isEmpty();
@@ -457,6 +862,35 @@ const Font::Letter &Font::letter(char32_t ch, Painter &p) const {
   return letter(ch,p.ta);
   }
 
+void Font::prefetch(std::u16string_view charset, TextureAtlas& tex) const {
+  std::u32string chars;
+  chars.reserve(charset.size());
+  for(size_t i=0; i<charset.size();) {
+    uint32_t cp = charset[i];
+    if(0xD800<=cp && cp<=0xDBFF && i+1<charset.size()) {
+      Detail::utf16ToCodepoint(reinterpret_cast<const uint16_t*>(charset.data()+i),cp);
+      i+=2;
+      } else {
+      i+=1;
+      }
+    chars.push_back(char32_t(cp));
+    }
+  implPrefetch(chars,tex);
+  }
+
+void Font::prefetch(char32_t first, char32_t last, TextureAtlas& tex) const {
+  std::u32string chars;
+  for(char32_t i=first; i<=last && i<=0x10FFFF; ++i)
+    chars.push_back(i);
+  implPrefetch(chars,tex);
+  }
+
+void Font::implPrefetch(std::u32string_view chars, TextureAtlas& tex) const {
+  if(sdf!=0)
+    fnt[bold][italic].prefetchDistanceField(chars,tex); else
+    fnt[bold][italic].prefetch(chars,size,tex);
+  }
+
 Size Font::textSize(const char *text) const {
   return fnt[bold][italic].textSize(text,size);
   }
@@ -466,34 +900,9 @@ Size Font::textSize(const std::string &text) const {
   }
 
 Size Font::textSize(int maxW, const char* txt) const {
-  Size ret;
   if(txt==nullptr)
-    return ret;
-
-  const int pSz = int(std::ceil(pixelSize()));
-
-  Utf8Iterator i(txt);
-  while(i.hasData()) {
-    // make next line
-    int x = 0;
-    Utf8Iterator eol = i.advanceByLine(x,maxW,*this);
-    if(i==eol)
-      break;
-
-    x = 0;
-    while(i!=eol) {
-      auto c = i.next();
-      if(c=='\0')
-        return ret;
-      if(c=='\n' || c=='\r')
-        continue;
-      auto l = letterGeometry(c);
-      x += l.advance.x;
-      }
-    ret.w = std::max(ret.w,x);
-    ret.h += pSz;
-    }
-  return ret;
+    return Size();
+  return TextLayout::get(*this,txt,maxW)->size();
   }
 
 Size Font::textSize(int maxW, const std::string& text) const {
@@ -5,11 +5,17 @@
 #include <Tempest/Sprite>
 
 #include <string>
+#include <string_view>
 #include <memory>
 
 namespace Tempest {
 
 class Painter;
+class FontCollection;
+
+namespace Detail {
+class FontAccess;
+}
 
 class FontElement final {
   public:
@@ -21,6 +27,13 @@ class FontElement final {
     FontElement(const std::u16string& file);
     FontElement(const void* data, size_t size);
 
+    // fonts to take missing glyphs from; FontCollection::system() by default
+    void                  setFallback(const FontCollection& fb);
+
+    // distance-field glyphs are rasterized once at this size and scaled on draw
+    static constexpr float DistanceFieldSize    = 48.f;
+    static constexpr int   DistanceFieldPadding = 6;
+
     class LetterGeometry final {
       public:
         Tempest::Size  size;
@@ -43,9 +56,20 @@ class FontElement final {
 
     const LetterGeometry& letterGeometry(char32_t ch, float size) const;
     const Letter&         letter(char32_t ch,float size,TextureAtlas& tex) const;
+    const Letter&         distanceField(char32_t ch,TextureAtlas& tex) const;
+
+    // lookup by font glyph index, as produced by TextShaper
+    const LetterGeometry& glyphGeometry(uint32_t index, float size) const;
+    const Letter&         glyph(uint32_t index, float size, TextureAtlas& tex) const;
+    const Letter&         distanceFieldGlyph(uint32_t index, TextureAtlas& tex) const;
+
+    // rasterizes missing glyphs on worker threads and places them into the atlas in one batch
+    void                  prefetch(std::u32string_view chars, float size, TextureAtlas& tex) const;
+    void                  prefetchDistanceField(std::u32string_view chars, TextureAtlas& tex) const;
 
     Size                  textSize(const char* text, float fontSize) const;
     Size                  textSize(const char* text, int maxW, float fontSize) const;
+    bool                  hasGlyph(char32_t ch) const;
     bool                  isEmpty() const;
 
     Metrics               metrics(float size) const;
@@ -54,9 +78,19 @@ class FontElement final {
     template<class CharT>
     FontElement(const CharT* file,std::true_type);
 
+    uint32_t              glyphIndex(char32_t ch) const;
+    int                   kernAdvance(uint32_t a, uint32_t b, float size) const;
+    float                 scale(float size) const;
+    const uint8_t*        rawData(size_t& sz) const;
+
     struct LetterTable;
     struct Impl;
     std::shared_ptr<Impl> ptr;
+
+  friend class Font;
+  friend class TextLayout;
+  friend class TextShaper;
+  friend class Detail::FontAccess;
   };
 
 class Font final {
@@ -82,6 +116,11 @@ class Font final {
     void  setItalic(bool i);
     bool  isItalic() const;
 
+    void  setDistanceField(bool d);
+    bool  isDistanceField() const;
+
+    void  setFallback(const FontCollection& fb);
+
     bool  isEmpty() const;
 
     Metrics               metrics() const;
@@ -94,6 +133,10 @@ class Font final {
     const Letter&         letter(char16_t ch,Painter& tex) const;
     const Letter&         letter(char32_t ch,Painter& tex) const;
 
+    // warms up glyphs of current size and style, to avoid rasterization on first draw
+    void                  prefetch(std::u16string_view charset, TextureAtlas& tex) const;
+    void                  prefetch(char32_t first, char32_t last, TextureAtlas& tex) const;
+
     Size                  textSize(const char* text) const;
     Size                  textSize(const std::string& text) const;
 
@@ -104,9 +147,14 @@ class Font final {
     template<class CharT>
     Font(const CharT* file,std::true_type);
 
+    void        implPrefetch(std::u32string_view chars, TextureAtlas& tex) const;
+
     FontElement fnt[2][2];
     float       size   = 18.f;
     uint8_t     bold   = 0;
     uint8_t     italic = 0;
+    uint8_t     sdf    = 0;
+
+  friend class TextLayout;
   };
 }
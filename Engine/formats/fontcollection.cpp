@@ -0,0 +1,303 @@
+#include "fontcollection.h"
+
+#include <Tempest/Platform>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef __WINDOWS__
+#include <Shlobj.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+using namespace Tempest;
+
+// general purpose faces first, then script and symbol coverage
+static const char* const preferredFonts[] = {
+#ifdef __WINDOWS__
+  "segoeui.ttf",
+  "arial.ttf",
+  "georgia.ttf",
+  "tahoma.ttf",
+  "nirmala.ttf",
+  "ebrima.ttf",
+  "msyh.ttc",
+  "msgothic.ttc",
+  "malgun.ttf",
+  "simsun.ttc",
+  "seguisym.ttf",
+  "seguiemj.ttf",
+#else
+  "DejaVuSans.ttf",
+  "LiberationSans-Regular.ttf",
+  "NotoSans-Regular.ttf",
+  "FreeSans.ttf",
+  "Ubuntu-R.ttf",
+  "Roboto-Regular.ttf",
+  "Cantarell-Regular.otf",
+  "Helvetica.ttc",
+  "Arial.ttf",
+  "NotoSansArabic-Regular.ttf",
+  "NotoSansHebrew-Regular.ttf",
+  "NotoSansDevanagari-Regular.ttf",
+  "NotoSansThai-Regular.ttf",
+  "NotoSansArmenian-Regular.ttf",
+  "NotoSansGeorgian-Regular.ttf",
+  "NotoSansCJK-Regular.ttc",
+  "NotoSansCJKsc-Regular.otf",
+  "DroidSansFallbackFull.ttf",
+  "DroidSansFallback.ttf",
+  "wqy-microhei.ttc",
+  "wqy-zenhei.ttc",
+  "PingFang.ttc",
+  "Arial Unicode.ttf",
+  "NotoSansSymbols-Regular.ttf",
+  "NotoSansSymbols2-Regular.ttf",
+  "DejaVuSansMono.ttf",
+  "FreeSerif.ttf",
+  "Symbola.ttf",
+  "unifont.otf",
+  "unifont.ttf",
+#endif
+  };
+
+struct FontCollection::Entry {
+  Entry(const FontElement& fnt):fnt(fnt){}
+  Entry(const std::string& path):path(path){}
+
+  const FontElement* get() {
+    // system fonts are loaded on first lookup, that reaches them
+    std::call_once(once,[this](){
+      if(path.empty())
+        return;
+      try {
+        fnt = FontElement(path);
+        }
+      catch(...) {
+        fnt = FontElement();
+        }
+      });
+    return fnt.isEmpty() ? nullptr : &fnt;
+    }
+
+  std::string    path;
+  std::once_flag once;
+  FontElement    fnt;
+  };
+
+struct FontCollection::Coverage {
+  // per codepoint: 0 - not resolved yet, None - no font has it, otherwise font index + 1
+  enum : uint8_t { Unknown = 0, None = 0xFF, MaxFonts = 0xFE };
+
+  struct Page {
+    std::atomic<uint8_t> font[256] = {};
+    };
+
+  ~Coverage() {
+    for(auto& i:page)
+      delete i.load(std::memory_order_relaxed);
+    }
+
+  std::atomic<uint8_t>* at(char32_t ch) {
+    if(ch>0x10FFFF)
+      return nullptr;
+    auto& at  = page[ch>>8];
+    Page* cur = at.load(std::memory_order_acquire);
+    if(cur==nullptr) {
+      Page* p = new Page();
+      if(at.compare_exchange_strong(cur,p,std::memory_order_acq_rel,std::memory_order_acquire))
+        cur = p; else
+        delete p;
+      }
+    return &cur->font[ch&0xFF];
+    }
+
+  std::atomic<Page*> page[0x110000/256] = {};
+  };
+
+struct FontCollection::Impl {
+  std::vector<std::shared_ptr<Entry>> fonts;
+  Coverage                            coverage;
+  };
+
+FontCollection::FontCollection()
+  :impl(std::make_shared<Impl>()) {
+  }
+
+FontCollection::FontCollection(std::initializer_list<FontElement> fonts)
+  :FontCollection() {
+  for(auto& i:fonts)
+    impl->fonts.push_back(std::make_shared<Entry>(i));
+  }
+
+FontCollection::FontCollection(const std::vector<FontElement>& fonts)
+  :FontCollection() {
+  for(auto& i:fonts)
+    impl->fonts.push_back(std::make_shared<Entry>(i));
+  }
+
+FontCollection::FontCollection(const std::vector<std::string>& files)
+  :FontCollection() {
+  for(auto& i:files)
+    impl->fonts.push_back(std::make_shared<Entry>(i));
+  }
+
+void FontCollection::add(const FontElement& fnt) {
+  // coverage of existing copies stays valid: they keep the old list
+  auto n = std::make_shared<Impl>();
+  n->fonts = impl->fonts;
+  n->fonts.push_back(std::make_shared<Entry>(fnt));
+  impl = std::move(n);
+  }
+
+void FontCollection::add(const std::string& file) {
+  auto n = std::make_shared<Impl>();
+  n->fonts = impl->fonts;
+  n->fonts.push_back(std::make_shared<Entry>(file));
+  impl = std::move(n);
+  }
+
+size_t FontCollection::size() const {
+  return impl->fonts.size();
+  }
+
+bool FontCollection::isEmpty() const {
+  return impl->fonts.empty();
+  }
+
+const FontElement* FontCollection::find(char32_t ch) const {
+  auto* slot = impl->coverage.at(ch);
+  if(slot==nullptr)
+    return nullptr;
+
+  uint8_t id = slot->load(std::memory_order_relaxed);
+  if(id==Coverage::Unknown) {
+    id = Coverage::None;
+    const size_t cnt = std::min<size_t>(impl->fonts.size(),Coverage::MaxFonts);
+    for(size_t i=0; i<cnt; ++i) {
+      auto f = impl->fonts[i]->get();
+      if(f!=nullptr && f->hasGlyph(ch)) {
+        id = uint8_t(i+1);
+        break;
+        }
+      }
+    slot->store(id,std::memory_order_relaxed);
+    }
+
+  if(id==Coverage::None)
+    return nullptr;
+  return impl->fonts[id-1]->get();
+  }
+
+#ifndef __WINDOWS__
+static void scanFontDir(const std::string& dir, int depth,
+                        std::unordered_map<std::string,std::string>& found) {
+  DIR* d = opendir(dir.c_str());
+  if(d==nullptr)
+    return;
+  while(dirent* e = readdir(d)) {
+    if(e->d_name[0]=='.')
+      continue;
+    std::string path = dir + "/" + e->d_name;
+    struct stat st = {};
+    if(stat(path.c_str(),&st)!=0)
+      continue;
+    if(S_ISDIR(st.st_mode)) {
+      if(depth>0)
+        scanFontDir(path,depth-1,found);
+      continue;
+      }
+    // first match wins: user directories are scanned first
+    found.emplace(e->d_name,std::move(path));
+    }
+  closedir(d);
+  }
+
+static std::vector<std::string> systemFontDirs() {
+  std::vector<std::string> dirs;
+  const char* home = std::getenv("HOME");
+  const char* xdgH = std::getenv("XDG_DATA_HOME");
+  const char* xdgD = std::getenv("XDG_DATA_DIRS");
+
+  if(xdgH!=nullptr && xdgH[0]!='\0')
+    dirs.push_back(std::string(xdgH)+"/fonts");
+  else if(home!=nullptr)
+    dirs.push_back(std::string(home)+"/.local/share/fonts");
+  if(home!=nullptr)
+    dirs.push_back(std::string(home)+"/.fonts");
+
+  std::string data = (xdgD!=nullptr && xdgD[0]!='\0') ? xdgD : "/usr/local/share:/usr/share";
+  for(size_t b=0; b<=data.size();) {
+    size_t e = data.find(':',b);
+    if(e==std::string::npos)
+      e = data.size();
+    if(e>b)
+      dirs.push_back(data.substr(b,e-b)+"/fonts");
+    b = e+1;
+    }
+
+  dirs.push_back("/usr/X11R6/lib/X11/fonts");
+#if defined(__OSX__)
+  if(home!=nullptr)
+    dirs.push_back(std::string(home)+"/Library/Fonts");
+  dirs.push_back("/Library/Fonts");
+  dirs.push_back("/System/Library/Fonts");
+#endif
+#if defined(__ANDROID__)
+  dirs.push_back("/system/fonts");
+#endif
+  return dirs;
+  }
+#endif
+
+std::vector<std::string> FontCollection::systemFontFiles() {
+  std::vector<std::string> ret;
+#ifdef __WINDOWS__
+  char dir[MAX_PATH]={};
+  SHGetSpecialFolderPathA(nullptr,dir,CSIDL_FONTS,false);
+  for(auto name:preferredFonts) {
+    std::string path = std::string(dir)+"\\"+name;
+    if(GetFileAttributesA(path.c_str())!=INVALID_FILE_ATTRIBUTES)
+      ret.push_back(std::move(path));
+    }
+#else
+  std::unordered_map<std::string,std::string> found;
+  for(auto& d:systemFontDirs())
+    scanFontDir(d,4,found);
+  for(auto name:preferredFonts) {
+    auto it = found.find(name);
+    if(it==found.end())
+      continue;
+    ret.push_back(std::move(it->second));
+    found.erase(it);
+    }
+
+  // everything else goes after, in stable order: scripts, that none of preferred fonts cover
+  std::vector<std::string> rest;
+  for(auto& i:found) {
+    auto& name = i.first;
+    auto  ext  = name.size()>4 ? name.substr(name.size()-4) : std::string();
+    for(auto& c:ext)
+      c = char(std::tolower(uint8_t(c)));
+    if(ext==".ttf" || ext==".otf")
+      rest.push_back(std::move(i.second));
+    }
+  std::sort(rest.begin(),rest.end());
+  ret.insert(ret.end(),std::make_move_iterator(rest.begin()),std::make_move_iterator(rest.end()));
+#endif
+  return ret;
+  }
+
+const FontCollection& FontCollection::system() {
+  static const FontCollection fonts(systemFontFiles());
+  return fonts;
+  }
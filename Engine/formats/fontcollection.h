@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Tempest/Font>
+
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Tempest {
+
+class FontCollection final {
+  public:
+    FontCollection();
+    FontCollection(std::initializer_list<FontElement> fonts);
+    explicit FontCollection(const std::vector<FontElement>& fonts);
+    explicit FontCollection(const std::vector<std::string>& files);
+
+    void               add(const FontElement& fnt);
+    void               add(const std::string& file);
+
+    size_t             size() const;
+    bool               isEmpty() const;
+
+    // first font in the list, that has a glyph for ch; nullptr if none
+    const FontElement* find(char32_t ch) const;
+
+    // fonts installed in the system, in order of preference
+    static const FontCollection& system();
+    static std::vector<std::string> systemFontFiles();
+
+  private:
+    struct Entry;
+    struct Coverage;
+    struct Impl;
+    std::shared_ptr<Impl> impl;
+  };
+
+}
@@ -0,0 +1,333 @@
+#include "mipgenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#include <emmintrin.h>
+#define TEMPEST_MIP_SSE 1
+#endif
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+static constexpr float pi = 3.14159265358979323846f;
+
+static float sinc(float x) {
+  if(std::fabs(x)<1e-5f)
+    return 1.f;
+  x *= pi;
+  return std::sin(x)/x;
+  }
+
+static float besselI0(float x) {
+  // power series of modified Bessel function of the first kind
+  float sum = 1.f, term = 1.f;
+  const float x2 = x*x*0.25f;
+  for(int i=1; i<32; ++i) {
+    term *= x2/float(i*i);
+    sum  += term;
+    if(term<sum*1e-7f)
+      break;
+    }
+  return sum;
+  }
+
+static float srgbToLinear(float v) {
+  if(v<=0.04045f)
+    return v/12.92f;
+  return std::pow((v+0.055f)/1.055f, 2.4f);
+  }
+
+static float linearToSrgb(float v) {
+  if(v<=0.0031308f)
+    return v*12.92f;
+  return 1.055f*std::pow(v, 1.f/2.4f) - 0.055f;
+  }
+
+struct MipGenerator::Level {
+  uint8_t*       dst = nullptr;
+  uint32_t       dw  = 0;
+  uint32_t       dh  = 0;
+  const uint8_t* src = nullptr;
+  uint32_t       sw  = 0;
+  uint32_t       sh  = 0;
+  TextureFormat  frm = TextureFormat::RGBA8;
+  size_t         bpp = 0;
+  Kernel         kx, ky;
+  };
+
+// ring of decoded and horizontally filtered source rows
+struct MipGenerator::RowCache {
+  RowCache(const MipGenerator& owner, const Level& lv)
+    :owner(owner), lv(lv), cap(lv.ky.maxCount), id(cap,uint32_t(-1)),
+     rows(size_t(cap)*lv.dw*4), tmp(size_t(lv.sw)*4) {
+    }
+
+  const float* get(uint32_t y) {
+    const size_t slot = y%cap;
+    float*       ret  = rows.data() + slot*lv.dw*4;
+    if(id[slot]==y)
+      return ret;
+    id[slot] = y;
+
+    owner.decodeRow(tmp.data(), lv.src+size_t(y)*lv.sw*lv.bpp, lv.sw, lv.frm);
+    for(uint32_t x=0; x<lv.dw; ++x) {
+      const Contrib& c = lv.kx.contrib[x];
+      const float*   w = lv.kx.weights.data() + c.weight;
+      const float*   s = tmp.data() + size_t(c.first)*4;
+#if defined(TEMPEST_MIP_SSE)
+      __m128 acc = _mm_setzero_ps();
+      for(uint32_t i=0; i<c.count; ++i)
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(s+i*4), _mm_set1_ps(w[i])));
+      _mm_storeu_ps(ret+x*4, acc);
+#else
+      float acc[4] = {};
+      for(uint32_t i=0; i<c.count; ++i)
+        for(int ch=0; ch<4; ++ch)
+          acc[ch] += s[i*4+ch]*w[i];
+      std::memcpy(ret+x*4, acc, sizeof(acc));
+#endif
+      }
+    return ret;
+    }
+
+  const MipGenerator&   owner;
+  const Level&          lv;
+  uint32_t              cap = 0;
+  std::vector<uint32_t> id;
+  std::vector<float>    rows;
+  std::vector<float>    tmp;
+  };
+
+MipGenerator::MipGenerator(Pixmap::MipFilter filter, bool sRGB)
+  :filter(filter), sRGB(sRGB) {
+  for(int i=0; i<256; ++i)
+    toLinear[i] = sRGB ? srgbToLinear(float(i)/255.f) : float(i)/255.f;
+  }
+
+bool MipGenerator::isSupported(TextureFormat frm) {
+  switch(frm) {
+    case TextureFormat::R8:
+    case TextureFormat::RG8:
+    case TextureFormat::RGB8:
+    case TextureFormat::RGBA8:
+    case TextureFormat::R16:
+    case TextureFormat::RG16:
+    case TextureFormat::RGB16:
+    case TextureFormat::RGBA16:
+    case TextureFormat::R32F:
+    case TextureFormat::RG32F:
+    case TextureFormat::RGB32F:
+    case TextureFormat::RGBA32F:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+float MipGenerator::radius() const {
+  switch(filter) {
+    case Pixmap::MipFilter::Box:     return 0.5f;
+    case Pixmap::MipFilter::Lanczos: return 3.f;
+    case Pixmap::MipFilter::Kaiser:  return 3.f;
+    }
+  return 0.5f;
+  }
+
+float MipGenerator::eval(float x) const {
+  switch(filter) {
+    case Pixmap::MipFilter::Box:
+      return (-0.5f<=x && x<0.5f) ? 1.f : 0.f;
+    case Pixmap::MipFilter::Lanczos:
+      if(std::fabs(x)>=3.f)
+        return 0.f;
+      return sinc(x)*sinc(x/3.f);
+    case Pixmap::MipFilter::Kaiser: {
+      static const float alpha = 4.f;
+      static const float norm  = 1.f/besselI0(alpha);
+      const float t = x/3.f;
+      if(std::fabs(t)>=1.f)
+        return 0.f;
+      return sinc(x)*besselI0(alpha*std::sqrt(1.f-t*t))*norm;
+      }
+    }
+  return 0.f;
+  }
+
+MipGenerator::Kernel MipGenerator::buildKernel(uint32_t srcSize, uint32_t dstSize) const {
+  Kernel k;
+  k.contrib.resize(dstSize);
+
+  const float scale   = float(srcSize)/float(dstSize);
+  const float support = radius()*scale;
+
+  std::vector<float> w;
+  for(uint32_t i=0; i<dstSize; ++i) {
+    const float center = (float(i)+0.5f)*scale;
+    const int   left   = int(std::floor(center-support));
+    const int   right  = int(std::ceil (center+support));
+
+    const int   first  = std::max(left, 0);
+    const int   last   = std::min(right,int(srcSize)-1);
+    w.assign(size_t(last-first+1),0.f);
+
+    // clamp-to-edge: weights of out-of-range taps go to the border texel
+    float sum = 0;
+    for(int j=left; j<=right; ++j) {
+      const float v = eval((float(j)+0.5f-center)/scale);
+      const int   at = std::clamp(j,first,last);
+      w[size_t(at-first)] += v;
+      sum += v;
+      }
+    if(sum==0.f) {
+      w.assign(w.size(),0.f);
+      w[size_t(std::clamp(int(center),first,last)-first)] = 1.f;
+      sum = 1.f;
+      }
+
+    Contrib& c = k.contrib[i];
+    c.first  = uint32_t(first);
+    c.count  = uint32_t(w.size());
+    c.weight = uint32_t(k.weights.size());
+    for(auto v:w)
+      k.weights.push_back(v/sum);
+    k.maxCount = std::max(k.maxCount,c.count);
+    }
+  return k;
+  }
+
+void MipGenerator::decodeRow(float* out, const uint8_t* src, uint32_t w, TextureFormat frm) const {
+  const uint8_t comp = Pixmap::componentCount(frm);
+  const uint8_t gcnt = sRGB ? std::min<uint8_t>(comp,3) : 0;
+
+  switch(Pixmap::bppForFormat(frm)/comp) {
+    case 1: {
+      for(uint32_t x=0; x<w; ++x, src+=comp, out+=4) {
+        out[0] = 0; out[1] = 0; out[2] = 0; out[3] = 1;
+        for(uint8_t c=0; c<comp; ++c)
+          out[c] = c<gcnt ? toLinear[src[c]] : float(src[c])/255.f;
+        }
+      break;
+      }
+    case 2: {
+      auto* s = reinterpret_cast<const uint16_t*>(src);
+      for(uint32_t x=0; x<w; ++x, s+=comp, out+=4) {
+        out[0] = 0; out[1] = 0; out[2] = 0; out[3] = 1;
+        for(uint8_t c=0; c<comp; ++c) {
+          const float v = float(s[c])/65535.f;
+          out[c] = c<gcnt ? srgbToLinear(v) : v;
+          }
+        }
+      break;
+      }
+    case 4: {
+      // float formats are linear already
+      auto* s = reinterpret_cast<const float*>(src);
+      for(uint32_t x=0; x<w; ++x, s+=comp, out+=4) {
+        out[0] = 0; out[1] = 0; out[2] = 0; out[3] = 1;
+        for(uint8_t c=0; c<comp; ++c)
+          out[c] = s[c];
+        }
+      break;
+      }
+    }
+  }
+
+void MipGenerator::encodeRow(uint8_t* dst, const float* in, uint32_t w, TextureFormat frm) const {
+  const uint8_t comp = Pixmap::componentCount(frm);
+  const uint8_t gcnt = sRGB ? std::min<uint8_t>(comp,3) : 0;
+
+  switch(Pixmap::bppForFormat(frm)/comp) {
+    case 1: {
+      for(uint32_t x=0; x<w; ++x, dst+=comp, in+=4)
+        for(uint8_t c=0; c<comp; ++c) {
+          float v = std::clamp(in[c],0.f,1.f);
+          if(c<gcnt)
+            v = linearToSrgb(v);
+          dst[c] = uint8_t(v*255.f+0.5f);
+          }
+      break;
+      }
+    case 2: {
+      auto* d = reinterpret_cast<uint16_t*>(dst);
+      for(uint32_t x=0; x<w; ++x, d+=comp, in+=4)
+        for(uint8_t c=0; c<comp; ++c) {
+          float v = std::clamp(in[c],0.f,1.f);
+          if(c<gcnt)
+            v = linearToSrgb(v);
+          d[c] = uint16_t(v*65535.f+0.5f);
+          }
+      break;
+      }
+    case 4: {
+      auto* d = reinterpret_cast<float*>(dst);
+      for(uint32_t x=0; x<w; ++x, d+=comp, in+=4)
+        for(uint8_t c=0; c<comp; ++c)
+          d[c] = in[c];
+      break;
+      }
+    }
+  }
+
+void MipGenerator::filterRows(const Level& lv, uint32_t y0, uint32_t y1) const {
+  RowCache           cache(*this,lv);
+  std::vector<float> row(size_t(lv.dw)*4);
+
+  const size_t rowLen = row.size();
+  const size_t pitch  = size_t(lv.dw)*lv.bpp;
+  for(uint32_t y=y0; y<y1; ++y) {
+    const Contrib& c = lv.ky.contrib[y];
+    const float*   w = lv.ky.weights.data() + c.weight;
+
+    std::fill(row.begin(),row.end(),0.f);
+    for(uint32_t i=0; i<c.count; ++i) {
+      const float* s  = cache.get(c.first+i);
+      const float  wi = w[i];
+      for(size_t x=0; x<rowLen; ++x)
+        row[x] += s[x]*wi;
+      }
+    encodeRow(lv.dst+y*pitch, row.data(), lv.dw, lv.frm);
+    }
+  }
+
+void MipGenerator::resample(uint8_t* dst, uint32_t dw, uint32_t dh,
+                            const uint8_t* src, uint32_t sw, uint32_t sh, TextureFormat frm) const {
+  Level lv;
+  lv.dst = dst;
+  lv.dw  = dw;
+  lv.dh  = dh;
+  lv.src = src;
+  lv.sw  = sw;
+  lv.sh  = sh;
+  lv.frm = frm;
+  lv.bpp = Pixmap::bppForFormat(frm);
+  lv.kx  = buildKernel(sw,dw);
+  lv.ky  = buildKernel(sh,dh);
+
+  // bands of rows; small levels are not worth a thread
+  static const uint32_t minRows = 64;
+  uint32_t bands = std::max(1u, std::thread::hardware_concurrency());
+  bands = std::min(bands, std::max(1u, uint32_t((size_t(dw)*dh)/(size_t(minRows)*minRows))));
+  bands = std::min(bands, dh);
+
+  if(bands<=1) {
+    filterRows(lv,0,dh);
+    return;
+    }
+
+  std::vector<std::thread> th;
+  th.reserve(bands-1);
+  const uint32_t step = (dh+bands-1)/bands;
+  for(uint32_t i=1; i<bands; ++i) {
+    const uint32_t y0 = std::min(dh, i*step);
+    const uint32_t y1 = std::min(dh, y0+step);
+    if(y0<y1)
+      th.emplace_back([this,&lv,y0,y1](){ filterRows(lv,y0,y1); });
+    }
+  filterRows(lv,0,std::min(dh,step));
+  for(auto& t:th)
+    t.join();
+  }
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Tempest/Pixmap>
+
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+class MipGenerator final {
+  public:
+    MipGenerator(Pixmap::MipFilter filter, bool sRGB);
+
+    static bool isSupported(TextureFormat frm);
+
+    void resample(uint8_t* dst, uint32_t dw, uint32_t dh,
+                  const uint8_t* src, uint32_t sw, uint32_t sh, TextureFormat frm) const;
+
+  private:
+    struct Contrib {
+      uint32_t first  = 0;
+      uint32_t count  = 0;
+      uint32_t weight = 0;
+      };
+
+    struct Kernel {
+      std::vector<Contrib> contrib;
+      std::vector<float>   weights;
+      uint32_t             maxCount = 0;
+      };
+
+    struct Level;
+    struct RowCache;
+
+    float  radius() const;
+    float  eval(float x) const;
+    Kernel buildKernel(uint32_t srcSize, uint32_t dstSize) const;
+
+    void   decodeRow(float* out, const uint8_t* src, uint32_t w, TextureFormat frm) const;
+    void   encodeRow(uint8_t* dst, const float* in, uint32_t w, TextureFormat frm) const;
+    void   filterRows(const Level& lv, uint32_t y0, uint32_t y1) const;
+
+    Pixmap::MipFilter filter = Pixmap::MipFilter::Kaiser;
+    bool              sRGB   = false;
+    float             toLinear[256] = {};
+  };
+
+}
+}
@@ -20,7 +20,8 @@ namespace Detail {
 struct StbContext final {
   StbContext(IDevice& device, bool err):device(device),err(err){}
   IDevice& device;
-  bool     err = false;
+  bool     err      = false;
+  size_t   consumed = 0;
   };
 }
 };
@@ -35,14 +36,20 @@ static int stbiEof(void* /*user*/) {
 
 static int stbiRead(void* user, char* data, int size) {
   auto& ctx = *reinterpret_cast<StbContext*>(user);
-  return ctx.err ? 0 : int(ctx.device.read(data,size_t(size)));
+  if(ctx.err)
+    return 0;
+  size_t ret = ctx.device.read(data,size_t(size));
+  ctx.consumed += ret;
+  return int(ret);
   }
 
 static void stbiSkip(void* user, int n) {
   auto& ctx = *reinterpret_cast<StbContext*>(user);
   if(ctx.err)
     return;
-  ctx.err |= (size_t(n)!=ctx.device.seek(size_t(n)));
+  size_t ret = ctx.device.seek(size_t(n));
+  ctx.consumed += ret;
+  ctx.err |= (size_t(n)!=ret);
   }
 
 static void stbi__start_file(stbi__context *s, StbContext *f) {
@@ -208,6 +215,45 @@ uint8_t* PixmapCodecCommon::load(PixmapCodec::Context &ctx, uint32_t &ow, uint32
   return result;
   }
 
+bool PixmapCodecCommon::probe(const PixmapCodec::Context& ctx, Info& info) const {
+  int  w = 0, h = 0, compCnt = 0;
+  bool isHdr = false, is16 = false;
+  {
+  StbContext f = {ctx.device,false};
+  stbi__context s;
+  stbi__start_file(&s,&f);
+  isHdr = stbi__hdr_test(&s);
+  stbi__rewind(&s);
+  if(!stbi__info_main(&s,&w,&h,&compCnt))
+    compCnt = 0;
+  if(f.device.unget(f.consumed)!=f.consumed)
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+  }
+
+  if(compCnt<1 || compCnt>4)
+    return false;
+
+  if(!isHdr) {
+    StbContext f = {ctx.device,false};
+    stbi__context s;
+    stbi__start_file(&s,&f);
+    is16 = stbi__is_16_main(&s);
+    if(f.device.unget(f.consumed)!=f.consumed)
+      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    }
+
+  if(isHdr)
+    info.frm = TextureFormat(int(TextureFormat::R32F)+compCnt-1); else
+  if(is16)
+    info.frm = TextureFormat(int(TextureFormat::R16)+compCnt-1); else
+    info.frm = TextureFormat(int(TextureFormat::R8)+compCnt-1);
+  info.w      = uint32_t(w);
+  info.h      = uint32_t(h);
+  info.mipCnt = 1;
+  info.dataSz = size_t(info.w)*info.h*Pixmap::bppForFormat(info.frm);
+  return true;
+  }
+
 bool PixmapCodecCommon::save(ODevice &f, const char *ext, const uint8_t* cdata,
                              size_t dataSz, uint32_t w, uint32_t h, TextureFormat frm) const {
   (void)dataSz;
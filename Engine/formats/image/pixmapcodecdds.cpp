@@ -18,51 +18,29 @@ bool PixmapCodecDDS::testFormat(const PixmapCodec::Context &c) const {
   return c.peek(buf,4)==4 && std::memcmp(buf,"DDS ",4)==0;
   }
 
-uint8_t* PixmapCodecDDS::load(PixmapCodec::Context &c, uint32_t &ow, uint32_t &oh,
-                              TextureFormat& frm, uint32_t& mipCnt, size_t& dataSz, uint32_t &bpp) const {
+static bool parseHeader(const Detail::DDSURFACEDESC2& ddsd, uint32_t &ow, uint32_t &oh,
+                        TextureFormat& frm, uint32_t& mipCnt, size_t& dataSz) {
   using namespace Tempest::Detail;
 
-  auto& f = c.device;
-  uint8_t head[4]={};
-  if(f.read(head,4)!=4)
-    return nullptr;
-
-  DDSURFACEDESC2 ddsd={};
-  if(f.read(&ddsd,sizeof(ddsd))!=sizeof(ddsd))
-    return nullptr;
   ow = ddsd.dwWidth;
   oh = ddsd.dwHeight;
 
-  int compressType = squish::kDxt1;
   switch(ddsd.ddpfPixelFormat.dwFourCC) {
     case FOURCC_DXT1:
-      bpp          = 3;
-      compressType = squish::kDxt1;
-      frm          = TextureFormat::DXT1;
+      frm = TextureFormat::DXT1;
       break;
-
     case FOURCC_DXT3:
-      bpp          = 4;
-      compressType = squish::kDxt3;
-      frm          = TextureFormat::DXT3;
+      frm = TextureFormat::DXT3;
       break;
-
     case FOURCC_DXT5:
-      bpp          = 4;
-      compressType = squish::kDxt5;
-      frm          = TextureFormat::DXT5;
+      frm = TextureFormat::DXT5;
       break;
-
     default:
-      return nullptr;
-    }
-
-  if( ddsd.dwLinearSize == 0 ) {
-    //return false;
+      return false;
     }
 
   mipCnt            = std::max(1u, ddsd.dwMipMapCount);
-  size_t blocksize  = (compressType==squish::kDxt1) ? 8 : 16;
+  size_t blocksize  = Pixmap::blockSizeForFormat(frm);
   size_t bufferSize = 0;
 
   size_t w = size_t(ow), h = size_t(oh);
@@ -73,6 +51,27 @@ uint8_t* PixmapCodecDDS::load(PixmapCodec::Context &c, uint32_t &ow, uint32_t &o
     h = std::max<size_t>(1,h/2);
     }
 
+  dataSz = bufferSize;
+  return true;
+  }
+
+uint8_t* PixmapCodecDDS::load(PixmapCodec::Context &c, uint32_t &ow, uint32_t &oh,
+                              TextureFormat& frm, uint32_t& mipCnt, size_t& dataSz, uint32_t &bpp) const {
+  using namespace Tempest::Detail;
+
+  auto& f = c.device;
+  uint8_t head[4]={};
+  if(f.read(head,4)!=4)
+    return nullptr;
+
+  DDSURFACEDESC2 ddsd={};
+  if(f.read(&ddsd,sizeof(ddsd))!=sizeof(ddsd))
+    return nullptr;
+
+  size_t bufferSize = 0;
+  if(!parseHeader(ddsd,ow,oh,frm,mipCnt,bufferSize))
+    return nullptr;
+
   uint8_t* ddsv = reinterpret_cast<uint8_t*>(std::malloc(bufferSize));
   if(!ddsv || f.read(ddsv,bufferSize)!=bufferSize) {
     std::free(ddsv);
@@ -84,6 +83,66 @@ uint8_t* PixmapCodecDDS::load(PixmapCodec::Context &c, uint32_t &ow, uint32_t &o
   return ddsv;
   }
 
+bool PixmapCodecDDS::probe(const PixmapCodec::Context& c, Info& info) const {
+  using namespace Tempest::Detail;
+
+  uint8_t head[4+sizeof(DDSURFACEDESC2)] = {};
+  if(c.peek(head,sizeof(head))!=sizeof(head))
+    return false;
+
+  DDSURFACEDESC2 ddsd={};
+  std::memcpy(&ddsd,head+4,sizeof(ddsd));
+  return parseHeader(ddsd,info.w,info.h,info.frm,info.mipCnt,info.dataSz);
+  }
+
+bool PixmapCodecDDS::decode(PixmapCodec::Context& c, Info& info, uint8_t* out, size_t outSz, const RowCallback& cb) const {
+  using namespace Tempest::Detail;
+
+  auto& f = c.device;
+  uint8_t head[4]={};
+  if(f.read(head,4)!=4)
+    return false;
+
+  DDSURFACEDESC2 ddsd={};
+  if(f.read(&ddsd,sizeof(ddsd))!=sizeof(ddsd))
+    return false;
+  if(!parseHeader(ddsd,info.w,info.h,info.frm,info.mipCnt,info.dataSz) || info.dataSz>outSz)
+    return false;
+
+  uint32_t h = info.h;
+  for(uint32_t i=0; i<info.mipCnt; ++i) {
+    const size_t sz = info.mipSize(i);
+    if(f.read(out,sz)!=sz)
+      return false;
+    out += sz;
+    if(cb)
+      cb(i,0,h);
+    h = std::max<uint32_t>(1,h/2);
+    }
+  return true;
+  }
+
+const uint8_t* PixmapCodecDDS::view(const uint8_t* src, size_t srcSz, uint32_t& ow, uint32_t& oh,
+                                    TextureFormat& frm, uint32_t& mipCnt, size_t& dataSz) const {
+  using namespace Tempest::Detail;
+
+  const size_t headSz = 4+sizeof(DDSURFACEDESC2);
+  if(srcSz<headSz)
+    return nullptr;
+
+  DDSURFACEDESC2 ddsd={};
+  std::memcpy(&ddsd,src+4,sizeof(ddsd));
+
+  size_t bufferSize = 0;
+  if(!parseHeader(ddsd,ow,oh,frm,mipCnt,bufferSize))
+    return nullptr;
+  if(srcSz-headSz<bufferSize)
+    return nullptr;
+
+  dataSz = bufferSize;
+  return src+headSz;
+  }
+
 bool PixmapCodecDDS::save(ODevice &, const char* /*ext*/, const uint8_t *data, size_t dataSz,
                           uint32_t w, uint32_t h, TextureFormat frm) const {
   return false;
@@ -12,6 +12,9 @@ class PixmapCodecDDS : public PixmapCodec {
     bool     testFormat(const Context& c) const override;
     uint8_t* load(PixmapCodec::Context &c,uint32_t& w,uint32_t& h,TextureFormat& frm,uint32_t& mipCnt,size_t& dataSz,uint32_t& bpp) const override;
     bool     save(ODevice& f,const char* ext, const uint8_t *data, size_t dataSz, uint32_t w, uint32_t h, TextureFormat frm) const override;
+    bool     probe (const Context& c, Info& info) const override;
+    bool     decode(Context& c, Info& info, uint8_t* out, size_t outSz, const RowCallback& cb) const override;
+    const uint8_t* view(const uint8_t* src, size_t srcSz, uint32_t& w, uint32_t& h, TextureFormat& frm, uint32_t& mipCnt, size_t& dataSz) const override;
   };
 
 }
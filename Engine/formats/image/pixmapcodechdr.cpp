@@ -1,6 +1,7 @@
 #include "pixmapcodechdr.h"
 
 #include <Tempest/IDevice>
+#include <Tempest/Except>
 
 #include <algorithm>
 #include <cstring>
@@ -30,16 +31,64 @@ bool PixmapCodecHDR::testFormat(const PixmapCodec::Context &c) const {
 
 uint8_t* PixmapCodecHDR::load(PixmapCodec::Context &c, uint32_t &ow, uint32_t &oh,
                               TextureFormat& frm, uint32_t& mipCnt, size_t& dataSz, uint32_t &bpp) const {
-  char buf[256] = {};
-  if(!readToken(c.device,buf,256))
+  size_t consumed = 0;
+  if(!readHeader(c.device,ow,oh,consumed))
     return nullptr;
-  if(std::strcmp(buf,"#?RADIANCE")!=0)
+
+  bpp    = 3*sizeof(float);
+  dataSz = size_t(ow)*oh*bpp;
+  float* pixels = (float*)std::malloc(dataSz);
+  if(pixels==nullptr || !readDataRLE(c.device,pixels,ow,oh,nullptr)) {
+    std::free(pixels);
     return nullptr;
+    }
+
+  frm    = TextureFormat::RGB32F;
+  mipCnt = 1;
+  return reinterpret_cast<uint8_t*>(pixels);
+  }
+
+bool PixmapCodecHDR::probe(const PixmapCodec::Context& c, Info& info) const {
+  size_t consumed = 0;
+  bool   ret      = readHeader(c.device,info.w,info.h,consumed);
+  if(c.device.unget(consumed)!=consumed)
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+  if(!ret)
+    return false;
+  info.frm    = TextureFormat::RGB32F;
+  info.mipCnt = 1;
+  info.dataSz = size_t(info.w)*info.h*3*sizeof(float);
+  return true;
+  }
+
+bool PixmapCodecHDR::decode(PixmapCodec::Context& c, Info& info, uint8_t* out, size_t outSz, const RowCallback& cb) const {
+  size_t consumed = 0;
+  if(!readHeader(c.device,info.w,info.h,consumed))
+    return false;
+  info.frm    = TextureFormat::RGB32F;
+  info.mipCnt = 1;
+  info.dataSz = size_t(info.w)*info.h*3*sizeof(float);
+  if(info.dataSz>outSz)
+    return false;
+  return readDataRLE(c.device,reinterpret_cast<float*>(out),info.w,info.h,&cb);
+  }
+
+bool PixmapCodecHDR::save(ODevice &, const char* /*ext*/, const uint8_t*, size_t,
+                          uint32_t, uint32_t, TextureFormat) const {
+  return false;
+  }
+
+bool PixmapCodecHDR::readHeader(IDevice& d, uint32_t& ow, uint32_t& oh, size_t& consumed) {
+  char buf[256] = {};
+  if(!readToken(d,buf,256,consumed))
+    return false;
+  if(std::strcmp(buf,"#?RADIANCE")!=0)
+    return false;
 
   // header
   for(;;) {
-    if(!readToken(c.device,buf,256))
-      return nullptr;
+    if(!readToken(d,buf,256,consumed))
+      return false;
     if(buf[0]=='\0')
       break;
     // comment
@@ -47,44 +96,31 @@ uint8_t* PixmapCodecHDR::load(PixmapCodec::Context &c, uint32_t &ow, uint32_t &o
       continue;
     // internal format
     if(std::memcmp(buf,"FORMAT=",7)==0 && std::strcmp(buf,"FORMAT=32-bit_rle_rgbe")!=0)
-      return nullptr;
+      return false;
     }
 
-  if(!readToken(c.device,buf,256))
-    return nullptr;
+  if(!readToken(d,buf,256,consumed))
+    return false;
 
   int width = 0, height = 0;
   std::sscanf(buf,"-Y %d +X %d", &height, &width);
   if(width<=0 || height<=0)
-    return nullptr;
-
-  bpp    = 3*sizeof(float);
-  dataSz = width*height*bpp;
-  float* pixels = (float*)std::malloc(dataSz);
-  if(!readDataRLE(c.device,pixels,width,height)) {
-    std::free(pixels);
-    return nullptr;
-    }
-
-  frm    = TextureFormat::RGB32F;
-  ow     = width;
-  oh     = height;
-  mipCnt = 1;
-  return reinterpret_cast<uint8_t*>(pixels);
-  }
+    return false;
 
-bool PixmapCodecHDR::save(ODevice &, const char* /*ext*/, const uint8_t*, size_t,
-                          uint32_t, uint32_t, TextureFormat) const {
-  return false;
+  ow = uint32_t(width);
+  oh = uint32_t(height);
+  return true;
   }
 
-bool PixmapCodecHDR::readToken(IDevice& d, char* out, size_t maxSz) {
+bool PixmapCodecHDR::readToken(IDevice& d, char* out, size_t maxSz, size_t& consumed) {
   size_t sz = d.read(out,maxSz);
+  consumed += sz;
   for(size_t i=0; i<sz; ++i) {
     if(out[i]=='\0' || out[i]=='\n') {
       const size_t extra = sz-i-1;
       if(d.unget(extra)!=extra)
         return false;
+      consumed -= extra;
       for(; i<sz; ++i)
         out[i] = '\0';
       return true;
@@ -107,9 +143,14 @@ bool PixmapCodecHDR::readData(IDevice& d, float* data, size_t count) {
   return true;
   }
 
-bool PixmapCodecHDR::readDataRLE(IDevice& d, float* data, size_t width, size_t height) {
-  if(width<8 || width>0x7fff)
-    return readData(d,data,width*height);
+bool PixmapCodecHDR::readDataRLE(IDevice& d, float* data, size_t width, size_t height, const RowCallback* cb) {
+  if(width<8 || width>0x7fff) {
+    if(!readData(d,data,width*height))
+      return false;
+    if(cb!=nullptr && *cb)
+      (*cb)(0,0,uint32_t(height));
+    return true;
+    }
 
   uint8_t* buffer = (uint8_t*)std::malloc(width*4);
   if(buffer==nullptr)
@@ -126,7 +167,11 @@ bool PixmapCodecHDR::readDataRLE(IDevice& d, float* data, size_t width, size_t h
       // non compressed
       rgbe2float(data[0],data[1],data[2],rgbe);
       std::free(buffer);
-      return readData(d,data+3,width*height-1);
+      if(!readData(d,data+3,(height-h)*width-1))
+        return false;
+      if(cb!=nullptr && *cb)
+        (*cb)(0,uint32_t(h),uint32_t(height-h));
+      return true;
       }
 
     const size_t len = (size_t(rgbe[2])<<8) | size_t(rgbe[3]);
@@ -177,6 +222,8 @@ bool PixmapCodecHDR::readDataRLE(IDevice& d, float* data, size_t width, size_t h
       rgbe2float(data[0],data[1],data[2],rgbe);
       data += 3;
       }
+    if(cb!=nullptr && *cb)
+      (*cb)(0,uint32_t(h),1);
     }
   free(buffer);
   return true;
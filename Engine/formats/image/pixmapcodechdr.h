@@ -12,10 +12,13 @@ class PixmapCodecHDR : public PixmapCodec {
     bool     testFormat(const Context& c) const override;
     uint8_t* load(PixmapCodec::Context &c,uint32_t& w,uint32_t& h,TextureFormat& frm,uint32_t& mipCnt,size_t& dataSz,uint32_t& bpp) const override;
     bool     save(ODevice& f,const char* ext, const uint8_t *data, size_t dataSz, uint32_t w, uint32_t h, TextureFormat frm) const override;
+    bool     probe (const Context& c, Info& info) const override;
+    bool     decode(Context& c, Info& info, uint8_t* out, size_t outSz, const RowCallback& cb) const override;
 
-    static bool readToken  (IDevice& d, char*   out, size_t maxSz);
+    static bool readHeader (IDevice& d, uint32_t& w, uint32_t& h, size_t& consumed);
+    static bool readToken  (IDevice& d, char*   out, size_t maxSz, size_t& consumed);
     static bool readData   (IDevice& d, float* data, size_t count);
-    static bool readDataRLE(IDevice& d, float* data, size_t width, size_t height);
+    static bool readDataRLE(IDevice& d, float* data, size_t width, size_t height, const RowCallback* cb);
   };
 
 }
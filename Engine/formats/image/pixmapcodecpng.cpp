@@ -8,6 +8,45 @@
 
 using namespace Tempest;
 
+static bool pngFormat(png_byte colorType, png_byte bitDepth, TextureFormat& frm, uint32_t& outBpp) {
+  if(colorType==PNG_COLOR_TYPE_GRAY) {
+    outBpp = 1;
+    frm    = TextureFormat::R8;
+    }
+  else if(colorType==PNG_COLOR_TYPE_GRAY_ALPHA) {
+    if(bitDepth!=8 && bitDepth!=16)
+      return false;
+    outBpp = 2;
+    frm    = TextureFormat::RG8;
+    }
+  else if(colorType==PNG_COLOR_TYPE_RGB) {
+    if(bitDepth!=8 && bitDepth!=16)
+      return false;
+    outBpp = 3;
+    frm    = TextureFormat::RGB8;
+    }
+  else if(colorType==PNG_COLOR_TYPE_RGB_ALPHA) {
+    if(bitDepth!=8 && bitDepth!=16)
+      return false;
+    outBpp = 4;
+    frm    = TextureFormat::RGBA8;
+    }
+  else if(colorType==PNG_COLOR_TYPE_PALETTE) {
+    outBpp = 3;
+    frm    = TextureFormat::RGB8;
+    return true;
+    }
+  else {
+    return false;
+    }
+
+  if(bitDepth==16) {
+    outBpp*=2;
+    frm = TextureFormat(uint8_t(TextureFormat::R16)+uint8_t(frm)-uint8_t(TextureFormat::R8));
+    }
+  return true;
+  }
+
 struct PixmapCodecPng::Impl {
   IDevice* data = nullptr;
   uint8_t* out  = nullptr;
@@ -20,8 +59,10 @@ struct PixmapCodecPng::Impl {
     std::free(out);
     }
 
+  // decodes into 'dest', or into newly allocated 'out', if dest is null
   bool readPng(png_structp png_ptr, png_infop info_ptr,
-               TextureFormat& frm, uint32_t& outW, uint32_t& outH, uint32_t& outBpp) {
+               TextureFormat& frm, uint32_t& outW, uint32_t& outH, uint32_t& outBpp,
+               uint8_t* dest, size_t destSz, const RowCallback* cb) {
     if(setjmp(png_jmpbuf(png_ptr))) {
       // png exception
       return false;
@@ -38,47 +79,25 @@ struct PixmapCodecPng::Impl {
     png_byte colorType = png_get_color_type(png_ptr, info_ptr);
     png_byte bitDepth  = png_get_bit_depth(png_ptr,  info_ptr);
 
-    if(colorType==PNG_COLOR_TYPE_GRAY) {
-      if(bitDepth<8)
-        png_set_expand_gray_1_2_4_to_8(png_ptr);
-      outBpp = 1;
-      frm    = TextureFormat::R8;
-      }
-    else if(colorType==PNG_COLOR_TYPE_GRAY_ALPHA) {
-      //png_set_gray_to_rgb(png_ptr);
-      if(bitDepth!=8 && bitDepth!=16)
-        return false;
-      outBpp = 2;
-      frm    = TextureFormat::RG8;
-      }
-    else if(colorType==PNG_COLOR_TYPE_RGB) {
-      if(bitDepth!=8 && bitDepth!=16)
-        return false;
-      outBpp = 3;
-      frm    = TextureFormat::RGB8;
-      }
-    else if(colorType==PNG_COLOR_TYPE_RGB_ALPHA) {
-      if(bitDepth!=8 && bitDepth!=16)
-        return false;
-      outBpp = 4;
-      frm    = TextureFormat::RGBA8;
-      }
-    else if(colorType==PNG_COLOR_TYPE_PALETTE) {
+    if(!pngFormat(colorType,bitDepth,frm,outBpp))
+      return false;
+    if(colorType==PNG_COLOR_TYPE_GRAY && bitDepth<8)
+      png_set_expand_gray_1_2_4_to_8(png_ptr);
+    if(colorType==PNG_COLOR_TYPE_PALETTE)
       png_set_palette_to_rgb(png_ptr);
-      outBpp = 3;
-      frm    = TextureFormat::RGB8;
+    if(bitDepth==16)
+      png_set_swap(png_ptr);
+
+    const size_t size = size_t(outW)*outH*outBpp;
+    if(dest==nullptr) {
+      out  = reinterpret_cast<uint8_t*>(malloc(size));
+      dest = out;
+      if(dest==nullptr)
+        return false;
       }
-    else {
+    else if(destSz<size) {
       return false;
       }
-
-    if(bitDepth==16) {
-      png_set_swap(png_ptr);
-      outBpp*=2;
-      frm = TextureFormat(uint8_t(TextureFormat::R16)+uint8_t(frm)-uint8_t(TextureFormat::R8));
-      }
-
-    out = reinterpret_cast<uint8_t*>(malloc(outW*outH*outBpp));
     png_set_interlace_handling(png_ptr);
     png_read_update_info(png_ptr, info_ptr);
 
@@ -86,10 +105,15 @@ struct PixmapCodecPng::Impl {
     int pass =  png_set_interlace_handling(png_ptr);
     for(int j = 0; j < pass; j++) {
       for(uint32_t y=0; y<outH; y++) {
-        png_bytep rp = &out[y*outW*outBpp];
+        png_bytep rp = &dest[y*outW*outBpp];
         png_read_row(png_ptr, rp, nullptr);
+        // interlaced rows are final only after last pass
+        if(cb!=nullptr && *cb && pass==1)
+          (*cb)(0,y,1);
         }
       }
+    if(cb!=nullptr && *cb && pass>1)
+      (*cb)(0,0,outH);
 
     png_read_end(png_ptr, info_ptr);
     return true;
@@ -129,6 +153,47 @@ bool PixmapCodecPng::testFormat(const PixmapCodec::Context& c) const {
 
 uint8_t* PixmapCodecPng::load(PixmapCodec::Context& c, uint32_t& w, uint32_t& h,
                               TextureFormat& frm, uint32_t& mipCnt, size_t& dataSz, uint32_t& bpp) const {
+  Info     info;
+  uint8_t* out = implDecode(c,info,bpp,nullptr,0,nullptr);
+  if(out==nullptr)
+    return nullptr;
+  w      = info.w;
+  h      = info.h;
+  frm    = info.frm;
+  mipCnt = info.mipCnt;
+  dataSz = info.dataSz;
+  return out;
+  }
+
+bool PixmapCodecPng::probe(const PixmapCodec::Context& c, Info& info) const {
+  // signature + IHDR chunk
+  png_byte head[8+8+13] = {};
+  if(c.peek(head,sizeof(head))!=sizeof(head) || png_sig_cmp(head, 0, 8)!=0)
+    return false;
+  if(std::memcmp(head+12,"IHDR",4)!=0)
+    return false;
+
+  auto u32 = [](const png_byte* b) {
+    return (uint32_t(b[0])<<24) | (uint32_t(b[1])<<16) | (uint32_t(b[2])<<8) | uint32_t(b[3]);
+    };
+
+  uint32_t bpp = 0;
+  if(!pngFormat(head[25],head[24],info.frm,bpp))
+    return false;
+  info.w      = u32(head+16);
+  info.h      = u32(head+20);
+  info.mipCnt = 1;
+  info.dataSz = size_t(info.w)*info.h*bpp;
+  return true;
+  }
+
+bool PixmapCodecPng::decode(PixmapCodec::Context& c, Info& info, uint8_t* out, size_t outSz, const RowCallback& cb) const {
+  uint32_t bpp = 0;
+  return implDecode(c,info,bpp,out,outSz,&cb)!=nullptr;
+  }
+
+uint8_t* PixmapCodecPng::implDecode(PixmapCodec::Context& c, Info& info, uint32_t& bpp,
+                                    uint8_t* dest, size_t destSz, const RowCallback* cb) const {
   auto& f = c.device;
   png_byte head[8];
   if(f.read(head,8)!=8 || png_sig_cmp(head, 0, 8)!=0)
@@ -147,20 +212,22 @@ uint8_t* PixmapCodecPng::load(PixmapCodec::Context& c, uint32_t& w, uint32_t& h,
 
   // work
   Impl r(&f);
-  bool readed = r.readPng(png_ptr,info_ptr,frm,w,h,bpp);
+  bool readed = r.readPng(png_ptr,info_ptr,info.frm,info.w,info.h,bpp,dest,destSz,cb);
 
   // cleanup
   png_destroy_info_struct(png_ptr, &info_ptr);
   png_destroy_read_struct(&png_ptr, nullptr, nullptr);
 
-  uint8_t* out = nullptr;
-  if(readed) {
-    out    = r.out;
-    mipCnt = 1;
-    dataSz = w*h*bpp;
-    r.out = nullptr;
-    }
-  return out;
+  if(!readed)
+    return nullptr;
+
+  info.mipCnt = 1;
+  info.dataSz = size_t(info.w)*info.h*bpp;
+  if(dest!=nullptr)
+    return dest;
+  uint8_t* ret = r.out;
+  r.out = nullptr;
+  return ret;
   }
 
 bool PixmapCodecPng::save(ODevice& f, const char* ext, const uint8_t* data,
@@ -1,9 +1,11 @@
 #include "pixmap.h"
 
 #include <Tempest/File>
+#include <Tempest/MemReader>
 #include <Tempest/Except>
 
 #include "pixmapcodec.h"
+#include "image/mipgenerator.h"
 #include "thirdparty/squish/squish.h"
 
 #include <vector>
@@ -43,80 +45,95 @@ struct Pixmap::Impl {
     std::memcpy(data,other.data,dataSz);
     }
 
-  Impl(const Impl& other, TextureFormat conv):w(other.w),h(other.h),frm(conv) {
-    size_t size = calcDataSize(w,h,frm);
+  Impl(const Impl& other, TextureFormat conv):w(other.w),h(other.h),frm(conv),mipCnt(other.mipCnt) {
+    size_t size = calcDataSize(w,h,frm,mipCnt);
     data = reinterpret_cast<uint8_t*>(std::malloc(size));
     if(!data)
       throw std::bad_alloc();
     dataSz = size;
 
-    if(frm==TextureFormat::RGBA8 && other.frm==TextureFormat::RGB8) {
+    const uint8_t* src = other.data;
+    uint8_t*       dst = data;
+    uint32_t       mw  = w, mh = h;
+    for(uint32_t i=0; i<mipCnt; ++i) {
+      convertLevel(dst,frm,src,other.frm,mw,mh);
+      src += calcDataSize(mw,mh,other.frm);
+      dst += calcDataSize(mw,mh,frm);
+      mw = std::max<uint32_t>(1,mw/2);
+      mh = std::max<uint32_t>(1,mh/2);
+      }
+    }
+
+  static void convertLevel(uint8_t* data, TextureFormat frm, const uint8_t* src, TextureFormat srcFrm, uint32_t w, uint32_t h) {
+    if(frm==TextureFormat::RGBA8 && srcFrm==TextureFormat::RGB8) {
       // specialize a common case
       const size_t sz = size_t(w)*size_t(h);
       for(size_t i=0;i<sz;++i) {
         uint32_t&       pix=reinterpret_cast<uint32_t*>(data)[i];
-        const uint8_t*  s  =other.data+i*3;
+        const uint8_t*  s  =src+i*3;
         pix = uint32_t(s[0])<<0 | uint32_t(s[1])<<8 | uint32_t(s[2])<<16 | uint32_t(255)<<24;
         }
       return;
       }
 
-    if(isCompressed(other.frm)) {
+    if(isCompressed(srcFrm)) {
       assert(frm==TextureFormat::RGB8 || frm==TextureFormat::RGBA8); // rest is handled outside of this function
       static const int kfrm[] = {squish::kDxt1,squish::kDxt3,squish::kDxt5};
       if(frm==TextureFormat::RGB8)
-        ddsToRgba(data,other.data,w,h,kfrm[uint8_t(other.frm)-uint8_t(TextureFormat::DXT1)],3); else
-        ddsToRgba(data,other.data,w,h,kfrm[uint8_t(other.frm)-uint8_t(TextureFormat::DXT1)],4);
+        ddsToRgba(data,src,w,h,kfrm[uint8_t(srcFrm)-uint8_t(TextureFormat::DXT1)],3); else
+        ddsToRgba(data,src,w,h,kfrm[uint8_t(srcFrm)-uint8_t(TextureFormat::DXT1)],4);
       return;
       }
 
     if(isCompressed(frm)) {
-      // TODO: image compression
-      throw std::runtime_error("unimplemented");
+      assert(srcFrm==TextureFormat::RGBA8); // rest is handled outside of this function
+      static const int kfrm[] = {squish::kDxt1,squish::kDxt3,squish::kDxt5};
+      squish::CompressImage(src,int(w),int(h),data,kfrm[uint8_t(frm)-uint8_t(TextureFormat::DXT1)]);
+      return;
       }
 
     // noncompressed, non-packed
     const uint8_t compDst = Pixmap::componentCount(frm);
-    const uint8_t compSrc = Pixmap::componentCount(other.frm);
+    const uint8_t compSrc = Pixmap::componentCount(srcFrm);
 
     const uint8_t byteDst = bytesPerChannel(frm);
-    const uint8_t byteSrc = bytesPerChannel(other.frm);
+    const uint8_t byteSrc = bytesPerChannel(srcFrm);
 
     switch(byteDst) {
       case 1:{
         switch(byteSrc) {
-          case 1: noncompresedConv<uint8_t,uint8_t> (w,h, data,other.data, compDst, compSrc); return;
-          case 2: noncompresedConv<uint8_t,uint16_t>(w,h, data,other.data, compDst, compSrc); return;
+          case 1: noncompresedConv<uint8_t,uint8_t> (w,h, data,src, compDst, compSrc); return;
+          case 2: noncompresedConv<uint8_t,uint16_t>(w,h, data,src, compDst, compSrc); return;
           case 4:
-            if(isFloat32Frm(other.frm))
-              noncompresedConv<uint8_t,float>   (w,h, data,other.data, compDst, compSrc); else
-              noncompresedConv<uint8_t,uint32_t>(w,h, data,other.data, compDst, compSrc);
+            if(isFloat32Frm(srcFrm))
+              noncompresedConv<uint8_t,float>   (w,h, data,src, compDst, compSrc); else
+              noncompresedConv<uint8_t,uint32_t>(w,h, data,src, compDst, compSrc);
             return;
           }
         }
       case 2:{
         switch(byteSrc) {
-          case 1: noncompresedConv<uint16_t,uint8_t> (w,h, data,other.data, compDst, compSrc); return;
-          case 2: noncompresedConv<uint16_t,uint16_t>(w,h, data,other.data, compDst, compSrc); return;
+          case 1: noncompresedConv<uint16_t,uint8_t> (w,h, data,src, compDst, compSrc); return;
+          case 2: noncompresedConv<uint16_t,uint16_t>(w,h, data,src, compDst, compSrc); return;
           case 4:
-            if(isFloat32Frm(other.frm))
-              noncompresedConv<uint16_t,float>   (w,h, data,other.data, compDst, compSrc); else
-              noncompresedConv<uint16_t,uint32_t>(w,h, data,other.data, compDst, compSrc);
+            if(isFloat32Frm(srcFrm))
+              noncompresedConv<uint16_t,float>   (w,h, data,src, compDst, compSrc); else
+              noncompresedConv<uint16_t,uint32_t>(w,h, data,src, compDst, compSrc);
             return;
           }
         }
       case 4:{
         switch(byteSrc) {
-          case 1: noncompresedConv<float,uint8_t> (w,h, data,other.data, compDst, compSrc); return;
-          case 2: noncompresedConv<float,uint16_t>(w,h, data,other.data, compDst, compSrc); return;
+          case 1: noncompresedConv<float,uint8_t> (w,h, data,src, compDst, compSrc); return;
+          case 2: noncompresedConv<float,uint16_t>(w,h, data,src, compDst, compSrc); return;
           case 4:
-            if(isFloat32Frm(frm) && isFloat32Frm(other.frm))
-              noncompresedConv<float,float>(w,h, data,other.data, compDst, compSrc); else
+            if(isFloat32Frm(frm) && isFloat32Frm(srcFrm))
+              noncompresedConv<float,float>(w,h, data,src, compDst, compSrc); else
             if(isFloat32Frm(frm))
-                noncompresedConv<float,uint32_t>(w,h, data,other.data, compDst, compSrc); else
-            if(isFloat32Frm(other.frm))
-              noncompresedConv<uint32_t,float>(w,h, data,other.data, compDst, compSrc); else
-              noncompresedConv<uint32_t,uint32_t>(w,h, data,other.data, compDst, compSrc);
+                noncompresedConv<float,uint32_t>(w,h, data,src, compDst, compSrc); else
+            if(isFloat32Frm(srcFrm))
+              noncompresedConv<uint32_t,float>(w,h, data,src, compDst, compSrc); else
+              noncompresedConv<uint32_t,uint32_t>(w,h, data,src, compDst, compSrc);
             return;
           }
         }
@@ -135,8 +152,38 @@ struct Pixmap::Impl {
       throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
     }
 
+  Impl(const MappedFile& f){
+    const uint8_t* px = PixmapCodec::viewImg(f.data(),f.size(),w,h,frm,mipCnt,dataSz);
+    if(px!=nullptr) {
+      data  = const_cast<uint8_t*>(px);
+      owner = false;
+      return;
+      }
+
+    MemReader rd(f.data(),f.size());
+    uint32_t  bpp = 0;
+    frm  = TextureFormat::RGBA8;
+    data = PixmapCodec::loadImg(rd,w,h,frm,mipCnt,bpp,dataSz);
+
+    if(data==nullptr && bpp==0)
+      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    }
+
   ~Impl(){
-    PixmapCodec::freeImg(data);
+    if(owner)
+      PixmapCodec::freeImg(data);
+    }
+
+  void detach() {
+    if(owner)
+      return;
+    // read-only view of mapped file
+    auto* cpy = reinterpret_cast<uint8_t*>(std::malloc(dataSz));
+    if(!cpy)
+      throw std::bad_alloc();
+    std::memcpy(cpy,data,dataSz);
+    data  = cpy;
+    owner = true;
     }
 
   static size_t calcDataSize(uint32_t w, uint32_t h, TextureFormat frm) {
@@ -145,6 +192,26 @@ struct Pixmap::Impl {
     return size_t(bsz.w)*size_t(bsz.h)*size_t(bpb);
     }
 
+  static size_t calcDataSize(uint32_t w, uint32_t h, TextureFormat frm, uint32_t mipCnt) {
+    size_t ret = 0;
+    for(uint32_t i=0; i<mipCnt; ++i) {
+      ret += calcDataSize(w,h,frm);
+      w = std::max<uint32_t>(1,w/2);
+      h = std::max<uint32_t>(1,h/2);
+      }
+    return ret;
+    }
+
+  static uint32_t fullMipCount(uint32_t w, uint32_t h) {
+    uint32_t s = std::max(w,h);
+    uint32_t n = 1;
+    while(s>1) {
+      ++n;
+      s = s/2;
+      }
+    return n;
+    }
+
   static std::unique_ptr<Impl,Deleter> convert(const Impl& other, TextureFormat frm) {
     if(other.frm==frm)
       return std::unique_ptr<Impl,Deleter>(new Impl(other)); //copy
@@ -156,6 +223,11 @@ struct Pixmap::Impl {
         return std::unique_ptr<Impl,Deleter>(new Impl(tmp,frm));
         }
       }
+    else if(isCompressed(frm) && other.frm!=TextureFormat::RGBA8) {
+      // compressor works only with rgba input
+      Impl tmp(other,TextureFormat::RGBA8);
+      return std::unique_ptr<Impl,Deleter>(new Impl(tmp,frm));
+      }
 
     return std::unique_ptr<Impl,Deleter>(new Impl(other,frm));
     }
@@ -262,6 +334,52 @@ struct Pixmap::Impl {
            frm==TextureFormat::DXT5;
     }
 
+  void generateMips(MipFilter filter, bool sRGB) {
+    if(isCompressed(frm)) {
+      // decompress base level, build chain and compress it back
+      Impl base(w,h,TextureFormat::RGBA8);
+      convertLevel(base.data,base.frm,data,frm,w,h);
+      base.generateMips(filter,sRGB);
+
+      Impl cmp(base,frm);
+      std::swap(data,  cmp.data);
+      std::swap(dataSz,cmp.dataSz);
+      std::swap(owner, cmp.owner);
+      mipCnt = cmp.mipCnt;
+      return;
+      }
+
+    if(!Detail::MipGenerator::isSupported(frm))
+      throw std::system_error(Tempest::GraphicsErrc::UnsupportedTextureFormat, formatName(frm));
+
+    const uint32_t mips = fullMipCount(w,h);
+    const size_t   size = calcDataSize(w,h,frm,mips);
+    auto*          px   = reinterpret_cast<uint8_t*>(std::malloc(size));
+    if(!px)
+      throw std::bad_alloc();
+    std::memcpy(px,data,calcDataSize(w,h,frm));
+
+    Detail::MipGenerator gen(filter,sRGB);
+    uint8_t* src = px;
+    uint32_t sw  = w, sh = h;
+    for(uint32_t i=1; i<mips; ++i) {
+      const uint32_t dw  = std::max<uint32_t>(1,sw/2);
+      const uint32_t dh  = std::max<uint32_t>(1,sh/2);
+      uint8_t*       dst = src + calcDataSize(sw,sh,frm);
+      gen.resample(dst,dw,dh,src,sw,sh,frm);
+      src = dst;
+      sw  = dw;
+      sh  = dh;
+      }
+
+    if(owner)
+      PixmapCodec::freeImg(data);
+    data   = px;
+    dataSz = size;
+    owner  = true;
+    mipCnt = mips;
+    }
+
   void save(ODevice& f,const char* ext){
     PixmapCodec::saveImg(f,ext,data,dataSz,w,h,frm);
     }
@@ -277,8 +395,8 @@ struct Pixmap::Impl {
         uint32_t pos = ((i/4) + (r/4)*w4)*blocksize;
         squish::Decompress( &pixels[0][0][0], &dds[pos], frm );
 
-        for(uint32_t x=0; x<4; ++x)
-          for(uint32_t y=0; y<4; ++y){
+        for(uint32_t x=0; x<4 && i+x<w; ++x)
+          for(uint32_t y=0; y<4 && r+y<h; ++y){
             uint8_t * v = &px[ (i+x + (r+y)*w)*bpp ];
             std::memcpy( v, pixels[y][x], bpp);
             }
@@ -291,6 +409,7 @@ struct Pixmap::Impl {
   size_t        dataSz = 0;
   TextureFormat frm    = TextureFormat::RGB8;
   uint32_t      mipCnt = 1;
+  bool          owner  = true;
 
   static Impl   zero;
   };
@@ -337,6 +456,10 @@ Pixmap::Pixmap(IDevice &input) {
   impl.reset(new Impl(input));
   }
 
+Pixmap::Pixmap(const MappedFile& file)
+  :impl(new Impl(file)) {
+  }
+
 Pixmap::Pixmap(const Pixmap &src)
   :impl(new Impl(*src.impl)){
   }
@@ -360,6 +483,12 @@ Pixmap& Pixmap::operator=(const Pixmap &p) {
 Pixmap::~Pixmap() {
   }
 
+void Pixmap::generateMips(MipFilter filter, bool sRGB) {
+  if(isEmpty())
+    return;
+  impl->generateMips(filter,sRGB);
+  }
+
 void Pixmap::save(const char *path, const char *ext) const {
   if(ext==nullptr) {
     for(size_t i=0; path[i]; ++i)
@@ -402,6 +531,7 @@ const void *Pixmap::data() const {
   }
 
 void *Pixmap::data() {
+  impl->detach();
   return impl->data;
   }
 
@@ -9,9 +9,16 @@ namespace Tempest {
 
 class IDevice;
 class ODevice;
+class MappedFile;
 
 class Pixmap final {
   public:
+    enum class MipFilter : uint8_t {
+      Box,
+      Lanczos,
+      Kaiser,
+      };
+
     Pixmap();
     Pixmap(const Pixmap& src, TextureFormat conv);
     Pixmap(uint32_t w, uint32_t h, TextureFormat frm);
@@ -20,6 +27,8 @@ class Pixmap final {
     Pixmap(const char16_t* path);
     Pixmap(const std::u16string& path);
     Pixmap(IDevice& input);
+    // zero-copy, if possible: pixels are referencing memory of 'file', that must outlive the pixmap
+    explicit Pixmap(const MappedFile& file);
 
     Pixmap(const Pixmap& src);
     Pixmap(Pixmap&& p);
@@ -28,6 +37,9 @@ class Pixmap final {
 
     ~Pixmap();
 
+    // builds full mip-chain on cpu, from the base level
+    void        generateMips(MipFilter filter = MipFilter::Kaiser, bool sRGB = false);
+
     void        save(const char* path, const char* ext=nullptr) const;
     void        save(ODevice&    fout, const char *ext=nullptr) const;
 
@@ -6,8 +6,10 @@
 #include "image/pixmapcodechdr.h"
 
 #include <Tempest/IDevice>
+#include <Tempest/MemReader>
 #include <Tempest/Except>
 
+#include <algorithm>
 #include <cstring>
 #include "thirdparty/squish/squish.h"
 
@@ -49,6 +51,45 @@ struct PixmapCodec::Impl {
     throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
     }
 
+  bool probe(IDevice& f, Info& info) {
+    Context ctx(f);
+
+    for(auto& i:codec)
+      if(i->testFormat(ctx)) {
+        if(i->probe(ctx,info))
+          return true;
+        }
+    return false;
+    }
+
+  bool decode(IDevice& f, Info& info, uint8_t* out, size_t outSz, const RowCallback& cb) {
+    Context ctx(f);
+
+    for(auto& i:codec)
+      if(i->testFormat(ctx)) {
+        Info hdr;
+        if(!i->probe(ctx,hdr))
+          continue;
+        if(hdr.dataSz>outSz)
+          return false;
+        if(!i->decode(ctx,info,out,outSz,cb))
+          throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+        return true;
+        }
+
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    }
+
+  const uint8_t* view(const uint8_t* src, size_t srcSz, uint32_t& w, uint32_t& h, TextureFormat& frm, uint32_t& mipCnt, size_t& dataSz) {
+    MemReader rd(src,srcSz);
+    Context   ctx(rd);
+
+    for(auto& i:codec)
+      if(i->testFormat(ctx))
+        return i->view(src,srcSz,w,h,frm,mipCnt,dataSz);
+    return nullptr;
+    }
+
   void implSave(ODevice &f, char *ext, const uint8_t *data, size_t dataSz, uint32_t w, uint32_t h, TextureFormat frm) {
     if(ext!=nullptr) {
       for(size_t i=0;ext[i];++i)
@@ -95,10 +136,39 @@ PixmapCodec::Impl &PixmapCodec::instance() {
   return inst;
   }
 
+size_t PixmapCodec::Info::mipSize(uint32_t mip) const {
+  uint32_t mw = w, mh = h;
+  for(uint32_t i=0; i<mip; ++i) {
+    mw = std::max<uint32_t>(1,mw/2);
+    mh = std::max<uint32_t>(1,mh/2);
+    }
+  auto bsz = Pixmap::blockCount(frm,mw,mh);
+  return size_t(bsz.w)*size_t(bsz.h)*Pixmap::blockSizeForFormat(frm);
+  }
+
+size_t PixmapCodec::Info::mipOffset(uint32_t mip) const {
+  size_t ret = 0;
+  for(uint32_t i=0; i<mip; ++i)
+    ret += mipSize(i);
+  return ret;
+  }
+
+bool PixmapCodec::probeImg(IDevice& f, Info& info) {
+  return instance().probe(f,info);
+  }
+
+bool PixmapCodec::decodeImg(IDevice& f, Info& info, void* out, size_t outSz, const RowCallback& cb) {
+  return instance().decode(f,info,reinterpret_cast<uint8_t*>(out),outSz,cb);
+  }
+
 uint8_t* PixmapCodec::loadImg(IDevice &f, uint32_t &w, uint32_t &h, TextureFormat& frm, uint32_t &mipCnt, uint32_t &bpp, size_t &dataSz) {
   return instance().load(f,w,h,frm,mipCnt,bpp,dataSz);
   }
 
+const uint8_t* PixmapCodec::viewImg(const uint8_t* src, size_t srcSz, uint32_t& w, uint32_t& h, TextureFormat& frm, uint32_t& mipCnt, size_t& dataSz) {
+  return instance().view(src,srcSz,w,h,frm,mipCnt,dataSz);
+  }
+
 void PixmapCodec::saveImg(ODevice &f, const char *ext, const uint8_t *data, size_t dataSz, uint32_t w, uint32_t h, TextureFormat frm) {
   instance().save(f,ext,data,dataSz,w,h,frm);
   }
@@ -106,3 +176,33 @@ void PixmapCodec::saveImg(ODevice &f, const char *ext, const uint8_t *data, size
 void PixmapCodec::freeImg(uint8_t *px) {
   std::free(px);
   }
+
+const uint8_t* PixmapCodec::view(const uint8_t*, size_t, uint32_t&, uint32_t&, TextureFormat&, uint32_t&, size_t&) const {
+  return nullptr;
+  }
+
+bool PixmapCodec::probe(const Context&, Info&) const {
+  return false;
+  }
+
+bool PixmapCodec::decode(Context& c, Info& info, uint8_t* out, size_t outSz, const RowCallback& cb) const {
+  // generic path: codec is not able to decode in-place
+  uint32_t bpp = 0;
+  uint8_t* px  = load(c,info.w,info.h,info.frm,info.mipCnt,info.dataSz,bpp);
+  if(px==nullptr)
+    return false;
+  std::memcpy(out,px,std::min(outSz,info.dataSz));
+  freeImg(px);
+  notifyMips(info,cb);
+  return true;
+  }
+
+void PixmapCodec::notifyMips(const Info& info, const RowCallback& cb) {
+  if(!cb)
+    return;
+  uint32_t h = info.h;
+  for(uint32_t i=0; i<info.mipCnt; ++i) {
+    cb(i,0,h);
+    h = std::max<uint32_t>(1,h/2);
+    }
+  }
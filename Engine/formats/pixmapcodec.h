@@ -2,6 +2,7 @@
 
 #include <Tempest/Pixmap>
 
+#include <functional>
 #include <vector>
 #include <memory>
 
@@ -27,7 +28,25 @@ class PixmapCodec {
         uint8_t buf[128];
       };
 
+    struct Info final {
+      uint32_t      w      = 0;
+      uint32_t      h      = 0;
+      TextureFormat frm    = TextureFormat::Undefined;
+      uint32_t      mipCnt = 1;
+      size_t        dataSz = 0;
+
+      size_t mipSize  (uint32_t mip) const;
+      size_t mipOffset(uint32_t mip) const;
+      };
+
+    // rows [y, y+count) of mip-level are ready
+    using RowCallback = std::function<void(uint32_t mip, uint32_t y, uint32_t count)>;
+
+    static bool      probeImg (IDevice& f, Info& info);
+    static bool      decodeImg(IDevice& f, Info& info, void* out, size_t outSz, const RowCallback& cb = nullptr);
+
     static uint8_t*  loadImg (IDevice& f, uint32_t& w, uint32_t& h, TextureFormat& frm, uint32_t& mipCnt, uint32_t &bpp, size_t& dataSz);
+    static const uint8_t* viewImg(const uint8_t* src, size_t srcSz, uint32_t& w, uint32_t& h, TextureFormat& frm, uint32_t& mipCnt, size_t& dataSz);
     static void      saveImg (ODevice& f, const char* ext, const uint8_t *data, size_t dataSz, uint32_t w, uint32_t h, TextureFormat frm);
 
     static void      freeImg (uint8_t* px);
@@ -36,6 +55,12 @@ class PixmapCodec {
     virtual bool     testFormat(const Context& c) const = 0;
     virtual uint8_t* load(PixmapCodec::Context &c,uint32_t& w,uint32_t& h,TextureFormat& frm,uint32_t& mipCnt,size_t& dataSz,uint32_t& bpp) const = 0;
     virtual bool     save(ODevice& f,const char* ext, const uint8_t *data, size_t dataSz, uint32_t w, uint32_t h, TextureFormat frm) const = 0;
+    // header-only; must not advance the device
+    virtual bool     probe (const Context& c, Info& info) const;
+    virtual bool     decode(Context& c, Info& info, uint8_t* out, size_t outSz, const RowCallback& cb) const;
+    static  void     notifyMips(const Info& info, const RowCallback& cb);
+    // returns pointer into 'src', if file payload is usable as-is, without decoding
+    virtual const uint8_t* view(const uint8_t* src, size_t srcSz, uint32_t& w, uint32_t& h, TextureFormat& frm, uint32_t& mipCnt, size_t& dataSz) const;
 
   private:
     struct Impl;
@@ -0,0 +1,304 @@
+#include "textlayout.h"
+
+#include <Tempest/TextureAtlas>
+#include "../utility/utf8_helper.h"
+#include "textshaper.h"
+
+#include <cmath>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+using namespace Tempest;
+
+struct TextLayout::Key {
+  std::string_view text;
+  const void*      face  = nullptr;
+  float            size  = 0;
+  int              wrapW = -1;
+  uint64_t         atlas = 0;
+  float            sc    = 1.f;
+  float            scH   = 1.f;
+  float            scV   = 1.f;
+  bool             sdf   = false;
+
+  bool operator == (const Key& k) const {
+    return face==k.face && size==k.size && wrapW==k.wrapW && atlas==k.atlas &&
+           sc==k.sc && scH==k.scH && scV==k.scV && sdf==k.sdf && text==k.text;
+    }
+  };
+
+struct TextLayout::Cache {
+  enum { MaxEntries = 1024 };
+
+  struct Entry {
+    std::string                       text;
+    Key                               key;
+    // holds font alive, so address in key is not reused
+    std::shared_ptr<const void>       face;
+    std::shared_ptr<const TextLayout> val;
+    };
+
+  struct Hash {
+    size_t operator()(const Key& k) const {
+      size_t h = std::hash<std::string_view>()(k.text);
+      auto   mix = [&h](size_t v){ h ^= v + 0x9e3779b97f4a7c15ull + (h<<6) + (h>>2); };
+      mix(std::hash<const void*>()(k.face));
+      mix(std::hash<float>()(k.size));
+      mix(std::hash<int>()(k.wrapW));
+      mix(std::hash<uint64_t>()(k.atlas));
+      mix(std::hash<float>()(k.sc));
+      mix(std::hash<bool>()(k.sdf));
+      return h;
+      }
+    };
+
+  std::shared_ptr<const TextLayout> find(const Key& k) {
+    auto it = index.find(k);
+    if(it==index.end())
+      return nullptr;
+    lru.splice(lru.begin(),lru,it->second);
+    return it->second->val;
+    }
+
+  void insert(const Key& k, std::shared_ptr<const void> face, std::shared_ptr<const TextLayout> val) {
+    if(index.find(k)!=index.end())
+      return;
+    if(lru.size()>=MaxEntries) {
+      index.erase(lru.back().key);
+      lru.pop_back();
+      }
+    lru.emplace_front();
+    Entry& e = lru.front();
+    e.text     = std::string(k.text);
+    e.key      = k;
+    e.key.text = e.text;
+    e.face     = std::move(face);
+    e.val      = std::move(val);
+    index[e.key] = lru.begin();
+    }
+
+  void clear() {
+    index.clear();
+    lru.clear();
+    }
+
+  void clear(uint64_t atlas) {
+    for(auto i=lru.begin(); i!=lru.end();) {
+      if(i->key.atlas==atlas) {
+        index.erase(i->key);
+        i = lru.erase(i);
+        } else {
+        ++i;
+        }
+      }
+    }
+
+  std::mutex                                                sync;
+  std::list<Entry>                                          lru;
+  std::unordered_map<Key,std::list<Entry>::iterator,Hash>   index;
+  };
+
+TextLayout::TextLayout(const Font& fnt, const char* text, int wrapW, TextureAtlas* ta, const Transform& tr) {
+  pSz = int(std::ceil(fnt.pixelSize()));
+  sdf = fnt.isDistanceField() && ta!=nullptr;
+  if(text==nullptr)
+    return;
+
+  Font fx = fnt;
+  fx.setPixelSize(std::ceil(fnt.pixelSize()*tr.scaleHint()));
+  const float kH = 1.f/tr.scaleHintH();
+  const float kV = 1.f/tr.scaleHintV();
+
+  auto                           shaper = TextShaper::instance();
+  auto&                          face   = fnt.fnt[fnt.bold][fnt.italic];
+  std::vector<TextShaper::Glyph> run;
+
+  int  y = 0;
+  auto addLine = [&](size_t from, size_t to) {
+    if(line.empty()) {
+      for(Utf8Iterator c(text+from,to-from); c.hasData();) {
+        auto& l = fnt.letterGeometry(c.next());
+        line0 = std::max(l.size.h+l.dpos.y,line0);
+        }
+      }
+
+    run.clear();
+    shaper->shape(face,fnt.pixelSize(),std::string_view(text+from,to-from),run);
+
+    Line ln;
+    ln.begin = glyph.size();
+    int  x   = 0;
+    for(auto& g:run) {
+      addGlyph(fnt,fx,ta,g,x,y,kH,kV);
+      x += g.advance;
+      }
+    ln.end   = glyph.size();
+    ln.width = x;
+    line.push_back(ln);
+
+    sz.w  = std::max(sz.w,x);
+    sz.h += pSz;
+    y    += pSz;
+    };
+
+  std::vector<int> adv;
+  auto isSpace = [](char c) { return c==' ' || c=='\t'; };
+
+  const size_t len = std::strlen(text);
+  size_t       b   = 0;
+  while(b<len) {
+    size_t pe = b;
+    if(wrapW==SingleLine)
+      pe = len; else
+      while(pe<len && text[pe]!='\n')
+        ++pe;
+    const size_t next = (pe<len) ? pe+1 : pe;
+    size_t       e    = pe;
+    while(wrapW!=SingleLine && e>b && text[e-1]=='\r')
+      --e;
+
+    if(wrapW<0) {
+      addLine(b,e);
+      b = next;
+      continue;
+      }
+
+    advances(fnt,std::string_view(text+b,e-b),adv);
+
+    // greedy: break after last space, that fits; inside of a word, if the word alone doesn't fit
+    const size_t n  = e-b;
+    size_t       st = 0;
+    do {
+      int    x    = 0;
+      size_t i    = st;
+      size_t word = st;
+      while(i<n) {
+        const size_t l  = std::max<size_t>(1,std::min(Detail::utf8LetterLength(text+b+i),n-i));
+        const bool   sp = isSpace(text[b+i]);
+        int          w  = 0;
+        for(size_t k=0; k<l; ++k)
+          w += adv[i+k];
+        if(!sp && x+w>wrapW && i>st)
+          break;
+        x += w;
+        i += l;
+        if(sp)
+          word = i;
+        }
+      size_t end = (i<n && word>st) ? word : i;
+      size_t le  = end;
+      // trailing spaces hang out of the line
+      while(le>st && isSpace(text[b+le-1]))
+        --le;
+      addLine(b+st,b+le);
+      st = end;
+      } while(st<n);
+    b = next;
+    }
+
+  th = line0;
+  if(line.size()>1)
+    th += int(line.size()-1)*pSz;
+  }
+
+void TextLayout::advances(const Font& fnt, std::string_view text, std::vector<int>& out) {
+  std::vector<TextShaper::Glyph> run;
+  TextShaper::instance()->shape(fnt.fnt[fnt.bold][fnt.italic],fnt.pixelSize(),text,run);
+  out.assign(text.size(),0);
+  for(auto& g:run)
+    if(g.cluster<out.size())
+      out[g.cluster] += g.advance;
+  }
+
+void TextLayout::addGlyph(const Font& fnt, const Font& fx, TextureAtlas* ta, const TextShaper::Glyph& sh,
+                          int x, int y, float kH, float kV) {
+  // codepoint lookups can use fallback fonts, glyph indices come from shaper substitutions
+  const FontElement& fe = fnt.fnt[fnt.bold][fnt.italic];
+  const FontElement& fr = fx .fnt[fx .bold][fx .italic];
+
+  auto& l = sh.ch!=0 ? fnt.letterGeometry(sh.ch) : fe.glyphGeometry(sh.index,fnt.pixelSize());
+  if(l.size.isEmpty())
+    return;
+
+  x += sh.offset.x;
+  y += sh.offset.y;
+
+  Glyph g;
+  if(sdf) {
+    // one distance-field glyph serves every size: scale it, transform does not matter
+    auto& v = sh.ch!=0 ? fe.distanceField(sh.ch,*ta) : fe.distanceFieldGlyph(sh.index,*ta);
+    float k = fnt.pixelSize()/FontElement::DistanceFieldSize;
+    g.view = v.view;
+    g.x    = float(x)+float(v.dpos.x)*k;
+    g.y    = float(y)+float(v.dpos.y)*k;
+    g.w    = float(v.size.w)*k;
+    g.h    = float(v.size.h)*k;
+    }
+  else if(ta!=nullptr) {
+    auto& v = sh.ch!=0 ? fx.letter(sh.ch,*ta) : fr.glyph(sh.index,fx.pixelSize(),*ta);
+    g.view = v.view;
+    g.x    = float(x)+float(v.dpos.x)*kH;
+    g.y    = float(y)+float(v.dpos.y)*kV;
+    g.w    = float(v.size.w)*kH;
+    g.h    = float(v.size.h)*kV;
+    } else {
+    g.x    = float(x+l.dpos.x);
+    g.y    = float(y+l.dpos.y);
+    g.w    = float(l.size.w);
+    g.h    = float(l.size.h);
+    }
+  glyph.push_back(std::move(g));
+  }
+
+std::shared_ptr<const TextLayout> TextLayout::get(const Font& fnt, const char* text, int wrapW, TextureAtlas* ta,
+                                                  const Transform& tr) {
+  Key k;
+  k.text  = text==nullptr ? std::string_view() : std::string_view(text);
+  k.face  = fnt.fnt[fnt.bold][fnt.italic].ptr.get();
+  k.size  = fnt.pixelSize();
+  k.wrapW = wrapW;
+  k.atlas = ta==nullptr ? 0 : ta->uid;
+  k.sc    = tr.scaleHint();
+  k.scH   = tr.scaleHintH();
+  k.scV   = tr.scaleHintV();
+  k.sdf   = fnt.isDistanceField() && ta!=nullptr;
+  if(k.sdf) {
+    k.sc  = 1.f;
+    k.scH = 1.f;
+    k.scV = 1.f;
+    }
+
+  auto& c = cache();
+  {
+  std::lock_guard<std::mutex> guard(c.sync);
+  if(auto ret = c.find(k))
+    return ret;
+  }
+
+  // layout outside of the lock: rasterization may take a while
+  auto ret = std::make_shared<const TextLayout>(fnt,text,wrapW,ta,tr);
+  std::lock_guard<std::mutex> guard(c.sync);
+  c.insert(k,fnt.fnt[fnt.bold][fnt.italic].ptr,ret);
+  return ret;
+  }
+
+void TextLayout::clearCache() {
+  auto& c = cache();
+  std::lock_guard<std::mutex> guard(c.sync);
+  c.clear();
+  }
+
+void TextLayout::clearCache(const TextureAtlas& ta) {
+  auto& c = cache();
+  std::lock_guard<std::mutex> guard(c.sync);
+  c.clear(ta.uid);
+  }
+
+TextLayout::Cache& TextLayout::cache() {
+  // never destroyed: atlases, that live in other statics, drop their layouts on destruction
+  static Cache* c = new Cache();
+  return *c;
+  }
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Tempest/Font>
+#include <Tempest/Transform>
+#include <Tempest/TextShaper>
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace Tempest {
+
+class TextureAtlas;
+
+class TextLayout final {
+  public:
+    struct Glyph final {
+      Tempest::Sprite view;
+      float           x=0, y=0;
+      float           w=0, h=0;
+      };
+
+    struct Line final {
+      size_t begin=0;
+      size_t end  =0;
+      int    width=0;
+      };
+
+    enum : int {
+      // break only at '\n'
+      NoWrap     = -1,
+      // whole text is one line, '\n' included: see Painter::drawText(x,y,txt)
+      SingleLine = -2,
+      };
+
+    TextLayout()=default;
+    // wrapW>=0: break at spaces, measured by TextShaper advances; ta==nullptr: geometry only, no sprites are rasterized
+    TextLayout(const Font& fnt, const char* text, int wrapW=-1, TextureAtlas* ta=nullptr,
+               const Transform& tr=Transform::identity());
+
+    const std::vector<Glyph>& glyphs()    const { return glyph;  }
+    const std::vector<Line>&  lines()     const { return line;   }
+    const Size&               size()      const { return sz;     }
+    int                       firstLine() const { return line0;  }
+    int                       height()    const { return th;     }
+    int                       lineStep()  const { return pSz;    }
+    bool                      isDistanceField() const { return sdf; }
+
+    // pen advance of each byte of a single line, shaped as in layout: kerning included, zero for inner bytes of clusters
+    static void advances(const Font& fnt, std::string_view text, std::vector<int>& out);
+
+    // layouts are memoized by (text, font, wrap, atlas, scale); unchanged text costs one lookup
+    static std::shared_ptr<const TextLayout> get(const Font& fnt, const char* text, int wrapW=-1, TextureAtlas* ta=nullptr,
+                                                 const Transform& tr=Transform::identity());
+    static void                              clearCache();
+    // drops layouts, that hold sprites of ta; called by ~TextureAtlas
+    static void                              clearCache(const TextureAtlas& ta);
+
+  private:
+    struct Key;
+    struct Cache;
+
+    static Cache& cache();
+
+    void addGlyph(const Font& fnt, const Font& fx, TextureAtlas* ta, const TextShaper::Glyph& sh,
+                  int x, int y, float kH, float kV);
+
+    std::vector<Glyph> glyph;
+    std::vector<Line>  line;
+    Size               sz;
+    int                line0 = 0;
+    int                th    = 0;
+    int                pSz   = 0;
+    bool               sdf   = false;
+  };
+
+}
@@ -0,0 +1,266 @@
+#include "textshaper.h"
+
+#include <Tempest/TextLayout>
+#include "../utility/utf8_helper.h"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+#if defined(TEMPEST_BUILD_HARFBUZZ)
+#include <hb.h>
+#endif
+
+using namespace Tempest;
+
+namespace {
+
+class SimpleShaper : public TextShaper {
+  public:
+    void shape(const FontElement& fnt, float size, std::string_view text, std::vector<Glyph>& out) override {
+      thread_local std::vector<Run> runs;
+      splitRuns(text,runs);
+
+      const size_t base = out.size();
+      for(auto& r:runs) {
+        const size_t first = out.size();
+        Utf8Iterator i(text.data()+r.begin,r.end-r.begin);
+        while(i.hasData()) {
+          Glyph g;
+          g.cluster = uint32_t(r.begin+i.pos());
+          g.ch      = i.next();
+          if(g.ch=='\0')
+            break;
+          if(g.ch=='\n' || g.ch=='\r')
+            continue;
+          g.index   = glyphIndex(fnt,g.ch);
+          g.advance = fnt.letterGeometry(g.ch,size).advance.x;
+          out.push_back(g);
+          }
+        if(r.dir==RightToLeft)
+          std::reverse(out.begin()+ptrdiff_t(first),out.end());
+        }
+
+      // kerning pairs are defined in visual order
+      for(size_t i=base+1; i<out.size(); ++i)
+        out[i-1].advance += kernAdvance(fnt,out[i-1].index,out[i].index,size);
+      }
+  };
+
+#if defined(TEMPEST_BUILD_HARFBUZZ)
+class HarfBuzzShaper : public TextShaper {
+  public:
+    ~HarfBuzzShaper() override {
+      for(auto& i:faces) {
+        hb_font_destroy(i.second.font);
+        hb_face_destroy(i.second.face);
+        }
+      }
+
+    void shape(const FontElement& fnt, float size, std::string_view text, std::vector<Glyph>& out) override {
+      hb_font_t* parent = font(fnt);
+      if(parent==nullptr)
+        return;
+
+      // hb_font_t is immutable once shared, per-size scale goes to a sub-font
+      hb_font_t*   hf  = hb_font_create_sub_font(parent);
+      const int    sc  = int(float(hb_face_get_upem(hb_font_get_face(parent)))*scale(fnt,size)*64.f);
+      hb_font_set_scale(hf,sc,sc);
+
+      thread_local std::vector<Run> runs;
+      hb_buffer_t* buf = hb_buffer_create();
+      splitRuns(text,runs);
+      for(auto& r:runs) {
+        hb_buffer_clear_contents(buf);
+        hb_buffer_add_utf8(buf,text.data(),int(text.size()),unsigned(r.begin),int(r.end-r.begin));
+        hb_buffer_set_direction(buf,r.dir==RightToLeft ? HB_DIRECTION_RTL : HB_DIRECTION_LTR);
+        hb_buffer_guess_segment_properties(buf);
+        hb_shape(hf,buf,nullptr,0);
+
+        unsigned int         count = 0;
+        hb_glyph_info_t*     info  = hb_buffer_get_glyph_infos(buf,&count);
+        hb_glyph_position_t* pos   = hb_buffer_get_glyph_positions(buf,&count);
+        for(unsigned int i=0; i<count; ++i) {
+          Glyph g;
+          g.index    = info[i].codepoint;
+          g.cluster  = info[i].cluster;
+          g.advance  = (pos[i].x_advance+32)/64;
+          g.offset.x = (pos[i].x_offset +32)/64;
+          g.offset.y = -(pos[i].y_offset+32)/64;
+          if(g.index==0) {
+            // .notdef: let the layout go through codepoint lookup and font fallback
+            uint32_t cp = 0;
+            Detail::utf8ToCodepoint(reinterpret_cast<const uint8_t*>(text.data()+g.cluster),cp);
+            g.ch = cp;
+            }
+          out.push_back(g);
+          }
+        }
+      hb_buffer_destroy(buf);
+      hb_font_destroy(hf);
+      }
+
+  private:
+    struct Face {
+      std::shared_ptr<const void> hold;
+      hb_face_t*                  face = nullptr;
+      hb_font_t*                  font = nullptr;
+      };
+
+    hb_font_t* font(const FontElement& fnt) {
+      std::lock_guard<std::mutex> guard(sync);
+      auto it = faces.find(fontId(fnt));
+      if(it!=faces.end())
+        return it->second.font;
+
+      size_t         sz   = 0;
+      const uint8_t* data = fontData(fnt,sz);
+      if(data==nullptr)
+        return nullptr;
+
+      Face f;
+      f.hold = fontHandle(fnt);
+      hb_blob_t* blob = hb_blob_create(reinterpret_cast<const char*>(data),unsigned(sz),HB_MEMORY_MODE_READONLY,nullptr,nullptr);
+      f.face = hb_face_create(blob,0);
+      f.font = hb_font_create(f.face);
+      hb_font_make_immutable(f.font);
+      hb_blob_destroy(blob);
+      faces[fontId(fnt)] = f;
+      return f.font;
+      }
+
+    std::mutex                            sync;
+    std::unordered_map<const void*,Face>  faces;
+  };
+#endif
+
+struct Global {
+  std::mutex                  sync;
+  std::shared_ptr<TextShaper> shaper;
+  };
+
+Global& global() {
+  static Global g;
+  return g;
+  }
+
+}
+
+std::shared_ptr<TextShaper> TextShaper::instance() {
+  auto& g = global();
+  std::lock_guard<std::mutex> guard(g.sync);
+  if(g.shaper==nullptr) {
+    g.shaper = harfBuzz();
+    if(g.shaper==nullptr)
+      g.shaper = simple();
+    }
+  return g.shaper;
+  }
+
+void TextShaper::setInstance(std::shared_ptr<TextShaper> sh) {
+  auto& g = global();
+  {
+  std::lock_guard<std::mutex> guard(g.sync);
+  g.shaper = std::move(sh);
+  }
+  // layouts shaped by previous instance
+  TextLayout::clearCache();
+  }
+
+std::shared_ptr<TextShaper> TextShaper::simple() {
+  return std::make_shared<SimpleShaper>();
+  }
+
+std::shared_ptr<TextShaper> TextShaper::harfBuzz() {
+#if defined(TEMPEST_BUILD_HARFBUZZ)
+  return std::make_shared<HarfBuzzShaper>();
+#else
+  return nullptr;
+#endif
+  }
+
+TextShaper::Direction TextShaper::direction(char32_t ch) {
+  if(ch<0x0590)
+    return (('A'<=ch && ch<='Z') || ('a'<=ch && ch<='z') || ch>=0xC0) ? LeftToRight : Neutral;
+  if(ch<=0x08FF)
+    return RightToLeft;  // Hebrew, Arabic, Syriac, Thaana, NKo, Samaritan, Mandaic
+  if(0xFB1D<=ch && ch<=0xFDFF)
+    return RightToLeft;  // Hebrew and Arabic presentation forms-A
+  if(0xFE70<=ch && ch<=0xFEFF)
+    return RightToLeft;  // Arabic presentation forms-B
+  if(0x2000<=ch && ch<=0x2BFF)
+    return Neutral;      // punctuation, symbols, arrows
+  if(0x3000<=ch && ch<=0x303F)
+    return Neutral;
+  return LeftToRight;
+  }
+
+void TextShaper::splitRuns(std::string_view text, std::vector<Run>& out) {
+  // single-level bidi: strong runs in a left-to-right paragraph,
+  // neutrals take the direction of their neighbours if both agree
+  struct Ch {
+    size_t    pos = 0;
+    Direction dir = Neutral;
+    };
+  thread_local std::vector<Ch> chars;
+  chars.clear();
+
+  Utf8Iterator i(text.data(),text.size());
+  while(i.hasData()) {
+    Ch c;
+    c.pos = i.pos();
+    c.dir = direction(i.next());
+    chars.push_back(c);
+    }
+
+  Direction prev = LeftToRight;
+  for(size_t i=0; i<chars.size();) {
+    if(chars[i].dir!=Neutral) {
+      prev = chars[i].dir;
+      ++i;
+      continue;
+      }
+    size_t e = i;
+    while(e<chars.size() && chars[e].dir==Neutral)
+      ++e;
+    const Direction next = e<chars.size() ? chars[e].dir : LeftToRight;
+    const Direction dir  = (prev==next) ? prev : LeftToRight;
+    for(; i<e; ++i)
+      chars[i].dir = dir;
+    }
+
+  out.clear();
+  for(size_t i=0; i<chars.size(); ++i) {
+    if(out.empty() || out.back().dir!=chars[i].dir) {
+      Run r;
+      r.begin = chars[i].pos;
+      r.dir   = chars[i].dir;
+      out.push_back(r);
+      }
+    out.back().end = (i+1<chars.size()) ? chars[i+1].pos : text.size();
+    }
+  }
+
+uint32_t TextShaper::glyphIndex(const FontElement& fnt, char32_t ch) {
+  return fnt.glyphIndex(ch);
+  }
+
+int TextShaper::kernAdvance(const FontElement& fnt, uint32_t a, uint32_t b, float size) {
+  return fnt.kernAdvance(a,b,size);
+  }
+
+float TextShaper::scale(const FontElement& fnt, float size) {
+  return fnt.scale(size);
+  }
+
+const uint8_t* TextShaper::fontData(const FontElement& fnt, size_t& sz) {
+  return fnt.rawData(sz);
+  }
+
+const void* TextShaper::fontId(const FontElement& fnt) {
+  return fnt.ptr.get();
+  }
+
+std::shared_ptr<const void> TextShaper::fontHandle(const FontElement& fnt) {
+  return fnt.ptr;
+  }
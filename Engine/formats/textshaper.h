@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Tempest/Font>
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace Tempest {
+
+class TextShaper {
+  public:
+    virtual ~TextShaper()=default;
+
+    struct Glyph final {
+      uint32_t       index   = 0; // glyph index in the font
+      char32_t       ch      = 0; // source codepoint, 0 if glyph has none (ligature)
+      uint32_t       cluster = 0; // byte offset in the source text
+      int            advance = 0;
+      Tempest::Point offset;
+      };
+
+    // appends glyphs of a single line in visual order
+    virtual void shape(const FontElement& fnt, float size, std::string_view text, std::vector<Glyph>& out) = 0;
+
+    static std::shared_ptr<TextShaper> instance();
+    static void                        setInstance(std::shared_ptr<TextShaper> sh);
+
+    // kerning and bidi runs, no substitutions
+    static std::shared_ptr<TextShaper> simple();
+    // nullptr, unless built with TEMPEST_BUILD_HARFBUZZ
+    static std::shared_ptr<TextShaper> harfBuzz();
+
+  protected:
+    enum Direction : uint8_t {
+      Neutral,
+      LeftToRight,
+      RightToLeft,
+      };
+
+    struct Run {
+      size_t    begin = 0;
+      size_t    end   = 0;
+      Direction dir   = LeftToRight;
+      };
+
+    static Direction      direction(char32_t ch);
+    static void           splitRuns(std::string_view text, std::vector<Run>& out);
+
+    static uint32_t       glyphIndex (const FontElement& fnt, char32_t ch);
+    static int            kernAdvance(const FontElement& fnt, uint32_t a, uint32_t b, float size);
+    static float          scale      (const FontElement& fnt, float size);
+    static const uint8_t* fontData   (const FontElement& fnt, size_t& sz);
+    static const void*    fontId     (const FontElement& fnt);
+    static std::shared_ptr<const void> fontHandle(const FontElement& fnt);
+  };
+
+}
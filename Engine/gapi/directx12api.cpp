@@ -247,16 +247,38 @@ AbstractGraphicsApi::PTexture DirectX12Api::createTexture(Device* d, const Pixma
   if(isCompressedFormat(frm))
     return createCompressedTexture(d,p,frm,mipCnt);
 
-  Detail::DxDevice& dx     = *reinterpret_cast<Detail::DxDevice*>(d);
-  DXGI_FORMAT       format = Detail::nativeFormat(frm);
-  uint32_t          row    = p.w()*p.bpp();
-  const uint32_t    pith   = ((row+D3D12_TEXTURE_DATA_PITCH_ALIGNMENT-1)/D3D12_TEXTURE_DATA_PITCH_ALIGNMENT)*D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
-  Detail::DxBuffer  stage  = dx.allocator.alloc(nullptr,p.h()*pith,MemUsage::TransferSrc,BufferHeap::Upload);
+  Detail::DxDevice& dx      = *reinterpret_cast<Detail::DxDevice*>(d);
+  DXGI_FORMAT       format  = Detail::nativeFormat(frm);
+  const uint32_t    bpp     = p.bpp();
+  const bool        baked   = (mipCnt>1 && p.mipCount()>=mipCnt);
+  const uint32_t    upload  = baked ? mipCnt : 1;
+
+  UINT     stageBufferSize = 0;
+  uint32_t w = p.w(), h = p.h();
+  for(uint32_t i=0; i<upload; i++) {
+    UINT pitch = alignTo(w*bpp,D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+    stageBufferSize += pitch*h;
+    stageBufferSize = alignTo(stageBufferSize,D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    w = std::max<uint32_t>(1,w/2);
+    h = std::max<uint32_t>(1,h/2);
+    }
+
+  Detail::DxBuffer  stage  = dx.allocator.alloc(nullptr,stageBufferSize,MemUsage::TransferSrc,BufferHeap::Upload);
   Detail::DxTexture buf    = dx.allocator.alloc(p,mipCnt,format);
 
-  for(uint32_t y=0; y<p.h(); ++y) {
-    auto px = reinterpret_cast<const uint8_t*>(p.data());
-    stage.update(px+y*row, y*pith, row);
+  auto     px     = reinterpret_cast<const uint8_t*>(p.data());
+  uint32_t offset = 0;
+  w = p.w();
+  h = p.h();
+  for(uint32_t i=0; i<upload; i++) {
+    const uint32_t row  = w*bpp;
+    const uint32_t pith = alignTo(row,D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+    for(uint32_t y=0; y<h; ++y)
+      stage.update(px+y*row, offset+y*pith, row);
+    px     += size_t(row)*h;
+    offset  = alignTo(offset+pith*h,D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    w = std::max<uint32_t>(1,w/2);
+    h = std::max<uint32_t>(1,h/2);
     }
 
   Detail::DSharedPtr<Buffer*>  pstage(new Detail::DxBuffer (std::move(stage)));
@@ -267,9 +289,17 @@ AbstractGraphicsApi::PTexture DirectX12Api::createTexture(Device* d, const Pixma
   cmd->hold(pbuf);
   cmd->hold(pstage); // preserve stage buffer, until gpu side copy is finished
 
-  cmd->copy(*pbuf.handler,p.w(),p.h(),0,*pstage.handler,0);
+  offset = 0;
+  w      = p.w();
+  h      = p.h();
+  for(uint32_t i=0; i<upload; i++) {
+    cmd->copy(*pbuf.handler,w,h,i,*pstage.handler,offset);
+    offset = alignTo(offset+alignTo(w*bpp,D3D12_TEXTURE_DATA_PITCH_ALIGNMENT)*h,D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    w = std::max<uint32_t>(1,w/2);
+    h = std::max<uint32_t>(1,h/2);
+    }
   cmd->barrier(*pbuf.handler, ResourceAccess::TransferDst, ResourceAccess::Sampler, uint32_t(-1));
-  if(mipCnt>1)
+  if(mipCnt>1 && !baked)
     cmd->generateMipmap(*pbuf.handler, p.w(), p.h(), mipCnt);
   cmd->end();
   dx.dataMgr().submit(std::move(cmd));
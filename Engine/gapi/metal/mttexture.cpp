@@ -38,7 +38,8 @@ MtTexture::MtTexture(MtDevice& d, const uint32_t w, const uint32_t h, const uint
 
 MtTexture::MtTexture(MtDevice& dev, const Pixmap& pm, uint32_t mipCnt, TextureFormat frm)
   :dev(dev), mipCnt(mipCnt) {
-  const uint32_t smip  = (isCompressedFormat(frm) ? mipCnt : 1);
+  const bool     baked = isCompressedFormat(frm) || (mipCnt>1 && pm.mipCount()>=mipCnt);
+  const uint32_t smip  = (baked ? mipCnt : 1);
 #ifdef __IOS__
   const MTL::StorageMode smode = MTL::StorageModeShared;
 #else
@@ -49,12 +50,12 @@ MtTexture::MtTexture(MtDevice& dev, const Pixmap& pm, uint32_t mipCnt, TextureFo
 
   if(isCompressedFormat(frm))
     createCompressedTexture(*stage,pm,frm,mipCnt); else
-    createRegularTexture(*stage,pm);
+    createRegularTexture(*stage,pm,smip);
 
   auto pool = NsPtr<NS::AutoreleasePool>::init();
   auto cmd  = dev.queue->commandBuffer();
   auto enc  = cmd->blitCommandEncoder();
-  if(isCompressedFormat(frm)) {
+  if(baked) {
     enc->copyFromTexture(stage.get(),0,0, impl.get(),0,0, 1,mipCnt);
     } else {
     enc->copyFromTexture(stage.get(),0,0, impl.get(),0,0, 1,1);
@@ -88,8 +89,17 @@ void MtTexture::createCompressedTexture(MTL::Texture& val, const Pixmap& p, Text
     }
   }
 
-void MtTexture::createRegularTexture(MTL::Texture& val, const Pixmap& p) {
-  val.replaceRegion(MTL::Region(0,0,p.w(),p.h()), 0, p.data(), p.w()*Pixmap::bppForFormat(p.format()));
+void MtTexture::createRegularTexture(MTL::Texture& val, const Pixmap& p, uint32_t mipCnt) {
+  const size_t   bpp   = Pixmap::bppForFormat(p.format());
+  const uint8_t* pdata = reinterpret_cast<const uint8_t*>(p.data());
+
+  uint32_t w = p.w(), h = p.h();
+  for(uint32_t i=0; i<mipCnt; i++) {
+    val.replaceRegion(MTL::Region(0,0,w,h), i, pdata, w*bpp);
+    pdata += size_t(w)*size_t(h)*bpp;
+    w = std::max<uint32_t>(1,w/2);
+    h = std::max<uint32_t>(1,h/2);
+    }
   }
 
 NsPtr<MTL::Texture> MtTexture::alloc(TextureFormat frm,
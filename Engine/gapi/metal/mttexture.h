@@ -31,7 +31,7 @@ class MtTexture : public Tempest::AbstractGraphicsApi::Texture {
 
   private:
     void createCompressedTexture(MTL::Texture& val, const Pixmap& p, TextureFormat frm, uint32_t mipCnt);
-    void createRegularTexture(MTL::Texture& val, const Pixmap& p);
+    void createRegularTexture(MTL::Texture& val, const Pixmap& p, uint32_t mipCnt);
 
     NsPtr<MTL::Texture>  alloc(TextureFormat frm, const uint32_t w, const uint32_t h, const uint32_t d,
                                const uint32_t mips,
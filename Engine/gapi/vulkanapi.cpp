@@ -160,6 +160,19 @@ AbstractGraphicsApi::PTexture VulkanApi::createTexture(AbstractGraphicsApi::Devi
       }
 
     cmd->barrier(*pbuf.handler, ResourceAccess::TransferDst, ResourceAccess::Sampler, uint32_t(-1));
+    } else if(mipCnt>1 && p.mipCount()>=mipCnt) {
+    // full mip-chain in one staging buffer
+    cmd->barrier(*pbuf.handler, ResourceAccess::None, ResourceAccess::TransferDst, uint32_t(-1));
+    size_t   bpp        = Pixmap::bppForFormat(frm);
+    size_t   bufferSize = 0;
+    uint32_t w = p.w(), h = p.h();
+    for(uint32_t i=0; i<mipCnt; i++){
+      cmd->copy(*pbuf.handler,w,h,i,*pstage.handler,bufferSize);
+      bufferSize += size_t(w)*size_t(h)*bpp;
+      w = std::max<uint32_t>(1,w/2);
+      h = std::max<uint32_t>(1,h/2);
+      }
+    cmd->barrier(*pbuf.handler, ResourceAccess::TransferDst, ResourceAccess::Sampler, uint32_t(-1));
     } else {
     cmd->barrier(*pbuf.handler, ResourceAccess::None, ResourceAccess::TransferDst, uint32_t(-1));
     cmd->copy(*pbuf.handler,p.w(),p.h(),0,*pstage.handler,0);
@@ -7,35 +7,56 @@
 
 using namespace Tempest;
 
+// states of 2d pipelines: opaque, alpha blended, additive
+static void mkStates(RenderState& stNormal, RenderState& stBlend, RenderState& stAlpha) {
+  stNormal.setZWriteEnabled(false);
+
+  stBlend.setBlendSource  (RenderState::BlendMode::SrcAlpha);
+  stBlend.setBlendDest    (RenderState::BlendMode::OneMinusSrcAlpha);
+  stBlend.setZWriteEnabled(false);
+
+  stAlpha.setBlendSource  (RenderState::BlendMode::One);
+  stAlpha.setBlendDest    (RenderState::BlendMode::One);
+  stAlpha.setZWriteEnabled(false);
+  }
+
 Builtin::Builtin(Device& device)
   : device(device) {
   static bool internalShaders = true;
   if(internalShaders) {
     brushE  = mkShaderSet(false);
     brushT2 = mkShaderSet(true);
+
+    auto vs  = device.shader(tex_brush_vert_sprv,sizeof(tex_brush_vert_sprv));
+    auto qvs = device.shader(tex_quad_vert_sprv, sizeof(tex_quad_vert_sprv));
+    auto fs  = device.shader(sdf_brush_frag_sprv,sizeof(sdf_brush_frag_sprv));
+    brushSdf = mkShaderSet(vs,qvs,fs);
+
+    auto pvs = device.shader(tex_pages_vert_sprv,sizeof(tex_pages_vert_sprv));
+    auto pfs = device.shader(tex_pages_frag_sprv,sizeof(tex_pages_frag_sprv));
+    auto sfs = device.shader(sdf_pages_frag_sprv,sizeof(sdf_pages_frag_sprv));
+    mkPageSet(brushT2, pvs,pfs);
+    mkPageSet(brushSdf,pvs,sfs);
     }
   }
 
 Builtin::Item Builtin::mkShaderSet(bool textures) {
-  Tempest::Shader vs, fs;
+  Tempest::Shader vs, qvs, fs;
   if(textures) {
-    vs = device.shader(tex_brush_vert_sprv,sizeof(tex_brush_vert_sprv));
-    fs = device.shader(tex_brush_frag_sprv,sizeof(tex_brush_frag_sprv));
+    vs  = device.shader(tex_brush_vert_sprv, sizeof(tex_brush_vert_sprv));
+    qvs = device.shader(tex_quad_vert_sprv,  sizeof(tex_quad_vert_sprv));
+    fs  = device.shader(tex_brush_frag_sprv, sizeof(tex_brush_frag_sprv));
     } else {
-    vs = device.shader(empty_vert_sprv,    sizeof(empty_vert_sprv));
-    fs = device.shader(empty_frag_sprv,    sizeof(empty_frag_sprv));
+    vs  = device.shader(empty_vert_sprv,     sizeof(empty_vert_sprv));
+    qvs = device.shader(empty_quad_vert_sprv,sizeof(empty_quad_vert_sprv));
+    fs  = device.shader(empty_frag_sprv,     sizeof(empty_frag_sprv));
     }
+  return mkShaderSet(vs,qvs,fs);
+  }
 
+Builtin::Item Builtin::mkShaderSet(const Shader& vs, const Shader& qvs, const Shader& fs) {
   RenderState stNormal, stBlend, stAlpha;
-  stNormal.setZWriteEnabled(false);
-
-  stBlend.setBlendSource  (RenderState::BlendMode::SrcAlpha);
-  stBlend.setBlendDest    (RenderState::BlendMode::OneMinusSrcAlpha);
-  stBlend.setZWriteEnabled(false);
-
-  stAlpha.setBlendSource  (RenderState::BlendMode::One);
-  stAlpha.setBlendDest    (RenderState::BlendMode::One);
-  stAlpha.setZWriteEnabled(false);
+  mkStates(stNormal,stBlend,stAlpha);
 
   Item ret;
   ret.pen    = device.pipeline(Lines,    stNormal,vs,fs);
@@ -46,5 +67,18 @@ Builtin::Item Builtin::mkShaderSet(bool textures) {
 
   ret.penA   = device.pipeline(Lines,    stAlpha,vs,fs);
   ret.brushA = device.pipeline(Triangles,stAlpha,vs,fs);
+
+  ret.quad   = device.pipeline(Triangles,stNormal,qvs,fs);
+  ret.quadB  = device.pipeline(Triangles,stBlend, qvs,fs);
+  ret.quadA  = device.pipeline(Triangles,stAlpha, qvs,fs);
   return ret;
   }
+
+void Builtin::mkPageSet(Item& it, const Shader& vs, const Shader& fs) {
+  RenderState stNormal, stBlend, stAlpha;
+  mkStates(stNormal,stBlend,stAlpha);
+
+  it.pages  = device.pipeline(Triangles,stNormal,vs,fs);
+  it.pagesB = device.pipeline(Triangles,stBlend, vs,fs);
+  it.pagesA = device.pipeline(Triangles,stAlpha, vs,fs);
+  }
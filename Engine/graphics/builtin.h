@@ -24,17 +24,31 @@ class Builtin final {
 
       Tempest::RenderPipeline penA;
       Tempest::RenderPipeline brushA;
+
+      // instanced PaintDevice::Quad, 6 vertices per instance
+      Tempest::RenderPipeline quad;
+      Tempest::RenderPipeline quadB;
+      Tempest::RenderPipeline quadA;
+
+      // instanced quads from several atlas pages; textured sets only
+      Tempest::RenderPipeline pages;
+      Tempest::RenderPipeline pagesB;
+      Tempest::RenderPipeline pagesA;
       };
 
     const Item& texture2d() const { return brushT2; }
     const Item& empty    () const { return brushE;  }
+    const Item& distanceField() const { return brushSdf; }
 
   private:
     Item            mkShaderSet(bool textures);
+    Item            mkShaderSet(const Shader& vs, const Shader& qvs, const Shader& fs);
+    void            mkPageSet  (Item& it, const Shader& vs, const Shader& fs);
 
     Device&         device;
     Item            brushT2;
     Item            brushE;
+    Item            brushSdf;
 
   friend class Device;
   };
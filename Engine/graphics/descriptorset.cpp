@@ -77,11 +77,11 @@ void DescriptorSet::set(size_t layoutBind, const std::vector<const StorageBuffer
   set(layoutBind,buf.data(),buf.size());
   }
 
-void DescriptorSet::set(size_t layoutBind, const Texture2d* const * tex, size_t count) {
+void DescriptorSet::set(size_t layoutBind, const Texture2d* const * tex, size_t count, const Sampler& smp) {
   Detail::SmallArray<AbstractGraphicsApi::Texture*,32> arr(count);
   for(size_t i=0; i<count; ++i)
     arr[i] = tex[i]->impl.handler;
-  impl.handler->set(layoutBind,arr.get(),count,Sampler::nearest(),uint32_t(-1));
+  impl.handler->set(layoutBind,arr.get(),count,smp,uint32_t(-1));
   }
 
 void DescriptorSet::set(size_t layoutBind, const StorageBuffer* const* buf, size_t count) {
@@ -46,7 +46,7 @@ class DescriptorSet final {
     void set(size_t layoutBind, const std::vector<const Texture2d*>&     tex);
     void set(size_t layoutBind, const std::vector<const StorageBuffer*>& buf);
 
-    void set(size_t layoutBind, const Texture2d*   const *   tex, size_t count);
+    void set(size_t layoutBind, const Texture2d*   const *   tex, size_t count, const Sampler& smp = Sampler::nearest());
     void set(size_t layoutBind, const StorageBuffer* const * buf, size_t count);
 
     void set(size_t layoutBind, const AccelerationStructure& tlas);
@@ -144,6 +144,11 @@ Texture2d Device::texture(const Pixmap &pm, const bool mips) {
   if(pm.w()>devProps.tex2d.maxSize || pm.h()>devProps.tex2d.maxSize)
     throw std::system_error(Tempest::GraphicsErrc::TooLargeTexture, std::to_string(std::max(pm.w(),pm.h())));
 
+  if(mips && pm.mipCount()>1) {
+    // mip-chain is baked on cpu side
+    mipCnt = pm.mipCount();
+    }
+
   if(isCompressedFormat(format)){
     if(devProps.hasSamplerFormat(format) && (!mips || pm.mipCount()>1)){
       mipCnt = pm.mipCount();
@@ -2,17 +2,26 @@
 
 #include <Tempest/Sprite>
 #include <Tempest/Log>
+#include <Tempest/TextLayout>
 #include <cstring>
 
 #include "thirdparty/squish/squish.h"
 
 using namespace Tempest;
 
-TextureAtlas::TextureAtlas(Device& device)
-  :device(device),alloc(provider) {
+static std::atomic<uint64_t> atlasUid{0};
+
+TextureAtlas::TextureAtlas()
+  :alloc(provider),uid(++atlasUid) {
+  }
+
+TextureAtlas::TextureAtlas(Device&)
+  :TextureAtlas() {
   }
 
 TextureAtlas::~TextureAtlas() {
+  // cached layouts own sprites of this atlas
+  TextLayout::clearCache(*this);
   }
 
 Sprite TextureAtlas::load(const Pixmap &pm) {
@@ -20,6 +29,7 @@ Sprite TextureAtlas::load(const Pixmap &pm) {
   }
 
 Sprite TextureAtlas::load(const void *data, uint32_t w, uint32_t h, TextureFormat format) {
+  std::lock_guard<std::mutex> guard(sync);
   auto a = alloc.alloc(w,h);
   auto p = a.pos();
   emplace(a,data,w,h,format,uint32_t(p.x),uint32_t(p.y));
@@ -27,6 +37,21 @@ Sprite TextureAtlas::load(const void *data, uint32_t w, uint32_t h, TextureForma
   return ret;
   }
 
+void TextureAtlas::load(const Image* img, size_t count, Sprite* out) {
+  std::lock_guard<std::mutex> guard(sync);
+  for(size_t i=0; i<count; ++i) {
+    auto& im = img[i];
+    auto  a  = alloc.alloc(im.w,im.h);
+    if(a.owner==nullptr) {
+      out[i] = Sprite();
+      continue;
+      }
+    auto  p  = a.pos();
+    emplace(a,im.data,im.w,im.h,im.format,uint32_t(p.x),uint32_t(p.y));
+    out[i] = Sprite(std::move(a),im.w,im.h);
+    }
+  }
+
 void TextureAtlas::emplace(TextureAtlas::Allocation &dest, const void* img,
                            uint32_t pw, uint32_t ph, TextureFormat format,
                            uint32_t x, uint32_t y) {
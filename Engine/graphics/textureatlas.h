@@ -16,12 +16,23 @@ class Sprite;
 
 class TextureAtlas {
   public:
+    // pages are uploaded by Sprite::pageRawData on draw: atlas itself doesn't touch the device
+    TextureAtlas();
     TextureAtlas(Device& device);
     TextureAtlas(const TextureAtlas&)=delete;
     virtual ~TextureAtlas();
 
+    struct Image final {
+      const void*   data   = nullptr;
+      uint32_t      w      = 0;
+      uint32_t      h      = 0;
+      TextureFormat format = TextureFormat::Undefined;
+      };
+
     Sprite load(const Pixmap& pm);
     Sprite load(const void* data, uint32_t w, uint32_t h, TextureFormat format);
+    // places all images in one pass; touched pages are uploaded once, on first draw
+    void   load(const Image* img, size_t count, Sprite* out);
 
   private:
     struct Memory {
@@ -56,11 +67,14 @@ class TextureAtlas {
                  uint32_t w, uint32_t h, TextureFormat frm,
                  uint32_t x, uint32_t y);
 
-    Device&                                 device;
     MemoryProvider                          provider;
     Tempest::RectAllocator<MemoryProvider> alloc;
+    std::mutex                              sync;
+    // unique for process lifetime, unlike address of atlas; see TextLayout::get
+    const uint64_t                          uid;
 
   friend class Sprite;
+  friend class TextLayout;
   };
 
 }
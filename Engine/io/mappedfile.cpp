@@ -0,0 +1,141 @@
+#include "mappedfile.h"
+
+#include <Tempest/TextCodec>
+#include <Tempest/Except>
+
+#ifdef __WINDOWS__
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+using namespace Tempest;
+
+MappedFile::MappedFile(const char *name) {
+#ifdef __WINDOWS__
+  std::wstring path;
+  const int len=MultiByteToWideChar(CP_UTF8,0,name,-1,nullptr,0);
+  if(len>1){
+    path.resize(size_t(len-1));
+    MultiByteToWideChar(CP_UTF8,0,name,-1,&path[0],int(path.size()));
+    }
+  implOpen(path.c_str());
+#else
+  implOpen(name);
+#endif
+  }
+
+MappedFile::MappedFile(const std::string &path)
+  :MappedFile(path.c_str()){
+  }
+
+MappedFile::MappedFile(const char16_t *path) {
+#ifdef __WINDOWS__
+  implOpen(reinterpret_cast<const wchar_t*>(path));
+#else
+  implOpen(TextCodec::toUtf8(path).c_str());
+#endif
+  }
+
+MappedFile::MappedFile(const std::u16string &path)
+  :MappedFile(path.c_str()){
+  }
+
+MappedFile::MappedFile(MappedFile &&other)
+  :ptr(other.ptr), sz(other.sz) {
+#ifdef __WINDOWS__
+  mapping       = other.mapping;
+  other.mapping = nullptr;
+#endif
+  other.ptr = nullptr;
+  other.sz  = 0;
+  }
+
+MappedFile::~MappedFile() {
+  implClose();
+  }
+
+MappedFile &MappedFile::operator =(MappedFile &&other) {
+  std::swap(ptr,other.ptr);
+  std::swap(sz, other.sz);
+#ifdef __WINDOWS__
+  std::swap(mapping,other.mapping);
+#endif
+  return *this;
+  }
+
+#ifdef __WINDOWS__
+void MappedFile::implOpen(const wchar_t *wstr) {
+  HANDLE f = CreateFileW(wstr,GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr);
+  if(f==HANDLE(LONG_PTR(-1)))
+    throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+
+  LARGE_INTEGER fsize = {};
+  if(!GetFileSizeEx(f,&fsize)) {
+    CloseHandle(f);
+    throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+    }
+  if(fsize.QuadPart==0) {
+    // zero-sized mappings are not allowed
+    CloseHandle(f);
+    return;
+    }
+
+  HANDLE m = CreateFileMappingW(f,nullptr,PAGE_READONLY,0,0,nullptr);
+  CloseHandle(f);
+  if(m==nullptr)
+    throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+
+  void* view = MapViewOfFile(m,FILE_MAP_READ,0,0,0);
+  if(view==nullptr) {
+    CloseHandle(m);
+    throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+    }
+
+  mapping = m;
+  ptr     = reinterpret_cast<const uint8_t*>(view);
+  sz      = size_t(fsize.QuadPart);
+  }
+
+void MappedFile::implClose() {
+  if(ptr!=nullptr)
+    UnmapViewOfFile(ptr);
+  if(mapping!=nullptr)
+    CloseHandle(HANDLE(mapping));
+  }
+#else
+void MappedFile::implOpen(const char *cstr) {
+  int fd = ::open(cstr,O_RDONLY);
+  if(fd<0)
+    throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+
+  struct stat st = {};
+  if(::fstat(fd,&st)!=0) {
+    ::close(fd);
+    throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+    }
+  if(st.st_size==0) {
+    ::close(fd);
+    return;
+    }
+
+  void* view = ::mmap(nullptr,size_t(st.st_size),PROT_READ,MAP_PRIVATE,fd,0);
+  // mapping keeps own reference to the file
+  ::close(fd);
+  if(view==MAP_FAILED)
+    throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+
+  ptr = reinterpret_cast<const uint8_t*>(view);
+  sz  = size_t(st.st_size);
+  }
+
+void MappedFile::implClose() {
+  if(ptr!=nullptr)
+    ::munmap(const_cast<uint8_t*>(ptr),sz);
+  }
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Tempest/Platform>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Tempest {
+
+class MappedFile {
+  public:
+    MappedFile()=default;
+    explicit MappedFile(const char*     path);
+    explicit MappedFile(const std::string& path);
+    explicit MappedFile(const char16_t* path);
+    explicit MappedFile(const std::u16string& path);
+    MappedFile(MappedFile&& other);
+    ~MappedFile();
+
+    MappedFile& operator = (MappedFile&& other);
+
+    const uint8_t* data() const { return ptr; }
+    size_t         size() const { return sz;  }
+    bool           isEmpty() const { return sz==0; }
+
+  private:
+    const uint8_t* ptr = nullptr;
+    size_t         sz  = 0;
+#ifdef __WINDOWS__
+    void*          mapping = nullptr;
+    void           implOpen(const wchar_t* wstr);
+#else
+    void           implOpen(const char* cstr);
+#endif
+    void           implClose();
+  };
+
+}
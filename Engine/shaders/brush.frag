@@ -1,9 +1,32 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-#if defined(TEXTURE)
+#if defined(PAGES)
+// VectorImage::MaxPages atlas pages of one batch
+layout(binding  = 0) uniform sampler2D texSampler[8];
+layout(location = 1) in      vec2      inUV;
+layout(location = 2) flat in uint      inPage;
+
+vec4 texel(vec2 uv) {
+  // constant indices only: no need for non-uniform descriptor indexing
+  switch(inPage) {
+    case 0u: return textureLod(texSampler[0],uv,0.0);
+    case 1u: return textureLod(texSampler[1],uv,0.0);
+    case 2u: return textureLod(texSampler[2],uv,0.0);
+    case 3u: return textureLod(texSampler[3],uv,0.0);
+    case 4u: return textureLod(texSampler[4],uv,0.0);
+    case 5u: return textureLod(texSampler[5],uv,0.0);
+    case 6u: return textureLod(texSampler[6],uv,0.0);
+    }
+  return textureLod(texSampler[7],uv,0.0);
+  }
+#elif defined(TEXTURE)
 layout(binding  = 0) uniform sampler2D texSampler;
 layout(location = 1) in      vec2      inUV;
+
+vec4 texel(vec2 uv) {
+  return texture(texSampler,uv);
+  }
 #endif
 
 #if defined(EXT)
@@ -12,12 +35,44 @@ layout(push_constant, std140) uniform UboPush {
   } push;
 #endif
 
+#if defined(SDF)
+layout(push_constant, std140) uniform UboPush {
+  vec4  outlineColor;
+  vec4  glowColor;
+  // in distance units, outward from the glyph edge: glow starts where outline ends
+  float outline;
+  float glow;
+  } push;
+
+// both colors are not premultiplied
+vec4 over(vec4 top, vec4 bottom) {
+  float a = top.a + bottom.a*(1.0-top.a);
+  vec3  c = top.rgb*top.a + bottom.rgb*bottom.a*(1.0-top.a);
+  return vec4(c/max(a,1e-4), a);
+  }
+#endif
+
 layout(location = 0) out vec4 outColor;
 layout(location = 0) in  vec4 inColor;
 
 void main() {
-#if defined(TEXTURE)
-  outColor = inColor*texture(texSampler,inUV);
+#if defined(TEXTURE) && defined(SDF)
+  // glyph distance field: 0.5 at the outline, antialiased over one screen pixel
+  float dist  = texel(inUV).a;
+  float width = max(fwidth(dist)*0.5, 1e-4);
+  float edge  = 0.5-push.outline;
+  vec4  color = vec4(inColor.rgb, inColor.a*smoothstep(0.5-width, 0.5+width, dist));
+  if(push.outline>0.0) {
+    float a = smoothstep(edge-width, edge+width, dist);
+    color = over(color, vec4(push.outlineColor.rgb, push.outlineColor.a*a));
+    }
+  if(push.glow>0.0) {
+    float a = smoothstep(edge-push.glow, edge, dist);
+    color = over(color, vec4(push.glowColor.rgb, push.glowColor.a*a*a));
+    }
+  outColor = color;
+#elif defined(TEXTURE)
+  outColor = inColor*texel(inUV);
 #else
   outColor = inColor;
 #endif
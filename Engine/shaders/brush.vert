@@ -5,15 +5,53 @@ out gl_PerVertex {
   vec4 gl_Position;
   };
 
+#if defined(QUAD)
+// PaintDevice::Quad
+struct Quad {
+  vec4 rect;
+  uint uv0;
+  uint uv1;
+  uint color;
+  uint page;
+  };
+
+#if defined(TEXTURE)
+layout(binding = 1, std430) readonly buffer Quads { Quad quad[]; };
+#else
+layout(binding = 0, std430) readonly buffer Quads { Quad quad[]; };
+#endif
+#else
 layout(location = 0) in vec3 inPos;
 layout(location = 1) in vec2 inUV;
 layout(location = 2) in vec4 inColor;
+#endif
 
 layout(location = 0) out vec4 outColor;
 #if defined(TEXTURE)
 layout(location = 1) out vec2 outUV;
 #endif
+#if defined(PAGES)
+layout(location = 2) flat out uint outPage;
+#endif
 
+#if defined(QUAD)
+void main() {
+  // same triangles as Painter emits for a rect: {0,1,2}, {0,2,3}
+  const int  corner[6] = int[](0,1,2,0,2,3);
+  int        c  = corner[gl_VertexIndex];
+  bvec2      hi = bvec2(c==1 || c==2, c>=2);
+  Quad       q  = quad[gl_InstanceIndex];
+
+  gl_Position = vec4(mix(q.rect.xy,q.rect.zw,hi), 0.0, 1.0);
+  outColor    = unpackUnorm4x8(q.color);
+#if defined(TEXTURE)
+  outUV       = mix(unpackUnorm2x16(q.uv0),unpackUnorm2x16(q.uv1),hi);
+#endif
+#if defined(PAGES)
+  outPage     = q.page;
+#endif
+  }
+#else
 void main() {
   gl_Position = vec4(inPos, 1.0);
   outColor    = inColor;
@@ -21,3 +59,4 @@ void main() {
   outUV       = inUV;
 #endif
   }
+#endif
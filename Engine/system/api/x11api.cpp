@@ -20,6 +20,7 @@
 #include <X11/Xos.h>
 #include <X11/keysymdef.h>
 #include <X11/Xutil.h>
+#include <poll.h>
 #undef CursorShape
 
 struct HWND final {
@@ -53,7 +54,10 @@ static int              activeCursorChange = 0;
 static XIM              xim = 0;
 
 static std::unordered_map<SystemApi::Window*,Tempest::Window*> windows;
+static std::unordered_map<SystemApi::Window*,XIC>              inputContexts;
 static std::unordered_set<SystemApi::Window*> fullscreenWindows;
+// text of pressed keys, by keycode: release is not passed to input method
+static uint32_t         keyText[256] = {};
 
 static Atom& WM_DELETE_WINDOW(){
   static Atom w  = XInternAtom( dpy, "WM_DELETE_WINDOW", 0);
@@ -238,13 +242,16 @@ SystemApi::Window *X11Api::implCreateWindow(Tempest::Window *owner, uint32_t w,
   XSync(dpy,False);
 
   // X input context, you can have multiple for text boxes etc, but having a
-  // single one is the easiest.
+  // single one per window is the easiest.
   XIC xic = XCreateIC(xim,
                       XNInputStyle,   XIMPreeditNothing | XIMStatusNothing,
                       XNClientWindow, win,
                       XNFocusWindow,  win,
                       NULL);
-  XSetICFocus(xic);
+  if(xic!=nullptr) {
+    XSetICFocus(xic);
+    inputContexts[ret] = xic;
+    }
 
   if(owner!=nullptr) {
     alignGeometry(win.ptr(),*owner);
@@ -289,6 +296,11 @@ SystemApi::Window *X11Api::implCreateWindow(Tempest::Window *owner, SystemApi::S
 void X11Api::implDestroyWindow(SystemApi::Window *w) {
   windows.erase(w); //NOTE: X11 can send events to dead window
   fullscreenWindows.erase(w);
+  auto xic = inputContexts.find(w);
+  if(xic!=inputContexts.end()) {
+    XDestroyIC(xic->second);
+    inputContexts.erase(xic);
+    }
   XDestroyWindow(dpy, HWND(w));
   }
 
@@ -403,147 +415,206 @@ int X11Api::implExec(SystemApi::AppCallBack &cb) {
   }
 
 void X11Api::implProcessEvents(SystemApi::AppCallBack &cb) {
+  if(cb.isEventDriven()) {
+    implWaitEvents(cb);
+    return;
+    }
+
   // main message loop
   if(XPending(dpy)>0) {
     XEvent xev={};
     XNextEvent(dpy, &xev);
+    implDispatch(xev);
+    std::this_thread::yield();
+    } else {
+    if(cb.onTimer()==0)
+      std::this_thread::yield();
+    for(auto& i:windows) {
+      if(i.second==nullptr)
+        continue;
+      SystemApi::dispatchRender(*i.second);
+      }
+    }
+  }
 
-    HWND hWnd = xev.xclient.window;
-    auto it = windows.find(hWnd.ptr());
-    if(it==windows.end() || it->second==nullptr)
-      return;
-    Tempest::Window& cb = *it->second; //TODO: validation
-    switch( xev.type ) {
-      case ClientMessage: {
-        if(xev.xclient.data.l[0] == long(WM_DELETE_WINDOW())){
-          SystemApi::exit();
-          }
-        break;
+void X11Api::implWaitEvents(SystemApi::AppCallBack& cb) {
+  bool render = false;
+  for(auto& i:windows)
+    if(i.second!=nullptr && SystemApi::isRenderPending(*i.second)) {
+      render = true;
+      break;
+      }
+
+  if(!render && XPending(dpy)==0) {
+    // sleep until input or next timer
+    pollfd fd = {};
+    fd.fd     = ConnectionNumber(dpy);
+    fd.events = POLLIN;
+    poll(&fd, 1, int(cb.waitTime()));
+    }
+
+  // whole queue at once, so a burst of input costs one frame
+  while(XPending(dpy)>0) {
+    XEvent xev={};
+    XNextEvent(dpy, &xev);
+    implDispatch(xev);
+    }
+
+  cb.onTimer();
+  for(auto& i:windows) {
+    if(i.second==nullptr || !SystemApi::isRenderPending(*i.second))
+      continue;
+    SystemApi::dispatchRender(*i.second);
+    }
+  }
+
+void X11Api::implDispatch(XEvent& xev) {
+  // input method may take key events for composition of text
+  if(XFilterEvent(&xev, None))
+    return;
+
+  HWND hWnd = xev.xclient.window;
+  auto it = windows.find(hWnd.ptr());
+  if(it==windows.end() || it->second==nullptr)
+    return;
+  Tempest::Window& cb = *it->second; //TODO: validation
+  switch( xev.type ) {
+    case ClientMessage: {
+      if(xev.xclient.data.l[0] == long(WM_DELETE_WINDOW())){
+        SystemApi::exit();
         }
-      case ConfigureNotify: {
-        cb.setPosition(xev.xconfigure.x, xev.xconfigure.y);
-        if(xev.xconfigure.width !=cb.w() || xev.xconfigure.height!=cb.h()) {
-          Tempest::SizeEvent e(xev.xconfigure.width, xev.xconfigure.height);
-          SystemApi::dispatchResize(cb,e);
-          }
-        break;
+      break;
+      }
+    case ConfigureNotify: {
+      cb.setPosition(xev.xconfigure.x, xev.xconfigure.y);
+      if(xev.xconfigure.width !=cb.w() || xev.xconfigure.height!=cb.h()) {
+        Tempest::SizeEvent e(xev.xconfigure.width, xev.xconfigure.height);
+        SystemApi::dispatchResize(cb,e);
         }
-      case PropertyNotify:{
-        if(nativeIsFullscreen(hWnd)) {
-          fullscreenWindows.insert(hWnd.ptr());
-          } else {
-          fullscreenWindows.erase(hWnd.ptr());
-          }
-        break;
+      break;
+      }
+    case PropertyNotify:{
+      if(nativeIsFullscreen(hWnd)) {
+        fullscreenWindows.insert(hWnd.ptr());
+        } else {
+        fullscreenWindows.erase(hWnd.ptr());
         }
-      case MappingNotify:
-        XRefreshKeyboardMapping(&xev.xmapping);
-        break;
-      case ButtonPress:
-      case ButtonRelease: {
-        if(xev.xbutton.button==Button4 || xev.xbutton.button==Button5) {
-          int ticks = 0;
-          if( xev.xbutton.button == Button4 ) {
-            ticks = 120;
-            }
-          else if ( xev.xbutton.button == Button5 ) {
-            ticks = -120;
-            }
-          if(xev.type==ButtonPress) {
-            Tempest::MouseEvent e( xev.xbutton.x,
-                                   xev.xbutton.y,
-                                   Tempest::Event::ButtonNone,
-                                   Event::M_NoModifier,
-                                   ticks,
-                                   0,
-                                   Event::MouseWheel );
-            SystemApi::dispatchMouseWheel(cb, e);
-            }
-          } else {
-          MouseEvent e( xev.xbutton.x,
-                        xev.xbutton.y,
-                        toButton( xev.xbutton ),
-                        Event::M_NoModifier,
-                        0,
-                        0,
-                        xev.type==ButtonPress ? Event::MouseDown : Event::MouseUp );
-          if(xev.type==ButtonPress)
-            SystemApi::dispatchMouseDown(cb, e); else
-            SystemApi::dispatchMouseUp(cb, e);
+      break;
+      }
+    case MappingNotify:
+      XRefreshKeyboardMapping(&xev.xmapping);
+      break;
+    case ButtonPress:
+    case ButtonRelease: {
+      if(xev.xbutton.button==Button4 || xev.xbutton.button==Button5) {
+        int ticks = 0;
+        if( xev.xbutton.button == Button4 ) {
+          ticks = 120;
           }
-        break;
-        }
-      case MotionNotify: {
-        if(activeCursorChange == 1) {
-          // FIXME: mouse behave crazy in OpenGothic
-          activeCursorChange = 0;
-          break;
-        }
-        MouseEvent e( xev.xmotion.x,
-                      xev.xmotion.y,
-                      Event::ButtonNone,
+        else if ( xev.xbutton.button == Button5 ) {
+          ticks = -120;
+          }
+        if(xev.type==ButtonPress) {
+          Tempest::MouseEvent e( xev.xbutton.x,
+                                 xev.xbutton.y,
+                                 Tempest::Event::ButtonNone,
+                                 Event::M_NoModifier,
+                                 ticks,
+                                 0,
+                                 Event::MouseWheel );
+          SystemApi::dispatchMouseWheel(cb, e);
+          }
+        } else {
+        MouseEvent e( xev.xbutton.x,
+                      xev.xbutton.y,
+                      toButton( xev.xbutton ),
                       Event::M_NoModifier,
                       0,
                       0,
-                      Event::MouseMove  );
-        SystemApi::dispatchMouseMove(cb, e);
+                      xev.type==ButtonPress ? Event::MouseDown : Event::MouseUp );
+        if(xev.type==ButtonPress)
+          SystemApi::dispatchMouseDown(cb, e); else
+          SystemApi::dispatchMouseUp(cb, e);
+        }
+      break;
+      }
+    case MotionNotify: {
+      if(activeCursorChange == 1) {
+        // FIXME: mouse behave crazy in OpenGothic
+        activeCursorChange = 0;
         break;
+      }
+      // high-rate mice queue many moves per frame: only the last of a consecutive run matters
+      XEvent next = {};
+      while(XEventsQueued(dpy, QueuedAlready)>0) {
+        XPeekEvent(dpy, &next);
+        if(next.type!=MotionNotify || next.xmotion.window!=xev.xmotion.window || next.xmotion.state!=xev.xmotion.state)
+          break;
+        XNextEvent(dpy, &xev);
         }
-      case KeyPress:
-      case KeyRelease: {
-        KeySym ksym = XLookupKeysym(&xev.xkey,0);
-
-        // NOTE: it's not optimal to recreate xic on every button, but it's good engough
-        XIC xic = XCreateIC(xim,
-                            XNInputStyle,   XIMPreeditNothing | XIMStatusNothing,
-                            XNClientWindow, xev.xclient.window,
-                            XNFocusWindow,  xev.xclient.window,
-                            nullptr);
-        char txt[64]={};
-        if(xic!=nullptr) {
-          XEvent xev2 = xev;
-          xev2.type = KeyPress; // HACK: Their behavior when a client passes a KeyRelease event is undefined.
-          Status status = {};
-          Xutf8LookupString(xic, &xev2.xkey, txt, sizeof(txt)-1, &ksym, &status);
-          if(status == XBufferOverflow) {
-            txt[0] = '\0';
-            }
-          // XLookupString(&xev.xkey, txt, sizeof(txt)-1, ksym, nullptr );
-          XDestroyIC(xic);
+      MouseEvent e( xev.xmotion.x,
+                    xev.xmotion.y,
+                    Event::ButtonNone,
+                    Event::M_NoModifier,
+                    0,
+                    0,
+                    Event::MouseMove  );
+      SystemApi::dispatchMouseMove(cb, e);
+      break;
+      }
+    case KeyPress:
+    case KeyRelease: {
+      KeySym   ksym = XLookupKeysym(&xev.xkey,0);
+      uint32_t scan = xev.xkey.keycode;
+      uint32_t code = 0;
+
+      auto xic = inputContexts.find(hWnd.ptr());
+      if(xev.type==KeyPress && xic!=inputContexts.end()) {
+        char   txt[64] = {};
+        Status status  = {};
+        Xutf8LookupString(xic->second, &xev.xkey, txt, sizeof(txt)-1, &ksym, &status);
+        if(status==XLookupChars || status==XLookupBoth) {
+          char16_t u16[4] = {};
+          TextCodec::toUtf16(txt,u16,4);
+          code = u16[0];
           }
-
-        auto u16 = TextCodec::toUtf16(txt); // TODO: remove dynamic allocation
-        auto key = SystemApi::translateKey(ksym);
-
-        uint32_t scan = xev.xkey.keycode;
-        // printf("%s\n",txt);
-
-        Tempest::KeyEvent e(Event::KeyType(key),uint32_t(u16.size()>0 ? u16[0] : 0),Event::M_NoModifier,(xev.type==KeyPress) ? Event::KeyDown : Event::KeyUp);
-        if(xev.type==KeyPress)
-          SystemApi::dispatchKeyDown(cb,e,scan); else
-          SystemApi::dispatchKeyUp  (cb,e,scan);
-        break;
         }
-      case FocusIn: {
-        FocusEvent e(true, Event::UnknownReason);
-        SystemApi::dispatchFocus(cb, e);
-        break;
+      else if(xev.type==KeyRelease) {
+        XLookupString(&xev.xkey, nullptr, 0, &ksym, nullptr);
         }
-      case FocusOut: {
-        FocusEvent e(false, Event::UnknownReason);
-        SystemApi::dispatchFocus(cb, e);
-        break;
+      // Xutf8LookupString is undefined for KeyRelease: repeat text of press
+      if(scan<256) {
+        if(xev.type==KeyPress)
+          keyText[scan] = code; else
+          code = keyText[scan];
         }
-      }
 
-    std::this_thread::yield();
-    } else {
-    if(cb.onTimer()==0)
-      std::this_thread::yield();
-    for(auto& i:windows) {
-      if(i.second==nullptr)
-        continue;
-      SystemApi::dispatchRender(*i.second);
+      auto key = SystemApi::translateKey(ksym);
+      Tempest::KeyEvent e(Event::KeyType(key),code,Event::M_NoModifier,(xev.type==KeyPress) ? Event::KeyDown : Event::KeyUp);
+      if(xev.type==KeyPress)
+        SystemApi::dispatchKeyDown(cb,e,scan); else
+        SystemApi::dispatchKeyUp  (cb,e,scan);
+      break;
+      }
+    case FocusIn: {
+      auto xic = inputContexts.find(hWnd.ptr());
+      if(xic!=inputContexts.end())
+        XSetICFocus(xic->second);
+      FocusEvent e(true, Event::UnknownReason);
+      SystemApi::dispatchFocus(cb, e);
+      break;
+      }
+    case FocusOut: {
+      auto xic = inputContexts.find(hWnd.ptr());
+      if(xic!=inputContexts.end())
+        XUnsetICFocus(xic->second);
+      FocusEvent e(false, Event::UnknownReason);
+      SystemApi::dispatchFocus(cb, e);
+      break;
+      }
+    case Expose: {
+      cb.update();
+      break;
       }
     }
   }
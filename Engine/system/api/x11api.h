@@ -2,6 +2,8 @@
 
 #include "system/systemapi.h"
 
+typedef union _XEvent XEvent;
+
 namespace Tempest {
 
 class X11Api final: SystemApi {
@@ -31,6 +33,8 @@ class X11Api final: SystemApi {
     bool     implIsRunning() override;
 
     void     alignGeometry(Window *w, Tempest::Window& owner);
+    void     implWaitEvents(AppCallBack& cb);
+    void     implDispatch(XEvent& xev);
 
   friend class SystemApi;
   };
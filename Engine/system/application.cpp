@@ -5,6 +5,7 @@
 #include <Tempest/Style>
 #include <Tempest/Font>
 
+#include <algorithm>
 #include <vector>
 #include <thread>
 #include <chrono>
@@ -19,6 +20,7 @@ struct Application::Impl : SystemApi::AppCallBack {
 
   const Style*        style=nullptr;
   Font                font;
+  bool                eventDriven=false;
 
   void addTimer(Timer& t){
     timer.push_back(&t);
@@ -45,6 +47,26 @@ struct Application::Impl : SystemApi::AppCallBack {
     return uint32_t(count);
     }
 
+  uint64_t waitTime() override {
+    return Application::implWaitTime(Application::tickCount());
+    }
+
+  // milliseconds until one of timers has to fire, uint64_t(-1) if none is running
+  uint64_t nextTimer(uint64_t now) const {
+    uint64_t ret = uint64_t(-1);
+    for(auto t:timer) {
+      const uint64_t at = t->m.lastEmit+t->m.interval;
+      if(at<=now)
+        return 0;
+      ret = std::min(ret,at-now);
+      }
+    return ret;
+    }
+
+  bool isEventDriven() override {
+    return eventDriven;
+    }
+
   void setStyle(const Style* s) {
     if(style!=nullptr)
       style->implDecRef();
@@ -97,6 +119,14 @@ void Application::processEvents() {
   SystemApi::processEvent(impl);
   }
 
+void Application::setEventDriven(bool e) {
+  impl.eventDriven = e;
+  }
+
+bool Application::isEventDriven() {
+  return impl.eventDriven;
+  }
+
 void Application::setStyle(const Style* stl) {
   impl.setStyle(stl);
   }
@@ -137,3 +167,7 @@ void Application::implAddTimer(Timer &t) {
 void Application::implDelTimer(Timer &t) {
   impl.delTimer(t);
   }
+
+uint64_t Application::implWaitTime(uint64_t now) {
+  return std::min(impl.nextTimer(now),SystemApi::AppCallBack::MaxWaitTime);
+  }
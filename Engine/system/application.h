@@ -9,6 +9,10 @@ class Timer;
 class Style;
 class Font;
 
+namespace Detail {
+class ApplicationAccess;
+}
+
 class Application {
   public:
     Application();
@@ -22,6 +26,10 @@ class Application {
     static bool         isRunning();
     static void         processEvents();
 
+    // main loop sleeps until input, timer or update request; only windows, that need it, are rendered
+    static void         setEventDriven(bool e);
+    static bool         isEventDriven();
+
     static void         setStyle(const Style* stl);
     static const Style& style();
 
@@ -35,8 +43,10 @@ class Application {
 
     static void     implAddTimer(Timer& t);
     static void     implDelTimer(Timer& t);
+    static uint64_t implWaitTime(uint64_t now);
 
   friend class Timer;
+  friend class Detail::ApplicationAccess;
   };
 
 }
@@ -5,8 +5,20 @@
 #include <Tempest/Platform>
 #include <Tempest/UiOverlay>
 
+#include "ui/hitindex.h"
+
 using namespace Tempest;
 
+struct EventDispatcher::HitScan {
+  // candidates from spatial index, in EventDispatcher::hits
+  size_t   base    = 0;
+  size_t   at      = 0;
+  size_t   end     = 0;
+  uint32_t version = 0;
+  bool     indexed = false;
+  bool     started = false;
+  };
+
 EventDispatcher::EventDispatcher() {
   }
 
@@ -225,6 +237,17 @@ void EventDispatcher::dispatchRender(Window& wnd) {
     wnd.render();
   }
 
+bool EventDispatcher::isRenderPending(Window& wnd) {
+  if(wnd.w()<=0 || wnd.h()<=0)
+    return false;
+  if(wnd.animated || wnd.astate.needToUpdate)
+    return true;
+  for(auto i:overlays)
+    if(i->astate.needToUpdate && i->bind(wnd))
+      return true;
+  return false;
+  }
+
 void EventDispatcher::dispatchOverlayRender(Window& wnd, PaintEvent& e) {
   for(size_t i=overlays.size(); i>0;) {
     --i;
@@ -260,9 +283,10 @@ std::shared_ptr<Widget::Ref> EventDispatcher::implDispatch(Widget& w, MouseEvent
     }
   Point            pos=event.pos();
   Widget::Iterator it(&w);
-  it.moveToEnd();
+  HitScan          sc;
+  implBeginScan(w,pos,it,sc);
 
-  for(;it.hasPrev();it.prev()) {
+  while(implNextHit(it,sc)) {
     Widget* i=it.get();
     if(i->rect().contains(pos)) {
       MouseEvent ex(event.x - i->x(),
@@ -274,6 +298,7 @@ std::shared_ptr<Widget::Ref> EventDispatcher::implDispatch(Widget& w, MouseEvent
                     event.type());
       auto ptr = implDispatch(*i,ex);
       if(ex.isAccepted()) {
+        implEndScan(sc);
         event.accept();
         if(it.owner!=nullptr)
           return ptr; else
@@ -281,6 +306,7 @@ std::shared_ptr<Widget::Ref> EventDispatcher::implDispatch(Widget& w, MouseEvent
         }
       }
     }
+  implEndScan(sc);
 
   if(it.owner!=nullptr) {
     if(event.type()==Event::MouseDown) {
@@ -306,6 +332,45 @@ std::shared_ptr<Widget::Ref> EventDispatcher::implDispatch(Widget& w, MouseEvent
   return nullptr;
   }
 
+void EventDispatcher::implBeginScan(Widget& w, const Point& pos, Widget::Iterator& it, HitScan& sc) {
+  it.moveToEnd();
+  sc.base = hits.size();
+  sc.at   = sc.base;
+  sc.end  = sc.base;
+  if(w.widgetsCount()<Detail::HitIndex::MinChildren)
+    return;
+  if(w.hit==nullptr)
+    w.hit = new Detail::HitIndex(w);
+  w.hit->query(pos,hits);
+  sc.end     = hits.size();
+  sc.version = w.hit->version();
+  sc.indexed = true;
+  }
+
+bool EventDispatcher::implNextHit(Widget::Iterator& it, HitScan& sc) {
+  if(sc.indexed) {
+    auto ix = it.owner!=nullptr ? it.owner->hit : nullptr;
+    if(ix!=nullptr && ix->version()==sc.version) {
+      if(sc.at==sc.end)
+        return false;
+      it.id = hits[sc.at];
+      ++sc.at;
+      sc.started = true;
+      return true;
+      }
+    // children were changed by event handler: check the rest one by one
+    sc.indexed = false;
+    }
+  if(sc.started)
+    it.prev();
+  sc.started = true;
+  return it.hasPrev();
+  }
+
+void EventDispatcher::implEndScan(HitScan& sc) {
+  hits.resize(sc.base);
+  }
+
 std::shared_ptr<Widget::Ref> EventDispatcher::implDispatch(Widget& root, FocusEvent& event) {
   Widget* w = &root;
   while(w->astate.focus!=nullptr) {
@@ -326,8 +391,9 @@ void EventDispatcher::implMouseWhell(Widget& w,MouseEvent &event) {
     }
   Point            pos=event.pos();
   Widget::Iterator it(&w);
-  it.moveToEnd();
-  for(;it.hasPrev();it.prev()) {
+  HitScan          sc;
+  implBeginScan(w,pos,it,sc);
+  while(implNextHit(it,sc)) {
     Widget* i=it.get();
     if(i->rect().contains(pos)){
       MouseEvent ex(event.x - i->x(),
@@ -340,12 +406,14 @@ void EventDispatcher::implMouseWhell(Widget& w,MouseEvent &event) {
       if(it.owner!=nullptr) {
         implMouseWhell(*i,ex);
         if(ex.isAccepted()) {
+          implEndScan(sc);
           event.accept();
           return;
           }
         }
       }
     }
+  implEndScan(sc);
 
   if(it.owner!=nullptr)
     it.owner->mouseWheelEvent(event);
@@ -26,6 +26,7 @@ class EventDispatcher final {
     void dispatchFocus     (Widget& wnd, Tempest::FocusEvent& event);
 
     void dispatchRender    (Window& wnd);
+    bool isRenderPending   (Window& wnd);
     void dispatchOverlayRender(Window& wnd,Tempest::PaintEvent& e);
     void addOverlay        (UiOverlay* ui);
     void takeOverlay       (UiOverlay* ui);
@@ -33,6 +34,8 @@ class EventDispatcher final {
     void dispatchDestroyWindow(SystemApi::Window* w);
 
   private:
+    struct HitScan;
+
     std::shared_ptr<Widget::Ref> implDispatch(Tempest::Widget &w, Tempest::MouseEvent& event);
     std::shared_ptr<Widget::Ref> implDispatch(Tempest::Widget &w, Tempest::FocusEvent& event);
     void                         implMouseWhell(Widget &w, MouseEvent &event);
@@ -43,6 +46,10 @@ class EventDispatcher final {
     void                         implExcMouseOver(Widget *w, Widget *old);
     void                         handleModKey(const KeyEvent& e);
 
+    void                         implBeginScan(Widget& w, const Point& pos, Widget::Iterator& it, HitScan& sc);
+    bool                         implNextHit(Widget::Iterator& it, HitScan& sc);
+    void                         implEndScan(HitScan& sc);
+
     std::shared_ptr<Widget::Ref> lock(std::weak_ptr<Widget::Ref>& w);
 
     Widget*                      customRoot=nullptr;
@@ -55,6 +62,8 @@ class EventDispatcher final {
     std::vector<UiOverlay*>      overlays;
     uint64_t                     mouseLastTime = 0;
     uint64_t                     mouseEvCount  = 0;
+    // children under cursor, for every level of widget tree that is being scanned
+    std::vector<size_t>          hits;
 
 
     struct Modify final {
@@ -117,6 +117,10 @@ void SystemApi::dispatchRender(Tempest::Window &w) {
   dispatcher.dispatchRender(w);
   }
 
+bool SystemApi::isRenderPending(Tempest::Window& w) {
+  return dispatcher.isRenderPending(w);
+  }
+
 void SystemApi::dispatchMouseDown(Tempest::Window &cb, MouseEvent &e) {
   dispatcher.dispatchMouseDown(cb,e);
   }
@@ -61,7 +61,14 @@ class SystemApi {
   protected:
     struct AppCallBack {
       virtual ~AppCallBack()=default;
+      // loop wakes up from time to time, to notice exit from other thread
+      static constexpr uint64_t MaxWaitTime = 500;
+
       virtual uint32_t onTimer()=0;
+      // milliseconds the loop may sleep: until one of timers has to fire, MaxWaitTime at most
+      virtual uint64_t waitTime()=0;
+      // loop waits for events, see Application::setEventDriven
+      virtual bool     isEventDriven()=0;
       };
 
     SystemApi();
@@ -89,6 +96,7 @@ class SystemApi {
 
     static void      dispatchOverlayRender(Tempest::Window &w, Tempest::PaintEvent& e);
     static void      dispatchRender    (Tempest::Window& cb);
+    static bool      isRenderPending   (Tempest::Window& cb);
     static void      dispatchMouseDown (Tempest::Window& cb, MouseEvent& e);
     static void      dispatchMouseUp   (Tempest::Window& cb, MouseEvent& e);
     static void      dispatchMouseMove (Tempest::Window& cb, MouseEvent& e);
@@ -7,7 +7,7 @@
 using namespace Tempest;
 
 AbstractTextInput::AbstractTextInput() {
-  stk.setMaxDepth(StkDepth);
+  stk.setMemoryLimit(StkMemory);
 
   textM.setFont(Application::font());
   setFocusPolicy(StrongFocus);
@@ -121,8 +121,8 @@ void AbstractTextInput::setSelection(size_t begin, size_t end) {
 void AbstractTextInput::setUndoRedoEnabled(bool enable) {
   undoEnable = enable;
   if(enable)
-    stk.setMaxDepth(0); else
-    stk.setMaxDepth(StkDepth);
+    stk.setMaxDepth(size_t(-1)); else
+    stk.setMaxDepth(0);
   scUndo.setEnable(enable);
   scRedo.setEnable(enable);
   }
@@ -136,6 +136,7 @@ void AbstractTextInput::mouseDownEvent(MouseEvent &e) {
   auto& m = margins();
   selS = textM.charAt(e.pos()-Point(m.left,m.top));
   selE = selS;
+  stk.breakMerge();
   update();
   }
 
@@ -175,12 +176,14 @@ void AbstractTextInput::keyEventImpl(KeyEvent& e) {
     selS = textM.advance(selS,-1);
     if(e.modifier!=Event::M_Shift)
       selE = selS;
+    stk.breakMerge();
     update();
     }
   else if(e.key==Event::K_Right) {
     selE = textM.advance(selE, 1);
     if(e.modifier!=Event::M_Shift)
       selS = selE;
+    stk.breakMerge();
     update();
     }
   else if(e.key==Event::K_Delete || e.key==Event::K_Back) {
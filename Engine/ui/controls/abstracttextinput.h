@@ -52,7 +52,7 @@ class AbstractTextInput : public Tempest::Widget {
 
   private:
     enum {
-      StkDepth = 64
+      StkMemory = 1024*1024
       };
     TextModel         textM;
     UndoStack<TextModel> stk;
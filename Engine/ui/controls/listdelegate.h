@@ -36,6 +36,10 @@ class ListDelegate {
       return createView(position,R_Default);
       }
 
+    // size of item along the list, for virtualized ListView: exact, or an estimate;
+    // 0 - size of first item view is used for all of them
+    virtual int     itemSize  ( size_t /*position*/ ) const { return 0; }
+
     Tempest::Signal<void()>               invalidateView, updateView;
     Tempest::Signal<void(size_t)>         onItemSelected;
     Tempest::Signal<void(size_t,Widget*)> onItemViewSelected;
@@ -63,6 +67,16 @@ class AbstractListDelegate : public ListDelegate {
       ListDelegate::removeView(w,position);
       }
 
+    Widget* update(Widget* w, size_t position) override {
+      // reuse view of other item
+      auto b = dynamic_cast<ListItem<Ctrl>*>(w);
+      if(b==nullptr || position>=data.size())
+        return ListDelegate::update(w,position);
+      b->id = position;
+      initializeItem(b,data[position]);
+      return b;
+      }
+
   protected:
     const VT& data;
 
@@ -79,7 +93,7 @@ class AbstractListDelegate : public ListDelegate {
     struct ListItem : C {
       ListItem(size_t id):id(id){}
 
-      const size_t id;
+      size_t id;
       Tempest::Signal<void(size_t,Widget*)> onClick;
 
       void emitClick() override {
@@ -1,7 +1,208 @@
 #include "listview.h"
 
+#include <algorithm>
+#include <limits>
+
 using namespace Tempest;
 
+struct ListView::Virtual : Widget {
+  static constexpr int64_t maxLength = std::numeric_limits<int>::max()/2;
+
+  struct View {
+    Widget* w   = nullptr;
+    size_t  pos = 0;
+    };
+
+  Virtual(ListView& owner):lv(owner) {
+    lv.sc.onScrolled.bind(this,&Virtual::onScrolled);
+    }
+
+  ~Virtual() {
+    lv.sc.onScrolled.ubind(this,&Virtual::onScrolled);
+    }
+
+  void resizeEvent(SizeEvent&) override {
+    realize(false);
+    }
+
+  void onScrolled() {
+    realize(false);
+    }
+
+  int  mainSize(const Size& s) const { return lv.orient==Vertical ? s.h : s.w; }
+
+  // cumulative offsets are kept only, if delegate has items of different size
+  void measure() {
+    ListDelegate& d = *lv.delegate;
+    count  = d.size();
+    itemSz = 0;
+    offsets.clear();
+
+    int  cross   = 0;
+    bool uniform = true;
+    for(size_t i=0; i<count; ++i) {
+      int sz = d.itemSize(i);
+      if(i==0)
+        itemSz = sz;
+      if(sz!=itemSz) {
+        uniform = false;
+        break;
+        }
+      }
+
+    if(uniform && itemSz<=0 && count>0) {
+      // estimate from view of first item, once until views are dropped
+      if(estimate.isEmpty()) {
+        Widget* w  = d.createView(0,lv.defaultRole);
+        Size    sh = w->sizeHint();
+        Size    mn = w->minSize();
+        estimate   = Size(std::max({sh.w,mn.w,1}),std::max({sh.h,mn.h,1}));
+        pool.push_back(View{w,0});
+        }
+      itemSz = mainSize(estimate);
+      cross  = lv.orient==Vertical ? estimate.w : estimate.h;
+      }
+
+    int64_t total = 0;
+    if(uniform) {
+      total = int64_t(itemSz)*int64_t(count);
+      } else {
+      offsets.resize(count+1);
+      for(size_t i=0; i<count; ++i) {
+        offsets[i] = total;
+        total     += std::max(0,d.itemSize(i));
+        }
+      offsets[count] = total;
+      }
+
+    const int len = int(std::min<int64_t>(total,maxLength));
+    // content can be longer, than maxWidgetSize
+    if(lv.orient==Vertical) {
+      setSizePolicy(Preferred,Fixed);
+      setMaximumSize(SizePolicy::maxWidgetSize().w,std::max(len,SizePolicy::maxWidgetSize().h));
+      setSizeHint(Size(cross,len));
+      } else {
+      setSizePolicy(Fixed,Preferred);
+      setMaximumSize(std::max(len,SizePolicy::maxWidgetSize().w),SizePolicy::maxWidgetSize().h);
+      setSizeHint(Size(len,cross));
+      }
+    }
+
+  int64_t offsetOf(size_t i) const {
+    if(offsets.empty())
+      return int64_t(i)*itemSz;
+    return offsets[i];
+    }
+
+  size_t indexAt(int64_t pos) const {
+    if(pos<=0 || count==0)
+      return 0;
+    if(offsets.empty())
+      return std::min(size_t(pos/itemSz),count);
+    auto i = std::upper_bound(offsets.begin(),offsets.end(),pos);
+    return std::min(size_t(std::distance(offsets.begin(),i))-1,count);
+    }
+
+  // create views for visible items and a half-screen margin around them
+  void realize(bool refresh) {
+    if(busy || lv.delegate==nullptr)
+      return;
+    busy = true;
+
+    ListDelegate& d    = *lv.delegate;
+    const bool    vert = lv.orient==Vertical;
+    const int     view = vert ? lv.sc.h() : lv.sc.w();
+    const int64_t at   = vert ? lv.sc.scrollV() : lv.sc.scrollH();
+    const int     over = view/2;
+
+    const size_t  begin = indexAt(at-over);
+    const size_t  end   = std::min(count,indexAt(at+view+over)+1);
+
+    // take views, that went out of range
+    for(size_t i=0; i<items.size(); ++i) {
+      auto& v = items[i];
+      if(v.w==nullptr)
+        continue;
+      if(refresh || v.pos<begin || v.pos>=end || v.pos>=count) {
+        takeWidget(v.w);
+        pool.push_back(v);
+        }
+      }
+
+    std::vector<View> next(end-begin);
+    for(auto& v:items) {
+      if(v.w==nullptr || v.w->owner()!=this)
+        continue;
+      next[v.pos-begin] = v;
+      }
+
+    for(size_t i=begin; i<end; ++i) {
+      auto& v = next[i-begin];
+      if(v.w==nullptr) {
+        v.pos = i;
+        v.w   = fromPool(d,i);
+        addWidget(v.w);
+        }
+      // content is cut at maxLength, items behind it can't be scrolled to anyway
+      const int off = int(std::min<int64_t>(offsetOf(i),maxLength));
+      const int sz  = offsets.empty() ? itemSz : int(offsets[i+1]-offsets[i]);
+      if(vert)
+        v.w->setGeometry(0,off,w(),sz); else
+        v.w->setGeometry(off,0,sz,h());
+      }
+    items = std::move(next);
+
+    // keep few views for next scroll
+    const size_t keep = std::max<size_t>(4,items.size()/2);
+    while(pool.size()>keep) {
+      auto v = pool.back();
+      pool.pop_back();
+      d.removeView(v.w,v.pos);
+      }
+    busy = false;
+    }
+
+  Widget* fromPool(ListDelegate& d, size_t pos) {
+    // same item is likely to have same view
+    for(size_t i=0; i<pool.size(); ++i)
+      if(pool[i].pos==pos) {
+        auto w = pool[i].w;
+        pool.erase(pool.begin()+int(i));
+        return d.update(w,pos);
+        }
+    if(!pool.empty()) {
+      auto w = pool.back().w;
+      pool.pop_back();
+      return d.update(w,pos);
+      }
+    return d.createView(pos,lv.defaultRole);
+    }
+
+  void clear() {
+    for(auto& v:items)
+      if(v.w!=nullptr) {
+        takeWidget(v.w);
+        pool.push_back(v);
+        }
+    items.clear();
+    for(auto& v:pool)
+      if(lv.delegate!=nullptr)
+        lv.delegate->removeView(v.w,v.pos); else
+        delete v.w;
+    pool.clear();
+    estimate = Size();
+    }
+
+  ListView&            lv;
+  std::vector<View>    items;
+  std::vector<View>    pool;
+  std::vector<int64_t> offsets;
+  Size                 estimate;
+  int                  itemSz = 0;
+  size_t               count  = 0;
+  bool                 busy   = false;
+  };
+
 ListView::ListView(Orientation ori)
   : sc(ori) {
   sc.scrollAfterEndV(true);
@@ -13,6 +214,10 @@ ListView::ListView(Orientation ori)
 
 ListView::~ListView() {
   removeDelegate();
+  if(virt!=nullptr) {
+    sc.centralWidget().takeWidget(virt);
+    delete virt;
+    }
   }
 
 Widget& ListView::centralWidget() {
@@ -33,15 +238,43 @@ void ListView::implSetDelegate(ListDelegate* d) {
 void ListView::removeDelegate() {
   if(!delegate)
     return;
-  sc.centralWidget().removeAllWidgets();
+  implRemoveViews();
 
   delegate->onItemSelected.ubind(&onItemSelected,&Tempest::Signal<void(size_t)>::operator());
   delegate->invalidateView.ubind(this,&ListView::invalidateView);
   delegate->updateView    .ubind(this,&ListView::updateView    );
   }
 
+void ListView::implRemoveViews() {
+  if(virt!=nullptr)
+    virt->clear(); else
+    sc.centralWidget().removeAllWidgets();
+  }
+
 void ListView::setLayout(Orientation ori) {
+  orient = ori;
   sc.setLayout(ori);
+  if(virt!=nullptr && delegate)
+    invalidateView();
+  }
+
+void ListView::setVirtualized(bool v) {
+  if(v==isVirtualized())
+    return;
+  if(delegate)
+    implRemoveViews();
+  if(virt!=nullptr) {
+    sc.centralWidget().takeWidget(virt);
+    delete virt;
+    virt = nullptr;
+    }
+  sc.centralWidget().removeAllWidgets();
+  if(v) {
+    virt = new Virtual(*this);
+    sc.centralWidget().addWidget(virt);
+    }
+  if(delegate)
+    updateView();
   }
 
 void ListView::setDefaultItemRole(ListDelegate::Role role) {
@@ -52,6 +285,11 @@ void ListView::setDefaultItemRole(ListDelegate::Role role) {
   }
 
 void ListView::invalidateView(){
+  if(virt!=nullptr) {
+    virt->clear();
+    updateView();
+    return;
+    }
   auto& w = sc.centralWidget();
   while(w.widgetsCount()>0) {
     size_t i=w.widgetsCount()-1;
@@ -64,6 +302,12 @@ void ListView::invalidateView(){
   }
 
 void ListView::updateView() {
+  if(virt!=nullptr) {
+    virt->measure();
+    virt->realize(true);
+    onItemListChanged();
+    return;
+    }
   auto&  w      = sc.centralWidget();
   size_t cnt    = delegate->size();
   size_t wcount = w.widgetsCount();
@@ -29,15 +29,25 @@ class ListView : public Widget {
     void setDefaultItemRole(ListDelegate::Role role);
     auto defaultItemRole() const -> ListDelegate::Role { return defaultRole; }
 
+    // widgets exist only for items near visible area, and are recycled while scrolling;
+    // sizes of items come from ListDelegate::itemSize
+    void setVirtualized(bool v);
+    bool isVirtualized() const { return virt!=nullptr; }
+
     void invalidateView();
     void updateView();
 
   private:
+    struct Virtual;
+
     void implSetDelegate(ListDelegate* d);
+    void implRemoveViews();
 
     ScrollWidget                   sc;
     std::unique_ptr<ListDelegate>  delegate;
     ListDelegate::Role             defaultRole = ListDelegate::R_ListItem;
+    Orientation                    orient      = Vertical;
+    Virtual*                       virt        = nullptr;
   };
 
 }
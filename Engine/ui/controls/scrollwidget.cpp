@@ -2,9 +2,18 @@
 
 #include <Tempest/Platform>
 #include <Tempest/Layout>
+#include <Tempest/Application>
+
+#include <cmath>
 
 using namespace Tempest;
 
+// kinetic scroll: speed decays as exp(-Friction*t), so impulse v travels v/Friction pixels
+static const float    Friction    = 5.f;
+static const float    MinSpeed    = 20.f;
+static const uint64_t FrameTime   = 16;
+static const uint64_t ReleaseTime = 100;
+
 struct ScrollWidget::BoxLayout: public Tempest::LinearLayout {
   BoxLayout(ScrollWidget* sc,Orientation ori ):LinearLayout(ori), sc(sc){}
 
@@ -90,6 +99,7 @@ ScrollWidget::ScrollWidget(Orientation ori)
 
   sbH.onValueChanged.bind(this, static_cast<void(ScrollWidget::*)(int)>(&ScrollWidget::scrollH));
   sbV.onValueChanged.bind(this, static_cast<void(ScrollWidget::*)(int)>(&ScrollWidget::scrollV));
+  kinTimer.timeout.bind(this, &ScrollWidget::kineticTick);
 
   setHscrollViewMode(this->hor );
   setVscrollViewMode(this->vert);
@@ -310,6 +320,16 @@ void ScrollWidget::mouseWheelEvent(Tempest::MouseEvent &e) {
     return;
     }
 
+  if(kinetic) {
+    if(!kin.active)
+      kineticStart();
+    if(e.delta>0)
+      kin.vy -= float(sbV.largeStep())*Friction; else
+    if(e.delta<0)
+      kin.vy += float(sbV.largeStep())*Friction;
+    return;
+    }
+
   if(e.delta>0)
     sbV.setValue(sbV.value() - sbV.largeStep()); else
   if(e.delta<0)
@@ -320,14 +340,123 @@ void ScrollWidget::mouseMoveEvent(Tempest::MouseEvent &e) {
   e.ignore();
   }
 
+void ScrollWidget::mouseDownEvent(MouseEvent& e) {
+  if(!kinetic || !isEnabled() || e.button!=Event::ButtonLeft) {
+    e.ignore();
+    return;
+    }
+  stopScrolling();
+  kin.drag = true;
+  kin.mpos = e.pos();
+  kin.time = Application::tickCount();
+  }
+
+void ScrollWidget::mouseDragEvent(MouseEvent& e) {
+  if(!kin.drag)
+    return;
+  const uint64_t now = Application::tickCount();
+  const Point    d   = kin.mpos-e.pos();
+  scrollH(scrollH()+d.x);
+  scrollV(scrollV()+d.y);
+
+  if(now>kin.time) {
+    // speed of last moves, smoothed
+    const float dt = float(now-kin.time)/1000.f;
+    kin.vx = 0.7f*float(d.x)/dt + 0.3f*kin.vx;
+    kin.vy = 0.7f*float(d.y)/dt + 0.3f*kin.vy;
+    kin.time = now;
+    }
+  kin.mpos = e.pos();
+  }
+
+void ScrollWidget::mouseUpEvent(MouseEvent&) {
+  if(!kin.drag)
+    return;
+  kin.drag = false;
+  if(Application::tickCount()>kin.time+ReleaseTime) {
+    // content was held still before release
+    kin.vx = 0;
+    kin.vy = 0;
+    }
+  const float vx = kin.vx, vy = kin.vy;
+  kineticStart();
+  kin.vx = vx;
+  kin.vy = vy;
+  if(std::abs(vx)<MinSpeed && std::abs(vy)<MinSpeed)
+    stopScrolling();
+  }
+
 void ScrollWidget::scrollH( int v ) {
   sbH.setValue( v );
   cen.setPosition(-sbH.value(), cen.y());
+  onScrolled();
   }
 
 void ScrollWidget::scrollV(int v) {
   sbV.setValue( v );
   cen.setPosition(cen.x(), -sbV.value());
+  onScrolled();
+  }
+
+void ScrollWidget::setCachedScroll(bool c) {
+  cached = c;
+  cen.setMoveRetained(c);
+  }
+
+void ScrollWidget::setKineticScroll(bool k) {
+  kinetic = k;
+  if(!kinetic)
+    stopScrolling();
+  }
+
+void ScrollWidget::stopScrolling() {
+  kinTimer.stop();
+  kin = Kinetic();
+  }
+
+void ScrollWidget::kineticStart() {
+  kin.drag   = false;
+  kin.active = true;
+  kin.vx     = 0;
+  kin.vy     = 0;
+  kin.x      = float(scrollH());
+  kin.y      = float(scrollV());
+  kin.time   = Application::tickCount();
+  kinTimer.start(FrameTime);
+  }
+
+void ScrollWidget::kineticTick() {
+  const int sx = scrollH(), sy = scrollV();
+  if(sx!=int(std::lround(kin.x)) || sy!=int(std::lround(kin.y))) {
+    // scrolled by someone else meanwhile
+    stopScrolling();
+    return;
+    }
+
+  const uint64_t now = Application::tickCount();
+  if(now<=kin.time)
+    return;
+  const float dt    = float(now-kin.time)/1000.f;
+  const float decay = std::exp(-Friction*dt);
+  kin.time  = now;
+  kin.x    += kin.vx*(1.f-decay)/Friction;
+  kin.y    += kin.vy*(1.f-decay)/Friction;
+  kin.vx   *= decay;
+  kin.vy   *= decay;
+
+  scrollH(int(std::lround(kin.x)));
+  scrollV(int(std::lround(kin.y)));
+  // stop at the ends of scroll range
+  if(scrollH()!=int(std::lround(kin.x))) {
+    kin.x  = float(scrollH());
+    kin.vx = 0;
+    }
+  if(scrollV()!=int(std::lround(kin.y))) {
+    kin.y  = float(scrollV());
+    kin.vy = 0;
+    }
+  if(std::abs(kin.vx)<MinSpeed && std::abs(kin.vy)<MinSpeed)
+    stopScrolling();
   }
 
 int ScrollWidget::scrollH() const {
@@ -354,6 +483,7 @@ void ScrollWidget::complexLayout() {
       break;
   cenLay->commitLayout();
   layoutBusy=false;
+  onScrolled();
   }
 
 void ScrollWidget::wrapContent() {
@@ -2,6 +2,7 @@
 
 #include <Tempest/Widget>
 #include <Tempest/ScrollBar>
+#include <Tempest/Timer>
 
 namespace Tempest {
 
@@ -46,9 +47,27 @@ class ScrollWidget : public Tempest::Widget {
     int     scrollH() const;
     int     scrollV() const;
 
+    // content keeps painted geometry while scrolled: only widgets, that come into view, are painted again
+    void    setCachedScroll(bool c);
+    bool    isCachedScroll() const { return cached; }
+
+    // wheel scrolls smoothly and drag of content keeps it moving by inertia
+    void    setKineticScroll(bool k);
+    bool    isKineticScroll() const { return kinetic; }
+    bool    isScrolling() const { return kin.active; }
+    void    stopScrolling();
+
+    // content was scrolled, or visible area changed
+    Tempest::Signal<void()> onScrolled;
+
   protected:
     void    mouseWheelEvent(Tempest::MouseEvent &e);
     void    mouseMoveEvent(Tempest::MouseEvent &e);
+    void    mouseDownEvent(Tempest::MouseEvent &e);
+    void    mouseDragEvent(Tempest::MouseEvent &e);
+    void    mouseUpEvent  (Tempest::MouseEvent &e);
+    // step of kinetic scroll, runs by timer
+    void    kineticTick();
 
     virtual Size contentAreaSize();
 
@@ -57,6 +76,17 @@ class ScrollWidget : public Tempest::Widget {
     struct ProxyLayout;
     struct Central:Widget {
       using Widget::setSizeHint;
+      using Widget::setMoveRetained;
+      };
+
+    struct Kinetic {
+      // px per second
+      float    vx=0, vy=0;
+      float    x=0,  y=0;
+      uint64_t time=0;
+      Point    mpos;
+      bool     drag=false;
+      bool     active=false;
       };
 
     bool    updateScrolls(Orientation orient, bool noRetry);
@@ -67,6 +97,7 @@ class ScrollWidget : public Tempest::Widget {
 
     void    complexLayout();
     void    wrapContent();
+    void    kineticStart();
 
     Central        cen;
     Widget         helper;
@@ -84,6 +115,11 @@ class ScrollWidget : public Tempest::Widget {
 
     bool           layoutBusy = false;
 
+    bool           cached  = false;
+    bool           kinetic = false;
+    Kinetic        kin;
+    Timer          kinTimer;
+
     using Tempest::Widget::layout;
   };
 
@@ -189,7 +189,7 @@ class PaintEvent: public Event {
 
     PaintEvent(PaintEvent& parent,int32_t dx,int32_t dy,int32_t x,int32_t y,int32_t w,int32_t h)
       : dev(parent.dev),ta(parent.ta),outW(parent.outW),outH(parent.outH),
-        dp(parent.dp.x+dx,parent.dp.y+dy),vp(x,y,w,h){
+        dp(parent.dp.x+dx,parent.dp.y+dy),vp(x,y,w,h),movable(parent.movable){
       setType( Paint );
       }
 
@@ -208,10 +208,13 @@ class PaintEvent: public Event {
 
     Point         dp;
     Rect          vp;
+    // painted inside of widget, that moves as whole, see PaintDevice::RangeKey::movable
+    bool          movable=false;
 
     using Event::accept;
 
   friend class Painter;
+  friend class Widget;
   };
 
 /*!
@@ -0,0 +1,155 @@
+#include "hitindex.h"
+
+#include <Tempest/Widget>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+static constexpr int maxCells = 1024;
+
+HitIndex::HitIndex(Widget& owner)
+  :owner(owner) {
+  }
+
+void HitIndex::invalidate() {
+  ++ver;
+  stale = true;
+  dirty.clear();
+  }
+
+void HitIndex::moved(const Widget& child) {
+  ++ver;
+  if(stale)
+    return;
+  auto i = ids.find(&child);
+  if(i==ids.end() || isDirty[i->second])
+    return;
+  // many changes at once, usually from layout: cheaper to start over
+  if(dirty.size()*4>placed.size()) {
+    invalidate();
+    return;
+    }
+  isDirty[i->second] = true;
+  dirty.push_back(i->second);
+  }
+
+void HitIndex::query(const Point& p, std::vector<size_t>& out) {
+  if(stale)
+    rebuild(); else
+    update();
+  if(nx==0)
+    return;
+
+  const int cx = std::clamp((p.x-bounds.x)/cellW, 0, nx-1);
+  const int cy = std::clamp((p.y-bounds.y)/cellH, 0, ny-1);
+  auto&     c  = grid[size_t(cy*nx+cx)];
+  for(size_t i=c.size(); i>0;) {
+    --i;
+    auto& w = owner.widget(c[i]);
+    if(w.isVisible() && w.rect().contains(p))
+      out.push_back(c[i]);
+    }
+  }
+
+void HitIndex::rebuild() {
+  const size_t count = owner.widgetsCount();
+  stale = false;
+  dirty.clear();
+  ids.clear();
+  ids.reserve(count);
+  placed.assign(count,Cells());
+  isDirty.assign(count,false);
+
+  // average child defines size of cell
+  Rect   bbox;
+  size_t vis  = 0;
+  int64_t sw  = 0, sh = 0;
+  for(size_t i=0; i<count; ++i) {
+    auto& w = owner.widget(i);
+    ids[&w] = uint32_t(i);
+    if(!w.isVisible() || w.rect().isEmpty())
+      continue;
+    bbox = vis==0 ? w.rect() : bbox.united(w.rect());
+    sw  += w.w();
+    sh  += w.h();
+    ++vis;
+    }
+
+  bounds = bbox;
+  if(vis==0) {
+    nx = 0;
+    ny = 0;
+    grid.clear();
+    return;
+    }
+
+  const int64_t avgW = std::max<int64_t>(1,sw/int64_t(vis));
+  const int64_t avgH = std::max<int64_t>(1,sh/int64_t(vis));
+  nx = int(std::clamp<int64_t>(bounds.w/avgW,1,maxCells));
+  ny = int(std::clamp<int64_t>(bounds.h/avgH,1,maxCells));
+  // keep memory proportional to amount of children
+  const double limit = double(std::max<size_t>(16,vis*2));
+  if(double(nx)*double(ny)>limit) {
+    const double k = std::sqrt(limit/(double(nx)*double(ny)));
+    nx = std::max(1,int(nx*k));
+    ny = std::max(1,int(ny*k));
+    }
+  cellW = std::max(1,(bounds.w+nx-1)/nx);
+  cellH = std::max(1,(bounds.h+ny-1)/ny);
+
+  grid.resize(size_t(nx*ny));
+  for(auto& c:grid)
+    c.clear();
+  for(size_t i=0; i<count; ++i) {
+    auto& w = owner.widget(i);
+    placed[i] = cellsOf(w);
+    insert(uint32_t(i),placed[i]);
+    }
+  }
+
+void HitIndex::update() {
+  for(auto id:dirty) {
+    isDirty[id] = false;
+    auto& w = owner.widget(id);
+    remove(id,placed[id]);
+    placed[id] = cellsOf(w);
+    insert(id,placed[id]);
+    }
+  dirty.clear();
+  }
+
+HitIndex::Cells HitIndex::cellsOf(const Widget& w) const {
+  Cells c;
+  if(nx==0 || !w.isVisible() || w.rect().isEmpty())
+    return c;
+  // widgets outside of bounds go to border cells
+  const Rect& r = w.rect();
+  c.x0 = std::clamp((r.x      -bounds.x)/cellW, 0, nx-1);
+  c.y0 = std::clamp((r.y      -bounds.y)/cellH, 0, ny-1);
+  c.x1 = std::clamp((r.x+r.w-1-bounds.x)/cellW, 0, nx-1);
+  c.y1 = std::clamp((r.y+r.h-1-bounds.y)/cellH, 0, ny-1);
+  return c;
+  }
+
+void HitIndex::insert(uint32_t id, const Cells& c) {
+  for(int y=c.y0; y<=c.y1; ++y)
+    for(int x=c.x0; x<=c.x1; ++x) {
+      auto& v = grid[size_t(y*nx+x)];
+      if(v.empty() || v.back()<id)
+        v.push_back(id); else
+        v.insert(std::lower_bound(v.begin(),v.end(),id),id);
+      }
+  }
+
+void HitIndex::remove(uint32_t id, const Cells& c) {
+  for(int y=c.y0; y<=c.y1; ++y)
+    for(int x=c.x0; x<=c.x1; ++x) {
+      auto& v = grid[size_t(y*nx+x)];
+      auto  i = std::lower_bound(v.begin(),v.end(),id);
+      if(i!=v.end() && *i==id)
+        v.erase(i);
+      }
+  }
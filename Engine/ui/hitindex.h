@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Tempest/Rect>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Tempest {
+
+class Widget;
+
+namespace Detail {
+
+// uniform grid over children of one widget, to find ones under cursor without testing all of them
+class HitIndex final {
+  public:
+    // smaller widgets are scanned linearly
+    static constexpr size_t MinChildren = 32;
+
+    explicit HitIndex(Widget& owner);
+
+    // children were added, removed or reordered
+    void     invalidate();
+    // geometry or visibility of child has changed
+    void     moved(const Widget& child);
+    // any change of children; scan, that started before, is not valid anymore
+    uint32_t version() const { return ver; }
+
+    // appends indices of visible children, that contain p: topmost first
+    void     query(const Point& p, std::vector<size_t>& out);
+
+  private:
+    struct Cells {
+      int x0=0, y0=0, x1=-1, y1=-1;
+      };
+
+    void     rebuild();
+    void     update();
+    Cells    cellsOf(const Widget& w) const;
+    void     insert(uint32_t id, const Cells& c);
+    void     remove(uint32_t id, const Cells& c);
+
+    Widget&                                    owner;
+    uint32_t                                   ver   = 0;
+    bool                                       stale = true;
+
+    Rect                                       bounds;
+    int                                        cellW = 1, cellH = 1;
+    int                                        nx    = 0, ny    = 0;
+    // child ids in ascending order, per cell
+    std::vector<std::vector<uint32_t>>         grid;
+    std::vector<Cells>                         placed;
+    std::vector<uint32_t>                      dirty;
+    std::vector<bool>                          isDirty;
+    std::unordered_map<const Widget*,uint32_t> ids;
+  };
+
+}
+}
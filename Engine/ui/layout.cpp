@@ -2,6 +2,8 @@
 
 #include <Tempest/Widget>
 
+#include "hitindex.h"
+
 using namespace Tempest;
 
 static int clamp(int min,int v,int max){
@@ -66,7 +68,9 @@ Widget *Layout::takeWidget(size_t i) {
     Widget* wx=w->wx[i];
     w->wx.erase(w->wx.begin()+int(i));
     wx->ow=nullptr;
-    applyLayout();
+    if(w->hit!=nullptr)
+      w->hit->invalidate();
+    w->implChildChanged();
     return wx;
     }
   return nullptr;
@@ -89,6 +93,37 @@ void LinearLayout::applyLayout(Widget &w, Orientation ori) {
 
 template<bool hor>
 void LinearLayout::implApplyLayout(Widget &w) {
+  const Rect client = w.clientRect();
+  if(cache.gen==w.layGen && cache.valid) {
+    // same children and same place: result is same as well
+    if(cache.client==client && cache.spacing==w.spacing())
+      return;
+    } else {
+    measure<hor>(w);
+    cache.measures++;
+    cache.gen   = w.layGen;
+    cache.valid = true;
+    }
+  cache.client  = client;
+  cache.spacing = w.spacing();
+
+  const Measure& m        = cache.m;
+  const size_t   visCount = size_t(m.visCount);
+  int freeSpace = getW<hor>(w.size())-(hor ? w.margins().xMargin() : w.margins().yMargin());
+  freeSpace -= (m.fixSize+m.prefSize+m.expSize);
+  freeSpace -= (visCount==0 ? 0 : (int(visCount)-1)*w.spacing());
+  if(freeSpace<0)
+    freeSpace=0;
+
+  // geometry, that is set here, doesn't invalidate the cache
+  const bool busy = w.astate.layBusy;
+  w.astate.layBusy = true;
+  implApplyLayout<hor>(w,w.widgetsCount(),visCount,m.exp>0,((m.exp>0) ? m.expSize : m.prefSize),freeSpace,(m.exp>0) ? m.exp : m.pref);
+  w.astate.layBusy = busy;
+  }
+
+template<bool hor>
+void LinearLayout::measure(Widget &w) {
   int    fixSize  = 0;
   int    prefSize = 0;
   int    expSize  = 0;
@@ -131,12 +166,12 @@ void LinearLayout::implApplyLayout(Widget &w) {
       }
     }
 
-  int freeSpace = getW<hor>(w.size())-(hor ? w.margins().xMargin() : w.margins().yMargin());
-  freeSpace -= (fixSize+prefSize+expSize);
-  freeSpace -= (visCount==0 ? 0 : (int(visCount)-1)*w.spacing());
-  if(freeSpace<0)
-    freeSpace=0;
-  implApplyLayout<hor>(w,count,visCount,exp>0,((exp>0) ? expSize : prefSize),freeSpace,(exp>0) ? exp : pref);
+  cache.m.fixSize  = fixSize;
+  cache.m.prefSize = prefSize;
+  cache.m.expSize  = expSize;
+  cache.m.pref     = pref;
+  cache.m.exp      = exp;
+  cache.m.visCount = int(visCount);
   }
 
 template<bool hor>
@@ -38,15 +38,40 @@ class LinearLayout : public Layout {
 
     void applyLayout() override { applyLayout(*owner(),ori); }
     Orientation orientation() const { return ori; }
+    // passes over children, that were not served from the cache
+    size_t      measureCount() const { return cache.measures; }
 
   private:
+    // sizes of children, valid while Widget::layGen of owner is same
+    struct Measure {
+      int fixSize  = 0;
+      int prefSize = 0;
+      int expSize  = 0;
+      int pref     = 0;
+      int exp      = 0;
+      int visCount = 0;
+      };
+
+    struct Cache {
+      Measure  m;
+      Rect     client;
+      int      spacing = 0;
+      uint32_t gen     = 0;
+      bool     valid   = false;
+      size_t   measures= 0;
+      };
+
     Orientation ori;
+    Cache       cache;
 
     void applyLayout(Widget& w,Orientation ori);
 
     template<bool hor>
     void implApplyLayout(Widget& w);
 
+    template<bool hor>
+    void measure(Widget& w);
+
     template<bool hor>
     void implApplyLayout(Widget& w,size_t count,size_t visCount,bool exp,int sum,int free,int expCount);
   };
@@ -3,7 +3,10 @@
 #include <Tempest/Application>
 #include <Tempest/Painter>
 #include <Tempest/TextCodec>
+#include <Tempest/TextLayout>
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include "utility/utf8_helper.h"
 
@@ -35,6 +38,32 @@ void TextModel::CommandInsert::undo(TextModel& subj) {
     }
   }
 
+bool TextModel::CommandInsert::mergeWith(const Command& next) {
+  auto n = dynamic_cast<const CommandInsert*>(&next);
+  if(n==nullptr)
+    return false;
+  const char*  a  = text();
+  const char*  b  = n->text();
+  const size_t la = std::strlen(a);
+  if(n->where.line!=where.line || n->where.offset!=where.offset+la)
+    return false;
+  if(std::strchr(a,'\n')!=nullptr || std::strchr(b,'\n')!=nullptr)
+    return false;
+  // one step per word: space after a letter starts new run
+  if(la>0 && a[la-1]!=' ' && b[0]==' ')
+    return false;
+  if(txtShort[0]!='\0') {
+    txt.assign(txtShort);
+    txtShort[0] = '\0';
+    }
+  txt.append(b);
+  return true;
+  }
+
+size_t TextModel::CommandInsert::memoryUsage() const {
+  return sizeof(*this) + txt.capacity();
+  }
+
 
 TextModel::CommandReplace::CommandReplace(const char* txtIn, TextModel::Cursor beg, TextModel::Cursor e)
   : begin(beg), end(e) {
@@ -66,6 +95,10 @@ void TextModel::CommandReplace::undo(TextModel& subj) {
   subj.replace(prev.data(), begin,e);
   }
 
+size_t TextModel::CommandReplace::memoryUsage() const {
+  return sizeof(*this) + txt.capacity() + prev.capacity();
+  }
+
 
 TextModel::CommandErase::CommandErase(TextModel::Cursor beg, TextModel::Cursor e)
   : begin(beg), end(e) {
@@ -78,8 +111,10 @@ void TextModel::CommandErase::redo(TextModel& subj) {
   auto e = subj.cursorCast(end);
   if(e-s<3) {
     subj.fetch(begin,end,prevShort);
+    prev.clear();
     } else {
     subj.fetch(begin,end,prev);
+    prevShort[0] = '\0';
     }
   subj.erase(begin,end);
   }
@@ -90,33 +125,75 @@ void TextModel::CommandErase::undo(TextModel& subj) {
     subj.insert(prevShort,begin);
   }
 
+bool TextModel::CommandErase::mergeWith(const Command& next) {
+  auto n = dynamic_cast<const CommandErase*>(&next);
+  if(n==nullptr)
+    return false;
+  if(begin.line!=end.line || n->begin.line!=begin.line || n->end.line!=begin.line)
+    return false;
 
-TextModel::TextModel(const char *str)
-  :txt(std::strlen(str)+1){
-  std::memcpy(txt.data(),str,txt.size());
-  buildIndex();
+  const char* a = prevShort[0]=='\0' ? prev.data() : prevShort;
+  const char* b = n->prevShort[0]=='\0' ? n->prev.data() : n->prevShort;
+  if(n->end==begin) {
+    // backspace
+    std::string s = b;
+    s.append(a);
+    prev  = std::move(s);
+    begin = n->begin;
+    }
+  else if(n->begin==begin) {
+    // delete
+    std::string s = a;
+    s.append(b);
+    prev        = std::move(s);
+    end.offset += n->end.offset-n->begin.offset;
+    }
+  else {
+    return false;
+    }
+  prevShort[0] = '\0';
+  return true;
+  }
+
+size_t TextModel::CommandErase::memoryUsage() const {
+  return sizeof(*this) + prev.capacity();
+  }
+
+
+TextModel::TextModel(const char *str) {
+  setText(str);
   }
 
 void TextModel::setText(const char *str) {
-  txt.resize(std::strlen(str)+1);
-  std::memcpy(txt.data(),str,txt.size());
-  buildIndex();
-  sz.actual=false;
+  orig.txt.assign(str);
+  orig.nl.clear();
+  for(size_t i=0; i<orig.txt.size(); ++i)
+    if(orig.txt[i]=='\n')
+      orig.nl.push_back(i);
+  add.txt.clear();
+  add.nl.clear();
+
+  pieces.clear();
+  freeList.clear();
+  root    = orig.txt.empty() ? Piece::npos : mkPiece(false,0,orig.txt.size());
+  hasText = true;
+
+  flatOk    = false;
+  widthsOk  = false;
+  sz.actual = false;
   }
 
 void TextModel::insert(const char* t, Cursor where) {
-  if(txt.size()==0) {
+  if(!hasText) {
     setText(t);
     return;
     }
   size_t at  = cursorCast(where);
   size_t len = std::strlen(t);
+  size_t ln  = newLines(at);
 
-  txt.insert(txt.begin()+at,t,t+len);
-  buildIndex();
-  sz.actual=false;
-
-  cursorCast(at+len);
+  implInsert(at,t,len);
+  implEdited(ln,0,size_t(std::count(t,t+len,'\n')));
   }
 
 void TextModel::erase(Cursor cs, Cursor ce) {
@@ -125,9 +202,10 @@ void TextModel::erase(Cursor cs, Cursor ce) {
   if(e<s)
     std::swap(s,e);
 
-  txt.erase(txt.begin()+s,txt.begin()+e);
-  buildIndex();
-  sz.actual=false;
+  size_t ln = newLines(s);
+  size_t nl = newLines(e)-ln;
+  implErase(s,e);
+  implEdited(ln,nl,0);
   }
 
 void TextModel::erase(TextModel::Cursor s, size_t count) {
@@ -136,7 +214,7 @@ void TextModel::erase(TextModel::Cursor s, size_t count) {
   }
 
 void TextModel::replace(const char* t, TextModel::Cursor cs, TextModel::Cursor ce) {
-  if(txt.size()==0) {
+  if(!hasText) {
     setText(t);
     return;
     }
@@ -146,11 +224,11 @@ void TextModel::replace(const char* t, TextModel::Cursor cs, TextModel::Cursor c
   if(e<s)
     std::swap(s,e);
 
-  txt.erase (txt.begin()+s,txt.begin()+e);
-  txt.insert(txt.begin()+s,t,t+len);
-
-  buildIndex();
-  sz.actual=false;
+  size_t ln = newLines(s);
+  size_t nl = newLines(e)-ln;
+  implErase (s,e);
+  implInsert(s,t,len);
+  implEdited(ln,nl,size_t(std::count(t,t+len,'\n')));
   }
 
 void TextModel::fetch(TextModel::Cursor cs, TextModel::Cursor ce, std::string& buf) {
@@ -161,7 +239,7 @@ void TextModel::fetch(TextModel::Cursor cs, TextModel::Cursor ce, std::string& b
   if(e<s)
     std::swap(s,e);
   buf.resize(e-s);
-  std::memcpy(&buf[0],&txt[s],buf.size());
+  read(s,e,&buf[0]);
   }
 
 void TextModel::fetch(TextModel::Cursor cs, TextModel::Cursor ce, char* buf) {
@@ -171,21 +249,30 @@ void TextModel::fetch(TextModel::Cursor cs, TextModel::Cursor ce, char* buf) {
     return;
   if(e<s)
     std::swap(s,e);
-  std::memcpy(&buf[0],&txt[s],e-s);
+  read(s,e,buf);
   }
 
 TextModel::Cursor TextModel::advance(TextModel::Cursor src, int32_t offset) const {
-  size_t c = cursorCast(src);
+  const size_t total = size();
+  const size_t c     = std::min(cursorCast(src),total);
+  std::string  buf;
   if(offset>0) {
-    const char* str = txt.data()+c, *end = txt.data()+txt.size()-(txt.size() ? 1 : 0);
+    // letter is 4 bytes at most
+    const size_t e = std::min(total,c+size_t(offset)*4);
+    buf.resize(e-c);
+    read(c,e,&buf[0]);
+    const char* str = buf.data(), *end = buf.data()+buf.size();
     for(int32_t i=0;i<offset && str<end;++i) {
       const auto l = Detail::utf8LetterLength(str);
       str+=l;
       }
-    return cursorCast(std::distance(txt.data(),str));
+    return cursorCast(c+size_t(std::min(str,end)-buf.data()));
     } else {
     offset = -offset;
-    const char* str = txt.data()+c, *begin = txt.data();
+    const size_t b = c-std::min(c,size_t(offset)*4);
+    buf.resize(c-b);
+    read(b,c,&buf[0]);
+    const char* str = buf.data()+buf.size(), *begin = buf.data();
     for(int32_t i=0;i<offset;++i) {
       while(str!=begin) {
         str--;
@@ -193,13 +280,14 @@ TextModel::Cursor TextModel::advance(TextModel::Cursor src, int32_t offset) cons
           break;
         }
       }
-    return cursorCast(std::distance(txt.data(),str));
+    return cursorCast(b+size_t(str-begin));
     }
   }
 
 void TextModel::setFont(const Font &f) {
   fnt      =f;
   sz.actual=false;
+  widthsOk =false;
   }
 
 const Font& TextModel::font() const {
@@ -219,7 +307,7 @@ Size TextModel::wrapSize() const {
   }
 
 bool TextModel::isEmpty() const {
-  return txt.size()<=1;
+  return size()==0;
   }
 
 void TextModel::paint(Painter& p, const Color& color, int x, int y) const {
@@ -227,97 +315,77 @@ void TextModel::paint(Painter& p, const Color& color, int x, int y) const {
   }
 
 void TextModel::paint(Painter &p, const Font& fnt, const Color& color, int fx, int fy) const {
-  float x = float(fx);
-  float y = float(fy);
-
-  auto pb=p.brush();
-  Utf8Iterator i(txt.data());
-  while(i.hasData()) {
-    auto ch=i.next();
-    if(ch=='\0'){
-      p.setBrush(pb);
-      return;
-      }
-    if(ch=='\n'){
-      x =  0;
-      y += fnt.pixelSize();
-      continue;
-      }
-
-    auto l=fnt.letter(ch,p);
-    if(!l.view.isEmpty()) {
-      p.setBrush(Brush(l.view,color,PaintDevice::Alpha));
-      p.drawRect(int(x+l.dpos.x),int(y+l.dpos.y),l.view.w(),l.view.h());
-      }
+  const size_t count = lineCount();
+  if(count==0)
+    return;
 
-    x += l.advance.x;
+  // only lines inside of scissor, with same spacing as in TextLayout
+  const int    lnH   = std::max(1,int(std::ceil(fnt.pixelSize())));
+  const Rect   sc    = p.scissor();
+  const size_t first = sc.y>fy ? size_t((sc.y-fy)/lnH) : 0;
+  const size_t last  = sc.y+sc.h>fy ? std::min(count,size_t((sc.y+sc.h-fy)/lnH)+2) : 0;
+
+  auto pb = p.brush();
+  auto pf = p.font();
+  p.setBrush(color);
+  p.setFont(fnt);
+  std::string ln;
+  for(size_t i=first; i<last; ++i) {
+    fetchLine(i,ln);
+    p.drawText(fx,fy+int(i)*lnH,ln);
     }
+  p.setFont(pf);
   p.setBrush(pb);
   }
 
+float TextModel::lineWidth(size_t ln) const {
+  // shaped, same as paint() draws it
+  std::string      str;
+  std::vector<int> adv;
+  fetchLine(ln,str);
+  TextLayout::advances(fnt,str,adv);
+  int x = 0;
+  for(auto i:adv)
+    x += i;
+  return float(x);
+  }
+
 void TextModel::calcSize() const {
   sz = calcSize(fnt);
   }
 
 TextModel::Sz TextModel::calcSize(const Font& fnt) const {
-  float x=0, w=0;
-  int   y=0, top=0;
+  const size_t count = lineCount();
+  if(!widthsOk) {
+    std::vector<float> w(count);
+    for(size_t i=0; i<count; ++i)
+      w[i] = lineWidth(i);
+    lineW.clear();
+    lineW.replace(0,0,w.data(),w.size());
+    widthsOk = true;
+    }
 
-  Utf8Iterator i(txt.data());
-  while(i.hasData()){
-    char32_t ch = i.next();
-    if(ch=='\n'){
-      w = std::max(w,x);
-      x = 0;
-      y = 0;
-      top+=int(fnt.pixelSize());
-      } else {
-      auto l=fnt.letterGeometry(ch);
-      x += l.advance.x;
-      y =  std::max(-l.dpos.y,y);
+  // height of letters on last line
+  int y = 0;
+  if(count>0) {
+    std::string str;
+    fetchLine(count-1,str);
+    Utf8Iterator i(str.data(),str.size());
+    while(i.hasData()) {
+      auto l = fnt.letterGeometry(i.next());
+      y = std::max(-l.dpos.y,y);
       }
     }
-  w = std::max(w,x);
 
+  const int top = count>1 ? int(count-1)*int(fnt.pixelSize()) : 0;
   Sz sz;
   sz.wrapHeight=y+top;
-  sz.sizeHint  =Size(int(std::ceil(w)),top+int(fnt.pixelSize()));
+  sz.sizeHint  =Size(int(std::ceil(lineW.max())),top+int(fnt.pixelSize()));
   return sz;
   }
 
-void TextModel::buildIndex() {
-  if(txt.size()==0) {
-    line.clear();
-    return;
-    }
-
-  size_t count=0;
-  for(auto c:txt)
-    if(c=='\n')
-      count++;
-  line.resize(count+1);
-
-  size_t beg=0;
-  size_t ln =0;
-  Utf8Iterator i(txt.data());
-  while(i.hasData()){
-    char32_t ch = i.next();
-    if(ch=='\n') {
-      size_t ipos=i.pos();
-      line[ln].txt  = &txt[beg];
-      line[ln].size = ipos-1-beg;
-
-      beg=ipos;
-      ln++;
-      }
-    }
-
-  line[ln].txt  = txt.data()+beg;
-  line[ln].size = txt.size()-beg-1;
-  }
-
 TextModel::Cursor TextModel::charAt(int x, int y) const {
-  if(line.size()==0) {
+  if(lineCount()==0) {
     Cursor c;
     c.line   = 0;
     c.offset = 0;
@@ -330,41 +398,51 @@ TextModel::Cursor TextModel::charAt(int x, int y) const {
     x=0;
   Cursor c;
   c.line   = size_t(y/fnt.pixelSize());
-  if(c.line>=line.size())
-    c.line=line.size()-1;
-
-  auto& ln = line[c.line];
-  Utf8Iterator i(ln.txt,ln.size);
+  if(c.line>=lineCount())
+    c.line=lineCount()-1;
+
+  std::string      ln;
+  std::vector<int> adv;
+  fetchLine(c.line,ln);
+  TextLayout::advances(fnt,ln,adv);
+  Utf8Iterator i(ln.data(),ln.size());
   int    px      = 0;
   size_t prevPos = 0;
   while(i.hasData()){
     prevPos = i.pos();
-    char32_t ch = i.next();
-    auto l=fnt.letterGeometry(ch);
-    if(px<=x && x<=px+l.advance.x) {
-      if(x<=px+l.advance.x/2)
+    i.next();
+    int w = 0;
+    for(size_t k=prevPos; k<i.pos(); ++k)
+      w += adv[k];
+    if(px<=x && x<=px+w) {
+      if(x<=px+w/2)
         c.offset = prevPos; else
         c.offset = i.pos();
       return c;
       }
-    px += l.advance.x;
+    px += w;
     }
-  c.offset = ln.size;
+  c.offset = ln.size();
   return c;
   }
 
 TextModel::Cursor TextModel::charAt(size_t symbol) const {
-  Cursor c;
-  c.line = 0;
-  for(auto& l:line) {
-    if(symbol<=l.size) {
-      c.offset = symbol;
-      return c;
-      }
-    symbol -= l.size;
-    c.line++;
+  // symbols are counted without line breaks: first line, that ends at or after symbol
+  const size_t count = lineCount();
+  size_t b = 0, e = count;
+  while(b<e) {
+    size_t m   = (b+e)/2;
+    size_t end = lineStart(m)+lineSize(m)-m;
+    if(symbol<=end)
+      e = m; else
+      b = m+1;
     }
-  c.offset = symbol;
+
+  Cursor c;
+  c.line   = b;
+  if(b<count)
+    c.offset = symbol-(lineStart(b)-b); else
+    c.offset = symbol-(size()-(count>0 ? count-1 : 0));
   return c;
   }
 
@@ -373,71 +451,438 @@ Point TextModel::mapToCoords(Cursor c) const {
     return Point();
   Point p;
   p.y = int(c.line*fnt.pixelSize());
-  auto& ln = line[c.line];
 
-  Utf8Iterator str(ln.txt,ln.size);
-  while(str.hasData() && str.pos()<c.offset){
-    char32_t ch = str.next();
-    auto l=fnt.letterGeometry(ch);
-    p.x += l.advance.x;
-    }
+  // whole line is shaped: kerning with the letter after cursor counts too
+  std::string      ln;
+  std::vector<int> adv;
+  fetchLine(c.line,ln);
+  TextLayout::advances(fnt,ln,adv);
+  for(size_t i=0; i<c.offset && i<adv.size(); ++i)
+    p.x += adv[i];
   return p;
   }
 
 const char* TextModel::c_str() const {
-  if(txt.size()==0)
+  if(!hasText)
     return "";
-  return txt.data();
+  if(!flatOk) {
+    flat.resize(size());
+    if(flat.size()>0)
+      read(0,flat.size(),&flat[0]);
+    flatOk = true;
+    }
+  return flat.c_str();
   }
 
 size_t TextModel::size() const {
-  if(txt.size()==0)
+  if(root==Piece::npos)
     return 0;
-  return txt.size()-1;
+  return pieces[root].sumLen;
   }
 
 bool TextModel::isValid(TextModel::Cursor c) const {
-  if(c.line>=line.size())
+  if(c.line>=lineCount())
     return false;
-  return c.offset<=line[c.line].size;
+  return c.offset<=lineSize(c.line);
   }
 
 TextModel::Cursor TextModel::clamp(const TextModel::Cursor& c) const {
   Cursor r;
-  if(line.size()==0) {
+  if(lineCount()==0) {
     r.line   = 0;
     r.offset = 0;
     return r;
     }
-  r.line   = std::max<size_t>(0,std::min<size_t>(c.line,line.size()-1));
-  r.offset = std::max<size_t>(0,std::min<size_t>(c.offset,line[r.offset].size));
+  r.line   = std::min<size_t>(c.line,lineCount()-1);
+  r.offset = std::min<size_t>(c.offset,lineSize(r.line));
   return r;
   }
 
 size_t TextModel::cursorCast(Cursor c) const {
-  if(line.size()==0)
+  if(lineCount()==0)
     return 0;
-  size_t r=std::distance(txt.data(),line[c.line].txt);
-  return r+c.offset;
+  return lineStart(c.line)+c.offset;
   }
 
 TextModel::Cursor TextModel::cursorCast(size_t c) const {
   Cursor cx;
-  for(size_t i=0;i<line.size();++i) {
-    size_t b = std::distance(txt.data(),line[i].txt);
+  if(lineCount()==0 || c>size())
+    return cx;
+  cx.line   = newLines(c);
+  cx.offset = c-lineStart(cx.line);
+  return cx;
+  }
 
-    if(b<=c && c<=b+line[i].size) {
-      cx.line   = i;
-      cx.offset = c-b;
-      return cx;
+size_t TextModel::lineCount() const {
+  if(!hasText)
+    return 0;
+  return (root==Piece::npos ? 0 : pieces[root].sumNl)+1;
+  }
+
+size_t TextModel::lineStart(size_t ln) const {
+  if(ln==0)
+    return 0;
+  // position after ln-th line break
+  size_t   base = 0;
+  uint32_t t    = root;
+  while(t!=Piece::npos) {
+    const Piece& p  = pieces[t];
+    const size_t nl = p.left==Piece::npos ? 0 : pieces[p.left].sumNl;
+    if(ln<=nl) {
+      t = p.left;
+      continue;
       }
+    ln   -= nl;
+    base += p.left==Piece::npos ? 0 : pieces[p.left].sumLen;
+    if(ln<=p.nl) {
+      auto& b = bufferOf(p);
+      auto  i = std::lower_bound(b.nl.begin(),b.nl.end(),p.start);
+      return base+(i[ptrdiff_t(ln-1)]-p.start)+1;
+      }
+    ln   -= p.nl;
+    base += p.len;
+    t     = p.right;
+    }
+  return size();
+  }
+
+size_t TextModel::lineSize(size_t ln) const {
+  const size_t b = lineStart(ln);
+  if(ln+1<lineCount())
+    return lineStart(ln+1)-1-b;
+  return size()-b;
+  }
+
+void TextModel::fetchLine(size_t ln, std::string& out) const {
+  const size_t b = lineStart(ln);
+  out.resize(lineSize(ln));
+  if(out.size()>0)
+    read(b,b+out.size(),&out[0]);
+  }
+
+size_t TextModel::newLines(size_t pos) const {
+  // line breaks before pos
+  size_t   ret = 0;
+  uint32_t t   = root;
+  while(t!=Piece::npos) {
+    const Piece& p  = pieces[t];
+    const size_t ls = p.left==Piece::npos ? 0 : pieces[p.left].sumLen;
+    if(pos<ls) {
+      t = p.left;
+      continue;
+      }
+    ret += p.left==Piece::npos ? 0 : pieces[p.left].sumNl;
+    pos -= ls;
+    if(pos<p.len)
+      return ret+countNl(p,p.start,p.start+pos);
+    ret += p.nl;
+    pos -= p.len;
+    t    = p.right;
+    }
+  return ret;
+  }
+
+void TextModel::read(size_t s, size_t e, char* out) const {
+  read(root,s,e,out);
+  }
+
+void TextModel::read(uint32_t t, size_t s, size_t e, char*& out) const {
+  // [s,e) relative to subtree
+  if(t==Piece::npos || s>=e)
+    return;
+  const Piece& p  = pieces[t];
+  const size_t ls = p.left==Piece::npos ? 0 : pieces[p.left].sumLen;
+  if(s<ls)
+    read(p.left,s,std::min(e,ls),out);
+  if(s<ls+p.len && e>ls) {
+    const size_t b = std::max(s,ls)-ls;
+    const size_t n = std::min(e,ls+p.len)-ls-b;
+    std::memcpy(out,bufferOf(p).txt.data()+p.start+b,n);
+    out += n;
+    }
+  if(e>ls+p.len)
+    read(p.right,s>ls+p.len ? s-ls-p.len : 0,e-ls-p.len,out);
+  }
+
+size_t TextModel::countNl(const Piece& p, size_t begin, size_t end) const {
+  auto& nl = bufferOf(p).nl;
+  auto  b  = std::lower_bound(nl.begin(),nl.end(),begin);
+  auto  e  = std::lower_bound(b,nl.end(),end);
+  return size_t(std::distance(b,e));
+  }
+
+uint32_t TextModel::mkPiece(bool added, size_t start, size_t len) {
+  // xorshift, balance of treap doesn't need better random
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+
+  Piece p;
+  p.prio  = seed;
+  p.added = added;
+  p.start = start;
+  p.len   = len;
+  p.nl    = countNl(p,start,start+len);
+
+  uint32_t id = 0;
+  if(!freeList.empty()) {
+    id = freeList.back();
+    freeList.pop_back();
+    pieces[id] = p;
+    } else {
+    id = uint32_t(pieces.size());
+    pieces.push_back(p);
+    }
+  update(id);
+  return id;
+  }
+
+void TextModel::freePieces(uint32_t t) {
+  if(t==Piece::npos)
+    return;
+  freePieces(pieces[t].left);
+  freePieces(pieces[t].right);
+  freeList.push_back(t);
+  }
+
+void TextModel::update(uint32_t t) {
+  Piece& p = pieces[t];
+  p.sumLen = p.len;
+  p.sumNl  = p.nl;
+  if(p.left!=Piece::npos) {
+    p.sumLen += pieces[p.left].sumLen;
+    p.sumNl  += pieces[p.left].sumNl;
+    }
+  if(p.right!=Piece::npos) {
+    p.sumLen += pieces[p.right].sumLen;
+    p.sumNl  += pieces[p.right].sumNl;
+    }
+  }
+
+uint32_t TextModel::merge(uint32_t a, uint32_t b) {
+  if(a==Piece::npos)
+    return b;
+  if(b==Piece::npos)
+    return a;
+  if(pieces[a].prio>pieces[b].prio) {
+    uint32_t r = merge(pieces[a].right,b);
+    pieces[a].right = r;
+    update(a);
+    return a;
+    }
+  uint32_t l = merge(a,pieces[b].left);
+  pieces[b].left = l;
+  update(b);
+  return b;
+  }
+
+void TextModel::split(uint32_t t, size_t pos, uint32_t& l, uint32_t& r) {
+  // l gets first pos bytes of text
+  if(t==Piece::npos) {
+    l = Piece::npos;
+    r = Piece::npos;
+    return;
+    }
+  const size_t ls  = pieces[t].left==Piece::npos ? 0 : pieces[pieces[t].left].sumLen;
+  const size_t len = pieces[t].len;
+  if(pos<=ls) {
+    uint32_t ll = Piece::npos, lr = Piece::npos;
+    split(pieces[t].left,pos,ll,lr);
+    pieces[t].left = lr;
+    update(t);
+    l = ll;
+    r = t;
+    return;
+    }
+  if(pos>=ls+len) {
+    uint32_t rl = Piece::npos, rr = Piece::npos;
+    split(pieces[t].right,pos-ls-len,rl,rr);
+    pieces[t].right = rl;
+    update(t);
+    l = t;
+    r = rr;
+    return;
+    }
+
+  // inside of piece: tail goes to new piece
+  const size_t k    = pos-ls;
+  const uint32_t tl = mkPiece(pieces[t].added,pieces[t].start+k,len-k);
+  const uint32_t rt = pieces[t].right;
+  pieces[t].len   = k;
+  pieces[t].nl    = countNl(pieces[t],pieces[t].start,pieces[t].start+k);
+  pieces[t].right = Piece::npos;
+  update(t);
+  l = t;
+  r = merge(tl,rt);
+  }
+
+bool TextModel::extendLast(uint32_t t, size_t start, size_t len) {
+  // typing appends to the piece, that was added by previous insert
+  if(t==Piece::npos)
+    return false;
+  Piece& p = pieces[t];
+  if(p.right!=Piece::npos) {
+    if(!extendLast(p.right,start,len))
+      return false;
+    update(t);
+    return true;
+    }
+  if(!p.added || p.start+p.len!=start)
+    return false;
+  p.len += len;
+  p.nl   = countNl(p,p.start,p.start+p.len);
+  update(t);
+  return true;
+  }
+
+void TextModel::implInsert(size_t at, const char* t, size_t len) {
+  if(len==0)
+    return;
+  const size_t start = add.txt.size();
+  add.txt.append(t,len);
+  for(size_t i=0; i<len; ++i)
+    if(t[i]=='\n')
+      add.nl.push_back(start+i);
+
+  uint32_t l = Piece::npos, r = Piece::npos;
+  split(root,at,l,r);
+  if(!extendLast(l,start,len))
+    l = merge(l,mkPiece(true,start,len));
+  root   = merge(l,r);
+  flatOk = false;
+  }
+
+void TextModel::implErase(size_t s, size_t e) {
+  if(s>=e)
+    return;
+  uint32_t l = Piece::npos, m = Piece::npos, r = Piece::npos;
+  split(root,s,l,r);
+  split(r,e-s,m,r);
+  freePieces(m);
+  root   = merge(l,r);
+  flatOk = false;
+  }
+
+void TextModel::implEdited(size_t ln, size_t removed, size_t added) {
+  sz.actual = false;
+  if(!widthsOk)
+    return;
+  // lines [ln,ln+removed] became [ln,ln+added]
+  std::vector<float> w(added+1);
+  for(size_t i=0; i<=added; ++i)
+    w[i] = lineWidth(ln+i);
+  lineW.replace(ln,removed+1,w.data(),w.size());
+  }
+
+void TextModel::LineWidths::clear() {
+  nodes.clear();
+  freeList.clear();
+  root = Piece::npos;
+  }
+
+void TextModel::LineWidths::replace(size_t ln, size_t removed, const float* w, size_t added) {
+  uint32_t l = Piece::npos, m = Piece::npos, r = Piece::npos;
+  split(root,ln,l,r);
+  split(r,removed,m,r);
+  freeNodes(m);
+  for(size_t i=0; i<added; ++i)
+    l = merge(l,mkNode(w[i]));
+  root = merge(l,r);
+  }
+
+float TextModel::LineWidths::max() const {
+  return root==Piece::npos ? 0.f : nodes[root].maxW;
+  }
+
+uint32_t TextModel::LineWidths::mkNode(float w) {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+
+  Node n;
+  n.prio = seed;
+  n.w    = w;
+
+  uint32_t id = 0;
+  if(!freeList.empty()) {
+    id = freeList.back();
+    freeList.pop_back();
+    nodes[id] = n;
+    } else {
+    id = uint32_t(nodes.size());
+    nodes.push_back(n);
+    }
+  update(id);
+  return id;
+  }
+
+void TextModel::LineWidths::freeNodes(uint32_t t) {
+  if(t==Piece::npos)
+    return;
+  freeNodes(nodes[t].left);
+  freeNodes(nodes[t].right);
+  freeList.push_back(t);
+  }
+
+void TextModel::LineWidths::update(uint32_t t) {
+  Node& n = nodes[t];
+  n.maxW  = n.w;
+  n.count = 1;
+  if(n.left!=Piece::npos) {
+    n.maxW   = std::max(n.maxW,nodes[n.left].maxW);
+    n.count += nodes[n.left].count;
+    }
+  if(n.right!=Piece::npos) {
+    n.maxW   = std::max(n.maxW,nodes[n.right].maxW);
+    n.count += nodes[n.right].count;
+    }
+  }
+
+uint32_t TextModel::LineWidths::merge(uint32_t a, uint32_t b) {
+  if(a==Piece::npos)
+    return b;
+  if(b==Piece::npos)
+    return a;
+  if(nodes[a].prio>nodes[b].prio) {
+    uint32_t r = merge(nodes[a].right,b);
+    nodes[a].right = r;
+    update(a);
+    return a;
+    }
+  uint32_t l = merge(a,nodes[b].left);
+  nodes[b].left = l;
+  update(b);
+  return b;
+  }
+
+void TextModel::LineWidths::split(uint32_t t, size_t ln, uint32_t& l, uint32_t& r) {
+  // l gets first ln lines
+  if(t==Piece::npos) {
+    l = Piece::npos;
+    r = Piece::npos;
+    return;
+    }
+  const size_t ls = nodes[t].left==Piece::npos ? 0 : nodes[nodes[t].left].count;
+  if(ln<=ls) {
+    uint32_t ll = Piece::npos, lr = Piece::npos;
+    split(nodes[t].left,ln,ll,lr);
+    nodes[t].left = lr;
+    update(t);
+    l = ll;
+    r = t;
+    } else {
+    uint32_t rl = Piece::npos, rr = Piece::npos;
+    split(nodes[t].right,ln-ls-1,rl,rr);
+    nodes[t].right = rl;
+    update(t);
+    l = t;
+    r = rr;
     }
-  return cx;
   }
 
 void TextModel::drawCursor(Painter& p, int x, int y,TextModel::Cursor c) const {
   if(!isValid(c) &&
-     !(txt.size()==0 && c.line==0 && c.offset==0))
+     !(size()==0 && c.line==0 && c.offset==0))
     return;
 
   auto pos = mapToCoords(c)+Point(x,y);
@@ -457,7 +902,7 @@ void TextModel::drawCursor(Painter &p, int x, int y, Cursor s, Cursor e) const {
   if(s.line>e.line)
     std::swap(s,e);
   Cursor s1 = s;
-  s1.offset = line[s.line].size;
+  s1.offset = lineSize(s.line);
 
   int lnH = int(fnt.pixelSize());
   if(s.line!=e.line) {
@@ -467,10 +912,19 @@ void TextModel::drawCursor(Painter &p, int x, int y, Cursor s, Cursor e) const {
 
     p.drawRect(x+posS0.x,y+posS0.y,posS1.x-posS0.x,lnH);
     p.drawRect(x,        y+posE.y,posE.x,          lnH);
-    for(size_t ln=s.line+1;ln<e.line;++ln) {
+
+    // lines in between, that are visible
+    const Rect sc    = p.scissor();
+    size_t     first = s.line+1;
+    size_t     last  = e.line;
+    if(lnH>0 && sc.y>y)
+      first = std::max(first,size_t((sc.y-y)/lnH));
+    if(lnH>0)
+      last  = std::min(last,sc.y+sc.h>y ? size_t((sc.y+sc.h-y)/lnH)+1 : 0);
+    for(size_t ln=first;ln<last;++ln) {
       Cursor cx;
       cx.line   = ln;
-      cx.offset = line[ln].size;
+      cx.offset = lineSize(ln);
       auto posLn = mapToCoords(cx);
       p.drawRect(x,y+posLn.y,posLn.x,lnH);
       }
@@ -62,19 +62,24 @@ class TextModel final {
     class CommandInsert : public Command {
       public:
         CommandInsert(const char* txt,Cursor where);
-        void redo(TextModel &subj) override;
-        void undo(TextModel &subj) override;
+        void   redo(TextModel &subj) override;
+        void   undo(TextModel &subj) override;
+        bool   mergeWith(const Command& next) override;
+        size_t memoryUsage() const override;
       private:
         Cursor      where;
         std::string txt;
         char        txtShort[3]={};
+
+        const char* text() const { return txtShort[0]=='\0' ? txt.data() : txtShort; }
       };
 
     class CommandReplace : public Command {
       public:
         CommandReplace(const char* txt,Cursor beg,Cursor end);
-        void redo(TextModel &subj) override;
-        void undo(TextModel &subj) override;
+        void   redo(TextModel &subj) override;
+        void   undo(TextModel &subj) override;
+        size_t memoryUsage() const override;
       private:
         Cursor      begin;
         Cursor      end;
@@ -87,8 +92,10 @@ class TextModel final {
     class CommandErase : public Command {
       public:
         CommandErase(Cursor beg,Cursor end);
-        void redo(TextModel &subj) override;
-        void undo(TextModel &subj) override;
+        void   redo(TextModel &subj) override;
+        void   undo(TextModel &subj) override;
+        bool   mergeWith(const Command& next) override;
+        size_t memoryUsage() const override;
       private:
         Cursor      begin;
         Cursor      end;
@@ -139,22 +146,105 @@ class TextModel final {
       bool actual=false;
       };
 
-    struct Line {
-      const char* txt =nullptr;
-      size_t      size=0;
+    // piece of text in one of buffers, node of treap ordered by position in text
+    struct Piece {
+      static constexpr uint32_t npos = uint32_t(-1);
+
+      uint32_t left   = npos;
+      uint32_t right  = npos;
+      uint32_t prio   = 0;
+      bool     added  = false;
+      size_t   start  = 0;
+      size_t   len    = 0;
+      size_t   nl     = 0;
+      // whole subtree
+      size_t   sumLen = 0;
+      size_t   sumNl  = 0;
+      };
+
+    // width of every line: implicit treap by line number, with max width of subtree
+    class LineWidths {
+      public:
+        void   clear();
+        // lines [ln,ln+removed) are replaced by 'added' lines of width w
+        void   replace(size_t ln, size_t removed, const float* w, size_t added);
+        float  max()  const;
+
+      private:
+        struct Node {
+          uint32_t left  = Piece::npos;
+          uint32_t right = Piece::npos;
+          uint32_t prio  = 0;
+          float    w     = 0;
+          // whole subtree
+          float    maxW  = 0;
+          size_t   count = 1;
+          };
+
+        uint32_t mkNode(float w);
+        void     freeNodes(uint32_t t);
+        void     update(uint32_t t);
+        uint32_t merge(uint32_t a, uint32_t b);
+        void     split(uint32_t t, size_t ln, uint32_t& l, uint32_t& r);
+
+        std::vector<Node>     nodes;
+        std::vector<uint32_t> freeList;
+        uint32_t              root = Piece::npos;
+        uint32_t              seed = 0x2545F491;
+      };
+
+    // text is never moved: edits append to 'add' and change only pieces
+    struct Buffer {
+      std::string         txt;
+      // positions of '\n'
+      std::vector<size_t> nl;
       };
 
     size_t      cursorCast(Cursor c) const;
     Cursor      cursorCast(size_t c) const;
 
+    size_t      lineCount() const;
+    size_t      lineStart(size_t ln) const;
+    size_t      lineSize (size_t ln) const;
+    void        fetchLine(size_t ln, std::string& out) const;
+    void        read(size_t s, size_t e, char* out) const;
+    void        read(uint32_t t, size_t s, size_t e, char*& out) const;
+    size_t      newLines(size_t pos) const;
+
+    const Buffer& bufferOf(const Piece& p) const { return p.added ? add : orig; }
+    size_t      countNl(const Piece& p, size_t begin, size_t end) const;
+    uint32_t    mkPiece(bool added, size_t start, size_t len);
+    void        freePieces(uint32_t t);
+    void        update(uint32_t t);
+    uint32_t    merge(uint32_t a, uint32_t b);
+    void        split(uint32_t t, size_t pos, uint32_t& l, uint32_t& r);
+    bool        extendLast(uint32_t t, size_t start, size_t len);
+
+    void        implInsert(size_t at, const char* t, size_t len);
+    void        implErase (size_t s, size_t e);
+    void        implEdited(size_t ln, size_t removed, size_t added);
+
+    float       lineWidth(size_t ln) const;
     void        calcSize() const;
     Sz          calcSize(const Font& fnt) const;
-    void        buildIndex();
 
-    mutable Sz        sz;
-    std::vector<char> txt;
-    std::vector<Line> line;
-    Tempest::Font     fnt;
+    mutable Sz            sz;
+    bool                  hasText = false;
+    Buffer                orig, add;
+    std::vector<Piece>    pieces;
+    std::vector<uint32_t> freeList;
+    uint32_t              root = Piece::npos;
+    uint32_t              seed = 0x9E3779B9;
+
+    // width of every line, while it is known
+    mutable LineWidths    lineW;
+    mutable bool          widthsOk = false;
+
+    // c_str() of text, made on demand
+    mutable std::string   flat;
+    mutable bool          flatOk = false;
+
+    Tempest::Font         fnt;
   };
 
 }
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <memory>
+#include <functional>
 
 namespace Tempest {
 
@@ -15,47 +16,122 @@ class UndoStack {
       public:
         virtual ~Command()=default;
 
-        virtual void redo(Subject& subj)=0;
-        virtual void undo(Subject& subj)=0;
+        virtual void   redo(Subject& subj)=0;
+        virtual void   undo(Subject& subj)=0;
+
+        // absorb next command, that is already done, into this one: typing of a word becomes one step
+        virtual bool   mergeWith(const Command& /*next*/) { return false; }
+        // bytes, that are held by command, for UndoStack::setMemoryLimit
+        virtual size_t memoryUsage() const { return sizeof(Command); }
       };
 
+    // extra condition for merge of commands, on top of Command::mergeWith
+    using MergeRule = std::function<bool(const Command& prev, const Command& next)>;
+
     void   push(Subject& subj,Command* cmd);
     void   undo(Subject& subj);
     void   redo(Subject& subj);
 
+    // commands, that are pushed in between, are undone as one step
+    void   beginTransaction();
+    void   endTransaction();
+
+    // next command is never merged with previous one
+    void   breakMerge() { mergeOk = false; }
+    void   setMergeRule(MergeRule rule) { mergeRule = std::move(rule); }
+
     void   setMaxDepth(size_t d);
     size_t maxDepth() const;
 
+    // oldest commands are dropped, when memory of stack goes over limit
+    void   setMemoryLimit(size_t bytes);
+    size_t memoryLimit() const { return memLim; }
+    size_t memoryUsage() const { return memUsed; }
+
+    size_t depth() const { return count; }
+
   private:
-    std::vector<std::unique_ptr<Command>> stk, undoStk;
+    class Group : public Command {
+      public:
+        void redo(Subject& subj) override {
+          for(auto& i:cmd)
+            i->redo(subj);
+          }
+        void undo(Subject& subj) override {
+          for(size_t i=cmd.size(); i>0; --i)
+            cmd[i-1]->undo(subj);
+          }
+        size_t memoryUsage() const override {
+          size_t sz = sizeof(*this) + cmd.capacity()*sizeof(cmd[0]);
+          for(auto& i:cmd)
+            sz += i->memoryUsage();
+          return sz;
+          }
+
+        std::vector<std::unique_ptr<Command>> cmd;
+      };
+
+    // ring buffer of done commands: oldest are dropped in O(1)
+    std::vector<std::unique_ptr<Command>> ring;
+    size_t                                first=0, count=0;
+    std::vector<std::unique_ptr<Command>> undoStk;
+
+    std::unique_ptr<Group>                group;
+    size_t                                groupDepth=0;
+
+    MergeRule                             mergeRule;
+    bool                                  mergeOk=false;
+
     size_t                                depthLim=size_t(-1);
+    size_t                                memLim  =size_t(-1);
+    size_t                                memUsed =0;
+
+    std::unique_ptr<Command>& at(size_t i) { return ring[(first+i)%ring.size()]; }
+    bool   implMerge(Command& prev, const Command& next);
+    void   implAppend(std::unique_ptr<Command>&& cmd);
+    void   implTrim();
   };
 
 template<class Subject>
 void UndoStack<Subject>::push(Subject& subj, Command* cmd) {
-  stk.push_back(std::unique_ptr<Command>(cmd));
-  try {
-    stk.back()->redo(subj);
-    undoStk.clear();
-    if(stk.size()>depthLim)
-      stk.erase(stk.begin(),stk.begin()+int(stk.size()-depthLim));
+  std::unique_ptr<Command> c(cmd);
+  c->redo(subj);
+  undoStk.clear();
+
+  if(group!=nullptr) {
+    auto& g = group->cmd;
+    if(g.empty() || !implMerge(*g.back(),*c))
+      g.push_back(std::move(c));
+    mergeOk = true;
+    return;
     }
-  catch(...){
-    stk.pop_back();
-    throw;
+
+  if(count>0) {
+    Command&     top  = *at(count-1);
+    const size_t prev = top.memoryUsage();
+    if(implMerge(top,*c)) {
+      memUsed = memUsed - prev + top.memoryUsage();
+      implTrim();
+      return;
+      }
     }
+  implAppend(std::move(c));
+  mergeOk = true;
   }
 
 template<class Subject>
 void UndoStack<Subject>::undo(Subject& subj) {
-  if(stk.size()==0)
+  if(count==0 || group!=nullptr)
     return;
 
-  stk.back()->undo(subj);
-  auto ptr = std::move(stk.back());
+  auto& top = at(count-1);
+  top->undo(subj);
+  mergeOk = false;
+  auto ptr = std::move(top);
+  --count;
+  memUsed -= ptr->memoryUsage();
   try {
     undoStk.push_back(std::move(ptr));
-    stk.pop_back();
     }
   catch(...){
     // undoStk not consistent anymore
@@ -67,30 +143,92 @@ void UndoStack<Subject>::undo(Subject& subj) {
 
 template<class Subject>
 void UndoStack<Subject>::redo(Subject& subj) {
-  if(undoStk.size()==0)
+  if(undoStk.size()==0 || group!=nullptr)
     return;
 
-  stk.push_back(nullptr);
-  try {
-    undoStk.back()->redo(subj);
-    }
-  catch(...) {
-    stk.pop_back();
-    throw;
-    }
-  stk.back() = std::move(undoStk.back());
+  undoStk.back()->redo(subj);
+  mergeOk = false;
+  auto ptr = std::move(undoStk.back());
   undoStk.pop_back();
+  implAppend(std::move(ptr));
+  }
+
+template<class Subject>
+void UndoStack<Subject>::beginTransaction() {
+  if(groupDepth==0)
+    group.reset(new Group());
+  ++groupDepth;
+  }
+
+template<class Subject>
+void UndoStack<Subject>::endTransaction() {
+  if(groupDepth==0)
+    return;
+  --groupDepth;
+  if(groupDepth>0)
+    return;
+
+  std::unique_ptr<Group> g = std::move(group);
+  mergeOk = false;
+  if(g->cmd.empty())
+    return;
+  if(g->cmd.size()==1) {
+    implAppend(std::move(g->cmd[0]));
+    return;
+    }
+  implAppend(std::move(g));
   }
 
 template<class Subject>
 void UndoStack<Subject>::setMaxDepth(size_t d) {
   depthLim = d;
-  if(stk.size()>depthLim)
-    stk.erase(stk.begin(),stk.begin()+int(stk.size()-depthLim));
+  implTrim();
   }
 
 template<class Subject>
 size_t UndoStack<Subject>::maxDepth() const {
   return depthLim;
   }
+
+template<class Subject>
+void UndoStack<Subject>::setMemoryLimit(size_t bytes) {
+  memLim = bytes;
+  implTrim();
+  }
+
+template<class Subject>
+bool UndoStack<Subject>::implMerge(Command& prev, const Command& next) {
+  if(!mergeOk)
+    return false;
+  if(mergeRule && !mergeRule(prev,next))
+    return false;
+  return prev.mergeWith(next);
+  }
+
+template<class Subject>
+void UndoStack<Subject>::implAppend(std::unique_ptr<Command>&& cmd) {
+  if(count==ring.size()) {
+    std::vector<std::unique_ptr<Command>> r(std::max<size_t>(16,ring.size()*2));
+    for(size_t i=0; i<count; ++i)
+      r[i] = std::move(at(i));
+    ring  = std::move(r);
+    first = 0;
+    }
+  memUsed += cmd->memoryUsage();
+  at(count) = std::move(cmd);
+  ++count;
+  implTrim();
+  }
+
+template<class Subject>
+void UndoStack<Subject>::implTrim() {
+  // last command stays, even if it doesn't fit into memory limit
+  while(count>depthLim || (memUsed>memLim && count>1)) {
+    auto& c = at(0);
+    memUsed -= c->memoryUsage();
+    c.reset();
+    first = (first+1)%ring.size();
+    --count;
+    }
+  }
 }
@@ -1,6 +1,8 @@
 #include "widget.h"
+#include "hitindex.h"
 
 #include <Tempest/Layout>
+#include <Tempest/PaintDevice>
 #include <Tempest/Application>
 #include <Tempest/UiOverlay>
 #include <Tempest/Window>
@@ -81,14 +83,12 @@ Widget::~Widget() {
     iterator->onDelete();
   removeAllWidgets();
   freeLayout();
+  delete hit;
   }
 
-void Widget::setLayout(Orientation ori) noexcept {
-  static_assert(sizeof(LinearLayout)<=sizeof(layBuf),"layBuf is too small");
-  freeLayout();
-  new(layBuf) LinearLayout(ori);
-  lay=reinterpret_cast<Layout*>(layBuf);
-  lay->bind(this);
+void Widget::setLayout(Orientation ori) {
+  // LinearLayout keeps measure cache of children: too large for inline buffer, that every widget pays for
+  setLayout(new LinearLayout(ori));
   }
 
 void Widget::setLayout(Layout *l) {
@@ -100,7 +100,30 @@ void Widget::setLayout(Layout *l) {
   }
 
 void Widget::applyLayout() {
-  lay->applyLayout();
+  ++layGen;
+  implLayout();
+  }
+
+void Widget::implLayout() {
+  if(astate.layBusy) {
+    astate.layDirty = true;
+    return;
+    }
+  astate.layBusy = true;
+  // children may change hints from resizeEvent; don't let it loop forever
+  for(int i=0; i<4; ++i) {
+    astate.layDirty = false;
+    lay->applyLayout();
+    if(!astate.layDirty)
+      break;
+    }
+  astate.layBusy  = false;
+  astate.layDirty = false;
+  }
+
+void Widget::implChildChanged() {
+  ++layGen;
+  implLayout();
   }
 
 void Widget::removeAllWidgets() {
@@ -109,6 +132,9 @@ void Widget::removeAllWidgets() {
     w->ow=nullptr;
 
   astate.focus = nullptr;
+  ++layGen;
+  if(hit!=nullptr)
+    hit->invalidate();
 
   for(auto& w:rm) {
     w->deleteLater();
@@ -133,6 +159,8 @@ void Widget::implDisableSum(Widget *root,int diff) noexcept {
   }
 
 void Widget::dispatchPaintEvent(PaintEvent& e) {
+  if(ow==nullptr)
+    dmg = Rect();
   paintEvent(e);
   paintNested(e);
   }
@@ -152,9 +180,19 @@ void Widget::paintNested(PaintEvent& e) {
     if(sc.isEmpty())
       continue;
 
-    PaintEvent ex(e,wx.x(),wx.y(),sc.x,sc.y,sc.w,sc.h);
+    PaintEvent            ex(e,wx.x(),wx.y(),sc.x,sc.y,sc.w,sc.h);
+    PaintDevice&          dev = e.device();
+    PaintDevice::RangeKey key = {&wx, ex.orign().x, ex.orign().y, sc.x, sc.y, sc.w, sc.h, e.w(), e.h()};
+    ex.movable  = e.movable || astate.moveRetained;
+    key.movable = ex.movable;
+    if(!wx.astate.needToUpdate && wx.astate.painted && dev.replayRange(key))
+      continue;
+
     wx.astate.needToUpdate = false;
+    wx.astate.painted      = true;
+    dev.beginRange(key);
     wx.dispatchPaintEvent(ex);
+    dev.endRange();
     }
   }
 
@@ -226,7 +264,9 @@ Widget& Widget::implAddWidget(Widget *w,size_t at) {
     astate.focus = w;
   if(astate.disable>0)
     implDisableSum(w,astate.disable);
-  lay->applyLayout();
+  if(hit!=nullptr)
+    hit->invalidate();
+  implChildChanged();
   update();
   return *w;
   }
@@ -241,6 +281,8 @@ Widget *Widget::takeWidget(Widget *w) {
     }
   if(astate.disable>0)
     implDisableSum(w,-astate.disable);
+  if(w->isVisible())
+    implDamage(w->rect());
   const size_t id=lay->find(w);
   if(iterator!=nullptr)
     iterator->onDelete(id,w);
@@ -275,8 +317,10 @@ void Widget::setPosition(int x, int y) {
   if(wrect.x==x && wrect.y==y)
     return;
 
+  const Rect prev = wrect;
   wrect.x = x;
   wrect.y = y;
+  implMoved(prev);
   update();
   }
 
@@ -288,11 +332,15 @@ void Widget::setGeometry(const Rect &rect) {
   if(wrect==rect)
     return;
   bool resize=(wrect.w!=rect.w || wrect.h!=rect.h);
+  const Rect prev = wrect;
   wrect=rect;
+  implMoved(prev);
   update();
 
   if(resize) {
-    lay->applyLayout();
+    // layout, that resizes own owner, takes new size into account itself
+    if(!astate.layBusy)
+      implLayout();
     SizeEvent e(uint32_t(rect.w),uint32_t(rect.h));
     resizeEvent( e );
     }
@@ -309,10 +357,13 @@ void Widget::resize(const Size &size) {
 void Widget::resize(int w, int h) {
   if(wrect.w==w && wrect.h==h)
     return;
+  const Rect prev = wrect;
   wrect.w=w;
   wrect.h=h;
+  implMoved(prev);
 
-  lay->applyLayout();
+  if(!astate.layBusy)
+    implLayout();
   SizeEvent e(w,h);
   resizeEvent( e );
   }
@@ -322,7 +373,7 @@ void Widget::setSizeHint(const Size &s) {
     return;
   szHint=s;
   if(ow!=nullptr)
-    ow->lay->applyLayout();
+    ow->implChildChanged();
   }
 
 void Widget::setSizeHint(const Size &s, const Margin &add) {
@@ -344,7 +395,7 @@ void Widget::setSizePolicy(SizePolicyType h, SizePolicyType v) {
   szPolicy.typeV=v;
 
   if(ow!=nullptr)
-    ow->lay->applyLayout();
+    ow->implChildChanged();
   }
 
 void Widget::setSizePolicy(const SizePolicy &sp) {
@@ -352,7 +403,7 @@ void Widget::setSizePolicy(const SizePolicy &sp) {
     return;
   szPolicy=sp;
   if(ow!=nullptr)
-    ow->lay->applyLayout();
+    ow->implChildChanged();
   }
 
 void Widget::setFocusPolicy(FocusPolicy f) {
@@ -362,14 +413,14 @@ void Widget::setFocusPolicy(FocusPolicy f) {
 void Widget::setMargins(const Margin &m) {
   if(marg!=m){
     marg=m;
-    lay->applyLayout();
+    implLayout();
     }
   }
 
 void Widget::setSpacing(int s) {
   if(s!=spa){
     spa=s;
-    lay->applyLayout();
+    implLayout();
     }
   }
 
@@ -380,7 +431,7 @@ void Widget::setMaximumSize(const Size &s) {
   szPolicy.maxSize = s;
 
   if( owner() )
-    owner()->applyLayout();
+    owner()->implChildChanged();
 
   if(wrect.w>s.w || wrect.h>s.h)
     setGeometry( wrect.x, wrect.y, std::min(s.w, wrect.w), std::min(s.h, wrect.h) );
@@ -392,7 +443,7 @@ void Widget::setMinimumSize(const Size &s) {
 
   szPolicy.minSize = s;
   if( owner() )
-    owner()->applyLayout();
+    owner()->implChildChanged();
 
   if(wrect.w<s.w || wrect.h<s.h )
     setGeometry( wrect.x, wrect.y, std::max(s.w, wrect.w), std::max(s.h, wrect.h) );
@@ -448,8 +499,10 @@ void Widget::setVisible(bool v) {
     astate.needToUpdate = false;
 
   if( auto w = owner() ){
+    if(w->hit!=nullptr)
+      w->hit->moved(*this);
     w->update();
-    w->applyLayout();
+    w->implChildChanged();
     }
   }
 
@@ -564,15 +617,22 @@ void Widget::implExcFocus(Widget* prev, Widget *next, const FocusEvent& parent)
   }
 
 void Widget::update() noexcept {
+  update(Rect(0,0,wrect.w,wrect.h));
+  }
+
+void Widget::update(const Rect& r) noexcept {
+  implDamage(r);
+
+  // widgets, that were skipped by last paint, keep the flag: walk up to the root anyway
   Widget* w=this;
   while(true){
-    if(w->astate.needToUpdate)
-      return;
+    const bool pending = w->astate.needToUpdate;
     w->astate.needToUpdate=true;
     auto ow = w->owner();
     if(ow==nullptr) {
       if(auto overlay = dynamic_cast<UiOverlay*>(w)){
-        overlay->updateWindow();
+        if(!pending)
+          overlay->updateWindow();
         }
       return;
       }
@@ -580,6 +640,34 @@ void Widget::update() noexcept {
     }
   }
 
+void Widget::implDamage(Rect r) noexcept {
+  if(r.isEmpty())
+    return;
+  Widget* w = this;
+  while(w->ow!=nullptr) {
+    if(!w->wstate.visible)
+      return;
+    r.x += w->wrect.x;
+    r.y += w->wrect.y;
+    w    = w->ow;
+    }
+  w->dmg = w->dmg.united(r);
+  }
+
+void Widget::implMoved(const Rect& prev) noexcept {
+  // moved not by layout of owner: layout has to run again, to restore the place
+  if(ow!=nullptr && !ow->astate.layBusy)
+    ++ow->layGen;
+  if(ow!=nullptr && ow->hit!=nullptr)
+    ow->hit->moved(*this);
+  // both old and new place of widget have to be repainted
+  if(!wstate.visible)
+    return;
+  if(ow!=nullptr)
+    ow->implDamage(prev.united(wrect)); else
+    implDamage(Rect(0,0,wrect.w,wrect.h));
+  }
+
 void Widget::setStyle(const Style* s) {
   if(s==stl)
     return;
@@ -15,6 +15,10 @@ namespace Tempest {
 class Layout;
 class Shortcut;
 
+namespace Detail {
+class HitIndex;
+}
+
 enum FocusPolicy : uint8_t {
   NoFocus     = 0,
   TabFocus    = 1,
@@ -29,7 +33,7 @@ class Widget {
     Widget(const Widget&)=delete;
     virtual ~Widget();
 
-    void setLayout(Orientation ori) noexcept;
+    void setLayout(Orientation ori);
     void setLayout(Layout* lay);
     const Layout& layout() const { return *lay; }
     void  applyLayout();
@@ -106,7 +110,10 @@ class Widget {
     auto cursorShape() const -> CursorShape { return wstate.cursor; }
 
     void update() noexcept;
+    void update(const Rect& r) noexcept;
     bool needToUpdate() const { return astate.needToUpdate; }
+    // area in coordinates of top-level widget, that changed since it was painted
+    const Rect& damagedRect() const { return dmg; }
 
     bool isMouseOver()  const { return wstate.moveOver; }
 
@@ -121,6 +128,8 @@ class Widget {
     void setSizeHint(int w,int h) { return setSizeHint(Size(w,h)); }
 
     void setWidgetState(const WidgetState& st);
+    // nested widgets, that did not change, keep painted geometry when this one moves; see ScrollWidget
+    void setMoveRetained(bool r) { astate.moveRetained = r; }
 
     virtual void paintEvent     (Tempest::PaintEvent&  event);
     virtual void dispatchPaintEvent(Tempest::PaintEvent& event);
@@ -179,11 +188,19 @@ class Widget {
       Widget*  focus        = nullptr;
       uint16_t disable      = 0;
       bool     needToUpdate = false;
+      // was painted at least once, see PaintDevice::replayRange
+      bool     painted      = false;
+      // layout is running; requests, that come meanwhile, make it run once again
+      bool     layBusy      = false;
+      bool     layDirty     = false;
+      // nested widgets are replayed with offset, when this one moves
+      bool     moveRetained = false;
       };
 
     Widget*                 ow=nullptr;
     std::vector<Widget*>    wx;
     Tempest::Rect           wrect;
+    Tempest::Rect           dmg;
     Tempest::Size           szHint;
     Tempest::SizePolicy     szPolicy;
     FocusPolicy             fcPolicy=NoFocus;
@@ -201,6 +218,10 @@ class Widget {
 
     Layout*                 lay=reinterpret_cast<Layout*>(layBuf);
     char                    layBuf[sizeof(void*)*3]={};
+    // changes of children, that may affect layout
+    uint32_t                layGen=0;
+    // created by EventDispatcher, for widgets with many children
+    Detail::HitIndex*       hit=nullptr;
 
     const Style*            stl = nullptr;
 
@@ -217,6 +238,10 @@ class Widget {
     static Widget*          implTrieRoot(Widget* w);
     bool                    checkFocus() const { return wstate.focus || astate.focus; }
     void                    implAttachFocus();
+    void                    implDamage(Rect r) noexcept;
+    void                    implMoved(const Rect& prev) noexcept;
+    void                    implLayout();
+    void                    implChildChanged();
 
     void                    dispatchPolishEvent(PolishEvent& e);
 
@@ -228,6 +253,7 @@ class Widget {
   friend class ListDelegate;
   friend class Shortcut;
   friend class Layout;
+  friend class LinearLayout;
   friend class Window;
   };
 
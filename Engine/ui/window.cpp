@@ -1,6 +1,7 @@
 #include "window.h"
 
 #include <Tempest/VectorImage>
+#include <Tempest/Painter>
 #include <Tempest/Except>
 
 using namespace Tempest;
@@ -44,6 +45,29 @@ void Window::dispatchPaintEvent(VectorImage &surface,TextureAtlas& ta) {
   SystemApi::dispatchOverlayRender(*this,p);
   }
 
+Rect Window::dispatchPaintEvent(VectorImage& surface, TextureAtlas& ta, const Color& background) {
+  const Rect area = damagedRect().intersected(Rect(0,0,w(),h()));
+  surface.clear();
+  // update of hidden or empty widget doesn't damage anything
+  this->astate.needToUpdate = false;
+  if(area.isEmpty())
+    return area;
+
+  // widgets outside of area are skipped, geometry of others is clipped to it
+  PaintEvent root(surface,ta,this->w(),this->h());
+  PaintEvent p(root,0,0,area.x,area.y,area.w,area.h);
+  {
+  Painter bg(p);
+  bg.setBrush(Brush(background,Painter::NoBlend));
+  bg.drawRect(area.x,area.y,area.w,area.h);
+  }
+
+  Widget::dispatchPaintEvent(p);
+
+  SystemApi::dispatchOverlayRender(*this,p);
+  return area;
+  }
+
 void Window::closeEvent(CloseEvent& e) {
   e.ignore();
   }
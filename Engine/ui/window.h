@@ -7,6 +7,7 @@ namespace Tempest {
 
 class VectorImage;
 class TextureAtlas;
+class Color;
 
 class Window : public Widget {
   public:
@@ -23,10 +24,17 @@ class Window : public Widget {
 
     void setWindowTitle(const char* utf8);
 
+    // window is rendered every frame, even with no update requested; see Application::setEventDriven
+    void setAnimated(bool a) { animated = a; }
+    bool isAnimated() const  { return animated; }
+
   protected:
     virtual void render();
     using        Widget::dispatchPaintEvent;
     void         dispatchPaintEvent(VectorImage &e,TextureAtlas &ta);
+    // repaints damagedRect() only, over background; result has to be drawn to a target,
+    // that keeps previous frame. Returns area, that was painted, empty if nothing changed
+    Rect         dispatchPaintEvent(VectorImage &e,TextureAtlas &ta,const Color& background);
     void         closeEvent       (Tempest::CloseEvent& event) override;
 
     SystemApi::Window* hwnd() const { return id; }
@@ -38,6 +46,7 @@ class Window : public Widget {
     void         implShowCursor(CursorShape s);
 
     SystemApi::Window* id=nullptr;
+    bool               animated=false;
 
   friend class Widget;
   friend class UiOverlay;
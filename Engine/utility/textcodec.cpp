@@ -73,3 +73,29 @@ std::u16string TextCodec::toUtf16(const char *inS) {
 
   return u;
   }
+
+size_t TextCodec::toUtf16(const char* inS, char16_t* out, size_t outSize) {
+  if(outSize==0)
+    return 0;
+
+  const uint8_t* s  = reinterpret_cast<const uint8_t*>(inS);
+  size_t         sz = 0;
+  for(size_t i=0;s[i];) {
+    uint32_t cp = 0;
+    i += Detail::utf8ToCodepoint(&s[i],cp);
+
+    if(cp > 0xFFFF) {
+      if(sz+2>=outSize)
+        break;
+      cp -= 0x10000;
+      out[sz++] = char16_t(0xD800 + ((cp >> 10) & 0x3FF));
+      out[sz++] = char16_t(0xDC00 + (cp & 0x3FF));
+      } else {
+      if(sz+1>=outSize)
+        break;
+      out[sz++] = char16_t(cp);
+      }
+    }
+  out[sz] = u'\0';
+  return sz;
+  }
@@ -16,6 +16,8 @@ class TextCodec final {
 
     static std::u16string toUtf16(const std::string& s);
     static std::u16string toUtf16(const char* s);
+    // no allocation: out gets at most outSize-1 units and '\0', surrogate pair is never split; returns count of units
+    static size_t         toUtf16(const char* s, char16_t* out, size_t outSize);
   };
 
 }
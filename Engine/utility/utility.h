@@ -244,6 +244,20 @@ struct BasicRect {
     return re;
     }
 
+  BasicRect united(const BasicRect& r) const {
+    if(r.isEmpty())
+      return *this;
+    if(isEmpty())
+      return r;
+    BasicRect re;
+    re.x = std::min( x, r.x );
+    re.y = std::min( y, r.y );
+
+    re.w = std::max( x+w, r.x+r.w ) - re.x;
+    re.h = std::max( y+h, r.y+r.h ) - re.y;
+    return re;
+    }
+
   bool contains( const BasicPoint<T,2> & p ) const {
     return contains(p.x, p.y);
     }
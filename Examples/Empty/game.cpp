@@ -20,6 +20,7 @@ Game::Game(Device& device)
 
   for(uint8_t i=0;i<MaxFramesInFlight;++i)
     fence.emplace_back(device.fence());
+  resizeLayer();
   }
 
 Game::~Game() {
@@ -43,23 +44,41 @@ void Game::resizeEvent(SizeEvent&) {
   for(auto& i:fence)
     i.wait();
   swapchain.reset();
+  resizeLayer();
   update();
   }
 
+void Game::resizeLayer() {
+  if(w()<=0 || h()<=0)
+    return;
+  layer = device.attachment(TextureFormat::RGBA8,uint32_t(w()),uint32_t(h()));
+
+  PaintEvent e(blit,texAtlass,w(),h());
+  Painter    p(e,Painter::Clear);
+  p.setBrush(Brush(textureCast(layer),Painter::NoBlend));
+  p.drawRect(0,0,w(),h());
+  }
+
 void Game::render(){
   try {
+    // idle window does no work at all: previous frame stays on screen
+    if(dispatchPaintEvent(surface,texAtlass,Color(0,0,1,1)).isEmpty())
+      return;
+
     auto&       sync = fence   [cmdId];
     auto&       cmd  = commands[cmdId];
 
     sync.wait();
 
-    dispatchPaintEvent(surface,texAtlass);
-
     {
     auto enc = cmd.startEncoding(device);
-    enc.setFramebuffer({{swapchain[swapchain.currentImage()],Vec4(0,0,1,1),Tempest::Preserve}});
+    enc.setFramebuffer({{layer,Tempest::Preserve,Tempest::Preserve}});
     surfaceMesh[cmdId].update(device,surface);
     surfaceMesh[cmdId].draw(enc);
+
+    enc.setFramebuffer({{swapchain[swapchain.currentImage()],Tempest::Discard,Tempest::Preserve}});
+    blitMesh[cmdId].update(device,blit);
+    blitMesh[cmdId].draw(enc);
     }
 
     device.submit(cmd,sync);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Tempest/Window>
+#include <Tempest/Attachment>
 #include <Tempest/CommandBuffer>
 #include <Tempest/Fence>
 #include <Tempest/VulkanApi>
@@ -31,6 +32,7 @@ class Game : public Tempest::Window {
     void paintEvent(Tempest::PaintEvent& event);
     void resizeEvent(Tempest::SizeEvent& event);
     void render();
+    void resizeLayer();
 
     struct Ubo {
       float r=1;
@@ -42,8 +44,12 @@ class Game : public Tempest::Window {
     Tempest::Swapchain                  swapchain;
     Tempest::TextureAtlas               texAtlass;
 
+    // ui is painted only where it changed, over previous frame in layer
+    Tempest::Attachment                 layer;
     Tempest::VectorImage                surface;
     Tempest::VectorImage::Mesh          surfaceMesh[MaxFramesInFlight];
+    Tempest::VectorImage                blit;
+    Tempest::VectorImage::Mesh          blitMesh[MaxFramesInFlight];
 
     Tempest::VertexBuffer<Point>        vbo;
     Tempest::Texture2d                  texture;
@@ -10,6 +10,7 @@
 #include <Tempest/VectorImage>
 #include <Tempest/Event>
 #include <Tempest/Painter>
+#include <Tempest/Widget>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock-matchers.h>
@@ -45,6 +46,29 @@ class PainterTest : public ::testing::Test {
       pm.save(buf);
       }
 
+    // fraction of pixels, that are far from reference rasterization composited over black
+    float diff(const Attachment& fbo, const char* reference) {
+      auto pm  = device.readPixels(fbo);
+      auto ref = Pixmap(reference);
+      if(pm.w()!=ref.w() || pm.h()!=ref.h() || ref.format()!=TextureFormat::RGBA8)
+        return 1.f;
+
+      auto     px  = reinterpret_cast<const uint8_t*>(pm.data());
+      auto     rx  = reinterpret_cast<const uint8_t*>(ref.data());
+      uint32_t bad = 0;
+      for(uint32_t i=0; i<pm.w()*pm.h(); ++i) {
+        const uint8_t* p = px+i*4;
+        const uint8_t* r = rx+i*4;
+        for(int c=0; c<3; ++c) {
+          if(std::abs(int(p[c]) - int(r[c])*int(r[3])/255)>48) {
+            ++bad;
+            break;
+            }
+          }
+        }
+      return float(bad)/float(pm.w()*pm.h());
+      }
+
 #if defined(__OSX__)
     MetalApi     api{ApiFlags::Validation};
 #else
@@ -111,3 +135,145 @@ TEST_F(PainterTest, DISABLED_Line)
   draw(fbo, imgMesh);
   logImage(fbo);
 }
+
+TEST_F(PainterTest, DISABLED_Svg)
+{
+  for(auto name:{"icon","strokes"}) {
+    char svg[64] = {}, png[64] = {};
+    std::snprintf(svg,sizeof(svg),"assets/svg/%s.svg",name);
+    std::snprintf(png,sizeof(png),"assets/svg/%s.png",name);
+
+    VectorImage       img;
+    VectorImage::Mesh imgMesh;
+    ASSERT_TRUE(img.load(svg));
+
+    auto fbo = device.attachment(TextureFormat::RGBA8,img.w(),img.h());
+    imgMesh.update(device,img);
+    draw(fbo, imgMesh);
+    logImage(fbo);
+
+    // aliased triangles against anti-aliased reference: only edges may differ
+    EXPECT_LT(diff(fbo,png),0.02f);
+    }
+}
+
+TEST_F(PainterTest, DISABLED_SvgCache)
+{
+  VectorImage a, b;
+  ASSERT_TRUE(a.load("assets/svg/icon.svg"));
+  ASSERT_TRUE(b.load("assets/svg/icon.svg"));
+  EXPECT_EQ(a.w(),b.w());
+  EXPECT_EQ(a.h(),b.h());
+  EXPECT_FALSE(b.load("assets/svg/missing.svg"));
+}
+
+TEST_F(PainterTest, DISABLED_Scissor)
+{
+  VectorImage       img;
+  VectorImage::Mesh imgMesh;
+
+  auto fbo = device.attachment(TextureFormat::RGBA8,512,512);
+  {
+  PaintEvent e(img,atlas,fbo.w(),fbo.h());
+  Painter    p(e,Painter::Clear);
+  p.setScissor(64,64,384,384);
+
+  // integer and fractional quads, along all scissor edges
+  p.setBrush(Color(0,0,1,1));
+  for(int i=0; i<32; ++i)
+    p.drawRect(i*16,i*16,40,24);
+  p.setBrush(Color(0,1,0,1));
+  for(int i=0; i<32; ++i)
+    p.drawRect(float(i)*16.5f+0.25f,480.f-float(i)*16.f,12.5f,40.25f,0.f,0.f,1.f,1.f);
+
+  p.setPen(Pen(Color(1,1,1,1),Painter::Alpha,3));
+  for(int i=0; i<16; ++i)
+    p.drawLine(0,i*32,512,512-i*32);
+
+  p.setBrush(Color(1,0,0,1));
+  p.translate(256,256);
+  p.rotate(30);
+  p.drawRect(-300,-40,600,80);
+  }
+
+  imgMesh.update(device,img);
+  draw(fbo, imgMesh);
+  logImage(fbo);
+}
+
+TEST_F(PainterTest, DISABLED_Batching)
+{
+  VectorImage       img;
+  VectorImage::Mesh imgMesh;
+
+  std::vector<uint8_t> px(16*16*4,255);
+  auto icon = atlas.load(px.data(),16,16,TextureFormat::RGBA8);
+  auto fbo  = device.attachment(TextureFormat::RGBA8,512,512);
+  {
+  PaintEvent e(img,atlas,fbo.w(),fbo.h());
+  Painter    p(e);
+
+  // widgets: background, icon, label and separator; each one changes brush state 4 times
+  for(int i=0; i<48; ++i) {
+    const int x = (i%4)*128, y = (i/4)*42;
+    p.setBrush(Brush(Color(0.2f,0.2f,0.25f,1),Painter::NoBlend));
+    p.drawRect(x+1,y+1,126,40);
+    p.setBrush(Brush(icon,Color(1,1,0,1)));
+    p.drawRect(x+4,y+4,16,16);
+    p.setBrush(Brush(Color(1,1,1,1)));
+    p.drawText(x+24,y+18,"Label");
+    p.setPen(Pen(Color(0.5f,0.5f,0.5f,1),Painter::Alpha,1));
+    p.drawLine(x+4,y+38,x+124,y+38);
+    }
+  }
+
+  imgMesh.update(device,img);
+  EXPECT_LE(imgMesh.drawCount(),size_t(8));
+
+  draw(fbo, imgMesh);
+  logImage(fbo);
+}
+
+TEST_F(PainterTest, DISABLED_Retained)
+{
+  struct Item : Widget {
+    Color cl;
+    void paintEvent(PaintEvent& e) override {
+      Painter p(e);
+      p.setBrush(Brush(cl,Painter::NoBlend));
+      p.drawRect(0,0,w(),h());
+      }
+    };
+  struct Root : Widget {
+    using Widget::dispatchPaintEvent;
+    };
+
+  VectorImage       img;
+  VectorImage::Mesh imgMesh;
+  img.setRetained(true);
+
+  auto fbo = device.attachment(TextureFormat::RGBA8,512,512);
+  Root root;
+  root.resize(512,512);
+  std::vector<Item*> items;
+  for(int i=0; i<64; ++i) {
+    auto& it = root.addWidget(new Item());
+    it.setGeometry((i%8)*64,(i/8)*64,60,60);
+    it.cl = Color(float(i)/64.f,0.5f,0.5f,1);
+    items.push_back(&it);
+    }
+
+  auto frame = [&]() {
+    img.clear();
+    PaintEvent e(img,atlas,fbo.w(),fbo.h());
+    root.dispatchPaintEvent(e);
+    imgMesh.update(device,img);
+    };
+  frame();
+  items[10]->cl = Color(1,0,0,1);
+  items[10]->update();
+  frame();
+
+  draw(fbo, imgMesh);
+  logImage(fbo);
+}
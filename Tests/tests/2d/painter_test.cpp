@@ -0,0 +1,313 @@
+#include <Tempest/Painter>
+#include <Tempest/PaintDevice>
+#include <Tempest/TextureAtlas>
+#include <Tempest/Event>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock-generated-matchers.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace testing;
+using namespace Tempest;
+
+namespace {
+
+// keeps vertices as they are; no quad instancing, so rects come as triangles too
+struct Recorder : PaintDevice {
+  std::vector<Point> pts;
+
+  void   clear() override { pts.clear(); }
+  void   addPoint(const Point& p) override { pts.push_back(p); }
+  Point* allocPoints(size_t n) override {
+    pts.resize(pts.size()+n);
+    return pts.data()+pts.size()-n;
+    }
+  void   commitPoints() override {}
+
+  void   beginPaint(bool,uint32_t,uint32_t) override {}
+  void   endPaint() override {}
+  size_t pushState() override { return 0; }
+  void   popState(size_t) override {}
+
+  void   setState(const TexPtr&, const Color&, TextureFormat, ClampMode) override {}
+  void   setState(const Sprite&, const Color&, bool, const TextEffect&) override {}
+  void   setTopology(Topology) override {}
+  void   setBlend(const Blend) override {}
+  };
+
+// bulk storage moves on every call: pointers, kept across calls, go stale
+struct MovingRecorder : Recorder {
+  size_t allocs = 0;
+  Point* allocPoints(size_t n) override {
+    std::vector<Point> next(pts.size()+n);
+    std::copy(pts.begin(),pts.end(),next.begin());
+    pts.swap(next);
+    allocs++;
+    return pts.data()+pts.size()-n;
+    }
+  };
+
+// device of single vertices: bulk storage is staged and goes to addPoint before anything else
+struct VertexRecorder : Recorder {
+  std::vector<Point> stage;
+  Point* allocPoints(size_t n) override {
+    flush();
+    stage.resize(n);
+    return stage.data();
+    }
+  void   flush() {
+    for(auto& p:stage)
+      addPoint(p);
+    stage.clear();
+    }
+  void   commitPoints() override { flush(); }
+  void   setState(const TexPtr&, const Color&, TextureFormat, ClampMode) override { flush(); }
+  void   setState(const Sprite&, const Color&, bool, const TextEffect&) override { flush(); }
+  void   setTopology(Topology) override { flush(); }
+  void   setBlend(const Blend) override { flush(); }
+  };
+
+// quad instances are expanded to vertices as brush.vert does it
+struct QuadRecorder : Recorder {
+  std::vector<Quad> quads;
+  std::vector<bool> textured;
+  size_t            pending = 0;
+
+  Quad*  allocQuads(size_t n) override {
+    expand();
+    quads.resize(quads.size()+n);
+    pending = n;
+    return quads.data()+quads.size()-n;
+    }
+  Point* allocPoints(size_t n) override {
+    expand();
+    textured.resize(textured.size()+n,true);
+    return Recorder::allocPoints(n);
+    }
+  void   expand() {
+    static const int corner[6] = {0,1,2,0,2,3};
+    for(size_t i=quads.size()-pending; i<quads.size(); ++i) {
+      auto& q = quads[i];
+      for(int c:corner) {
+        const bool hx = (c==1 || c==2), hy = (c>=2);
+        const uint32_t u = hx ? q.uv1 : q.uv0, v = hy ? q.uv1 : q.uv0;
+        Point p;
+        p.x = hx ? q.x1 : q.x0;
+        p.y = hy ? q.y1 : q.y0;
+        p.u = float(u & 0xFFFF)/65535.f;
+        p.v = float(v >> 16)/65535.f;
+        p.r = float((q.color      ) & 0xFF)/255.f;
+        p.g = float((q.color >>  8) & 0xFF)/255.f;
+        p.b = float((q.color >> 16) & 0xFF)/255.f;
+        p.a = float((q.color >> 24)       )/255.f;
+        pts.push_back(p);
+        textured.push_back(q.uv0!=0 || q.uv1!=0);
+        }
+      }
+    pending = 0;
+    }
+  void   setState(const TexPtr&, const Color&, TextureFormat, ClampMode) override { expand(); }
+  void   setState(const Sprite&, const Color&, bool, const TextEffect&) override { expand(); }
+  void   setTopology(Topology) override { expand(); }
+  void   setBlend(const Blend) override { expand(); }
+  };
+
+// rects, clipped and not, textured, rotated, triangles, lines and text
+void scene(Painter& p, const Sprite& spr, const Font& fnt) {
+  p.setScissor(8,8,112,112);
+  p.setBrush(Color(1,0.5f,0.25f,1));
+  p.drawRect(0,0,32,32);
+  p.drawRect(100,100,40,10);
+  p.drawRect(20.5f,40.25f,10.f,7.f, 0.f,0.f,1.f,1.f);
+  p.setBrush(Brush(spr,Color(0,1,0,0.5f)));
+  p.drawRect(40,40,16,16, 0,0,16,16);
+  p.drawRect(-4,60,16,16, 0,0,16,16);
+  p.drawTriangle(0,40,0,0, 32,24,1,0, 32,56,1,1);
+  p.setPen(Pen(Color(0,0,1,1)));
+  p.drawLine(0,0,127,127);
+  p.drawLine(64,4,64,124);
+  p.setFont(fnt);
+  p.drawText(10,100,"Tempest");
+  p.pushState();
+  p.translate(64,64);
+  p.rotate(30);
+  p.setBrush(Color(1,1,1,1));
+  p.drawRect(-10,-10,20,20);
+  p.popState();
+  }
+
+// 128x128 target: pixel coordinates are exact in normalized device coordinates
+struct Vtx {
+  float x=0, y=0, u=0, v=0;
+  bool operator == (const Vtx& o) const { return x==o.x && y==o.y && u==o.u && v==o.v; }
+  };
+
+void PrintTo(const Vtx& v, std::ostream* os) {
+  *os << "(" << v.x << "," << v.y << " uv " << v.u << "," << v.v << ")";
+  }
+
+std::vector<Vtx> pixels(const std::vector<PaintDevice::Point>& pts) {
+  std::vector<Vtx> ret;
+  for(auto& p:pts)
+    ret.push_back({(p.x+1.f)*64.f, (p.y+1.f)*64.f, p.u, p.v});
+  return ret;
+  }
+
+std::vector<Vtx> unique(std::vector<Vtx> v) {
+  std::vector<Vtx> ret;
+  for(auto& i:v)
+    if(std::find(ret.begin(),ret.end(),i)==ret.end())
+      ret.push_back(i);
+  return ret;
+  }
+
+float area(const std::vector<Vtx>& v) {
+  float a = 0;
+  for(size_t i=0; i+3<=v.size(); i+=3)
+    a += std::abs((v[i+1].x-v[i].x)*(v[i+2].y-v[i].y) - (v[i+2].x-v[i].x)*(v[i+1].y-v[i].y))*0.5f;
+  return a;
+  }
+}
+
+TEST(main,PainterScissorRect) {
+  Recorder     dev;
+  TextureAtlas atlas;
+  PaintEvent   e(dev,atlas,128,128);
+  Painter      p(e);
+  p.setScissor(16,16,64,64);
+  p.setBrush(Color(1,1,1,1));
+
+  // cut by left edge: uv starts in the middle
+  p.drawRect(0.f,32.f,32.f,16.f, 0.f,0.f,1.f,1.f);
+  EXPECT_THAT(pixels(dev.pts), ElementsAre(Vtx{16,32,0.5f,0}, Vtx{32,32,1,0}, Vtx{32,48,1,1},
+                                           Vtx{16,32,0.5f,0}, Vtx{32,48,1,1}, Vtx{16,48,0.5f,1}));
+
+  // cut by right and bottom edges
+  dev.clear();
+  p.drawRect(72.f,72.f,16.f,16.f, 0.f,0.f,1.f,1.f);
+  EXPECT_THAT(pixels(dev.pts), ElementsAre(Vtx{72,72,0,0}, Vtx{80,72,0.5f,0}, Vtx{80,80,0.5f,0.5f},
+                                           Vtx{72,72,0,0}, Vtx{80,80,0.5f,0.5f}, Vtx{72,80,0,0.5f}));
+
+  // outside of scissor
+  dev.clear();
+  p.drawRect(100,0,8,8);
+  p.drawRect(0,80,8,8);
+  EXPECT_TRUE(dev.pts.empty());
+  }
+
+TEST(main,PainterScissorPoly) {
+  Recorder     dev;
+  TextureAtlas atlas;
+  PaintEvent   e(dev,atlas,128,128);
+  Painter      p(e);
+  p.setScissor(16,16,64,64);
+  p.setBrush(Color(1,1,1,1));
+
+  // uv is position/64, so it has to stay so after clip
+  auto trig = [&](float x0, float y0, float x1, float y1, float x2, float y2) {
+    dev.clear();
+    p.drawTriangle(x0,y0,x0/64.f,y0/64.f, x1,y1,x1/64.f,y1/64.f, x2,y2,x2/64.f,y2/64.f);
+    auto ret = pixels(dev.pts);
+    for(auto& v:ret) {
+      EXPECT_FLOAT_EQ(v.u,v.x/64.f);
+      EXPECT_FLOAT_EQ(v.v,v.y/64.f);
+      }
+    return ret;
+    };
+  auto at = [](float x, float y) { return Vtx{x,y,x/64.f,y/64.f}; };
+
+  // corner is cut off by left edge: quad, two triangles of fan
+  auto quad = trig(0,40, 32,24, 32,56);
+  ASSERT_EQ(quad.size(),6u);
+  EXPECT_THAT(unique(quad), UnorderedElementsAre(at(16,32), at(32,24), at(32,56), at(16,48)));
+  EXPECT_EQ(area(quad),384.f);
+
+  // cut by left edge, which ends at bottom-left corner of scissor
+  auto tri = trig(0,32, 64,32, 0,96);
+  EXPECT_THAT(tri, UnorderedElementsAre(at(16,32), at(64,32), at(16,80)));
+
+  // cut by left and top edges at once: corner of scissor is inside
+  tri = trig(8,8, 56,8, 8,56);
+  EXPECT_THAT(tri, UnorderedElementsAre(at(16,16), at(48,16), at(16,48)));
+
+  // edges cut two corners of scissor and run across its bottom: hexagon
+  auto hex = trig(48,-8, 132,76, -36,76);
+  ASSERT_EQ(hex.size(),12u);
+  for(auto& v:hex) {
+    EXPECT_GE(v.x,16.f);
+    EXPECT_LE(v.x,80.f);
+    EXPECT_GE(v.y,16.f);
+    EXPECT_LE(v.y,80.f);
+    }
+  EXPECT_NEAR(area(hex),64*64-32-32-64*4,0.01f);
+
+  // fully outside
+  EXPECT_TRUE(trig(0,0, 8,0, 0,8).empty());
+  }
+
+TEST(main,PainterBulkPoints) {
+  Font fnt("assets/font/Roboto-Regular.ttf");
+  fnt.setPixelSize(16);
+  std::vector<uint8_t> px(16*16*4,0xFF);
+
+  MovingRecorder bulk;
+  VertexRecorder single;
+  {
+  TextureAtlas atlas;
+  Sprite       spr = atlas.load(px.data(),16,16,TextureFormat::RGBA8);
+  for(PaintDevice* d:{static_cast<PaintDevice*>(&bulk),static_cast<PaintDevice*>(&single)}) {
+    PaintEvent e(*d,atlas,128,128);
+    Painter    p(e);
+    scene(p,spr,fnt);
+    }
+  }
+  single.flush();
+
+  // same vertices, as if each one came alone; storage is taken once per primitive
+  ASSERT_GT(bulk.pts.size(),60u);
+  ASSERT_EQ(bulk.pts.size(),single.pts.size());
+  EXPECT_EQ(std::memcmp(bulk.pts.data(),single.pts.data(),bulk.pts.size()*sizeof(PaintDevice::Point)),0);
+  EXPECT_LT(bulk.allocs*3,bulk.pts.size());
+  }
+
+TEST(main,PainterQuads) {
+  Font fnt("assets/font/Roboto-Regular.ttf");
+  fnt.setPixelSize(16);
+  std::vector<uint8_t> px(16*16*4,0xFF);
+
+  Recorder     tri;
+  QuadRecorder quad;
+  {
+  TextureAtlas atlas;
+  Sprite       spr = atlas.load(px.data(),16,16,TextureFormat::RGBA8);
+  for(PaintDevice* d:{static_cast<PaintDevice*>(&tri),static_cast<PaintDevice*>(&quad)}) {
+    PaintEvent e(*d,atlas,128,128);
+    Painter    p(e);
+    scene(p,spr,fnt);
+    }
+  }
+  quad.expand();
+
+  // rects, scissored ones too, come as instances; the rest stays as it was
+  ASSERT_GT(quad.quads.size(),2u);
+  ASSERT_EQ(quad.pts.size(),tri.pts.size());
+  // half of unorm step, as rounding goes
+  const float du = 0.5f/65535.f + 1e-6f, dc = 0.5f/255.f + 1e-6f;
+  for(size_t i=0; i<tri.pts.size(); ++i) {
+    auto& a = tri.pts[i];
+    auto& b = quad.pts[i];
+    EXPECT_EQ(a.x,b.x) << "vertex " << i;
+    EXPECT_EQ(a.y,b.y) << "vertex " << i;
+    if(quad.textured[i]) {
+      EXPECT_NEAR(a.u,b.u,du) << "vertex " << i;
+      EXPECT_NEAR(a.v,b.v,du) << "vertex " << i;
+      }
+    EXPECT_NEAR(a.r,b.r,dc) << "vertex " << i;
+    EXPECT_NEAR(a.g,b.g,dc) << "vertex " << i;
+    EXPECT_NEAR(a.b,b.b,dc) << "vertex " << i;
+    EXPECT_NEAR(a.a,b.a,dc) << "vertex " << i;
+    }
+  }
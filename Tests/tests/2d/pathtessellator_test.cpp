@@ -0,0 +1,212 @@
+#include "../2d/pathtessellator.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace Tempest;
+using Detail::PathTessellator;
+
+namespace {
+
+const float pi = 3.14159265358979323846f;
+
+float area(const std::vector<Vec2>& v) {
+  float a = 0;
+  for(size_t i=0; i+3<=v.size(); i+=3)
+    a += std::abs((v[i+1].x-v[i].x)*(v[i+2].y-v[i].y) - (v[i+2].x-v[i].x)*(v[i+1].y-v[i].y))*0.5f;
+  return a;
+  }
+
+// number of triangles, that cover the point
+int coverage(const std::vector<Vec2>& v, float x, float y) {
+  int cnt = 0;
+  for(size_t i=0; i+3<=v.size(); i+=3) {
+    auto edge = [&](const Vec2& a, const Vec2& b) { return (b.x-a.x)*(y-a.y) - (b.y-a.y)*(x-a.x); };
+    const float e0 = edge(v[i],  v[i+1]);
+    const float e1 = edge(v[i+1],v[i+2]);
+    const float e2 = edge(v[i+2],v[i]);
+    if((e0>0 && e1>0 && e2>0) || (e0<0 && e1<0 && e2<0))
+      cnt++;
+    }
+  return cnt;
+  }
+
+// triangles don't overlap: no sample is covered twice
+bool disjoint(const std::vector<Vec2>& v, float x0, float y0, float x1, float y1) {
+  for(float y=y0+0.13f; y<y1; y+=0.5f)
+    for(float x=x0+0.17f; x<x1; x+=0.5f)
+      if(coverage(v,x,y)>1)
+        return false;
+  return true;
+  }
+
+void rect(PathTessellator& t, float x0, float y0, float x1, float y1) {
+  t.moveTo(x0,y0);
+  t.lineTo(x1,y0);
+  t.lineTo(x1,y1);
+  t.lineTo(x0,y1);
+  t.close();
+  }
+
+std::vector<Vec2> fill(const PathTessellator& t, PathTessellator::FillRule rule) {
+  std::vector<Vec2> out;
+  t.fill(rule,out);
+  return out;
+  }
+
+std::vector<Vec2> stroke(const PathTessellator& t, const PathTessellator::Stroke& st) {
+  std::vector<Vec2> out;
+  t.stroke(st,out);
+  return out;
+  }
+}
+
+TEST(main,PathTessellatorFillRule) {
+  PathTessellator t;
+
+  // inner square of same winding: hole only under even-odd
+  rect(t,0,0,10,10);
+  rect(t,2,2,8,8);
+  EXPECT_FLOAT_EQ(area(fill(t,PathTessellator::NonZero)),100.f);
+  EXPECT_FLOAT_EQ(area(fill(t,PathTessellator::EvenOdd)),64.f);
+
+  // opposite winding: hole under both rules
+  t.clear();
+  rect(t,0,0,10,10);
+  t.moveTo(2,2);
+  t.lineTo(2,8);
+  t.lineTo(8,8);
+  t.lineTo(8,2);
+  t.close();
+  EXPECT_FLOAT_EQ(area(fill(t,PathTessellator::NonZero)),64.f);
+  EXPECT_FLOAT_EQ(area(fill(t,PathTessellator::EvenOdd)),64.f);
+
+  // pentagram: center is wound twice
+  t.clear();
+  for(int i=0; i<5; ++i) {
+    const float a = float(i*2)*2.f*pi/5.f;
+    if(i==0)
+      t.moveTo(10+10*std::sin(a),10-10*std::cos(a)); else
+      t.lineTo(10+10*std::sin(a),10-10*std::cos(a));
+    }
+  t.close();
+  auto nz = fill(t,PathTessellator::NonZero);
+  auto eo = fill(t,PathTessellator::EvenOdd);
+  EXPECT_EQ(coverage(nz,10,10),1);
+  EXPECT_EQ(coverage(eo,10,10),0);
+  // tips are covered under both
+  EXPECT_EQ(coverage(nz,10,1),1);
+  EXPECT_EQ(coverage(eo,10,1),1);
+  EXPECT_GT(area(nz),area(eo));
+  EXPECT_TRUE(disjoint(nz,0,0,20,20));
+  EXPECT_TRUE(disjoint(eo,0,0,20,20));
+  }
+
+TEST(main,PathTessellatorStrokeCap) {
+  // fine tolerance: round cap of width 2 is a hexagon otherwise
+  PathTessellator t(0.01f);
+  t.moveTo(0,0);
+  t.lineTo(10,0);
+
+  PathTessellator::Stroke st;
+  st.width = 2;
+  st.cap   = PathTessellator::ButtCap;
+  EXPECT_NEAR(area(stroke(t,st)),20.f,1e-3f);
+
+  st.cap   = PathTessellator::SquareCap;
+  auto sq = stroke(t,st);
+  EXPECT_NEAR(area(sq),24.f,1e-3f);
+  EXPECT_EQ(coverage(sq,-0.5f,0.5f),1);
+  EXPECT_EQ(coverage(sq,10.5f,-0.5f),1);
+
+  // circle of width, inscribed polygon
+  st.cap   = PathTessellator::RoundCap;
+  auto rnd = stroke(t,st);
+  EXPECT_NEAR(area(rnd),20.f+pi,0.1f);
+  EXPECT_LE(area(rnd),20.f+pi);
+  EXPECT_EQ(coverage(rnd,-0.5f,0.1f),1);
+  EXPECT_EQ(coverage(rnd,-0.9f,-0.9f),0);
+  EXPECT_TRUE(disjoint(rnd,-2,-2,12,2));
+  }
+
+TEST(main,PathTessellatorStrokeJoin) {
+  // right angle: segments give 39 units, join fills the outer corner square [10,11]x[-1,0]
+  PathTessellator t(0.01f);
+  t.moveTo(0,0);
+  t.lineTo(10,0);
+  t.lineTo(10,10);
+
+  PathTessellator::Stroke st;
+  st.width = 2;
+
+  st.join = PathTessellator::MiterJoin;
+  auto miter = stroke(t,st);
+  EXPECT_NEAR(area(miter),40.f,1e-3f);
+  EXPECT_EQ(coverage(miter,10.9f,-0.9f),1);
+  EXPECT_TRUE(disjoint(miter,-1,-2,12,11));
+
+  st.join = PathTessellator::BevelJoin;
+  auto bevel = stroke(t,st);
+  EXPECT_NEAR(area(bevel),39.5f,1e-3f);
+  EXPECT_EQ(coverage(bevel,10.9f,-0.9f),0);
+  EXPECT_EQ(coverage(bevel,10.2f,-0.2f),1);
+
+  st.join = PathTessellator::RoundJoin;
+  auto round = stroke(t,st);
+  EXPECT_NEAR(area(round),39.f+pi/4.f,0.05f);
+  EXPECT_TRUE(disjoint(round,-1,-2,12,11));
+
+  // miter of right angle is sqrt(2) of width: over the limit it falls back to bevel
+  st.join       = PathTessellator::MiterJoin;
+  st.miterLimit = 1.2f;
+  EXPECT_NEAR(area(stroke(t,st)),39.5f,1e-3f);
+
+  // closed contour is joined at its start too
+  t.clear();
+  rect(t,0,0,10,10);
+  st.miterLimit = 4;
+  auto box = stroke(t,st);
+  EXPECT_NEAR(area(box),12*12-8*8,1e-3f);
+  EXPECT_EQ(coverage(box,-0.9f,-0.9f),1);
+  EXPECT_EQ(coverage(box,5,5),0);
+  }
+
+TEST(main,PathTessellatorDash) {
+  PathTessellator t;
+  t.moveTo(0,0);
+  t.lineTo(10,0);
+
+  static const float dash[] = {2,2};
+  PathTessellator::Stroke st;
+  st.width     = 2;
+  st.dash      = dash;
+  st.dashCount = 2;
+
+  // dashes at [0,2], [4,6], [8,10]
+  auto d = stroke(t,st);
+  EXPECT_NEAR(area(d),12.f,1e-3f);
+  EXPECT_EQ(coverage(d,1,0.5f),1);
+  EXPECT_EQ(coverage(d,3,0.5f),0);
+  EXPECT_EQ(coverage(d,5,0.5f),1);
+  EXPECT_EQ(coverage(d,7,0.5f),0);
+  EXPECT_EQ(coverage(d,9,0.5f),1);
+
+  // offset shifts pattern back along the path: [0,1], [3,5], [7,9]
+  st.dashOffset = 1;
+  d = stroke(t,st);
+  EXPECT_NEAR(area(d),10.f,1e-3f);
+  EXPECT_EQ(coverage(d,0.5f,0.5f),1);
+  EXPECT_EQ(coverage(d,2,0.5f),0);
+  EXPECT_EQ(coverage(d,9.5f,0.5f),0);
+
+  // odd count is repeated: 3 on, 1 off, 1 on, 3 off, 1 on, 1 off
+  static const float odd[] = {3,1,1};
+  st.dash       = odd;
+  st.dashCount  = 3;
+  st.dashOffset = 0;
+  d = stroke(t,st);
+  EXPECT_NEAR(area(d),2.f*(3+1+1),1e-3f);
+  EXPECT_EQ(coverage(d,6,0.5f),0);
+  EXPECT_EQ(coverage(d,8.5f,0.5f),1);
+  }
@@ -0,0 +1,320 @@
+#include <Tempest/VectorImage>
+#include <Tempest/TextureAtlas>
+#include <Tempest/Painter>
+#include <Tempest/Event>
+#include <Tempest/Widget>
+#include <Tempest/File>
+
+#include "../2d/shadowbuffer.h"
+#include "utils/vectorimageaccess.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock-generated-matchers.h>
+
+#include <cstring>
+#include <random>
+
+using namespace testing;
+using namespace Tempest;
+using Detail::VectorImageAccess;
+
+namespace {
+
+// primitive is identified by red and green of its color
+uint32_t tagOf(const PaintDevice::Point& p) {
+  return uint32_t(std::lround(p.r*255.f)) | uint32_t(std::lround(p.g*255.f))<<8;
+  }
+
+uint32_t tagOf(const PaintDevice::Quad& q) {
+  return q.color & 0xFFFF;
+  }
+
+bool covers(const PaintDevice::Point* p, float x, float y) {
+  auto edge = [](const PaintDevice::Point& a, const PaintDevice::Point& b, float x, float y) {
+    return (b.x-a.x)*(y-a.y) - (b.y-a.y)*(x-a.x);
+    };
+  const float e0 = edge(p[0],p[1],x,y);
+  const float e1 = edge(p[1],p[2],x,y);
+  const float e2 = edge(p[2],p[0],x,y);
+  return (e0>=0 && e1>=0 && e2>=0) || (e0<=0 && e1<=0 && e2<=0);
+  }
+
+bool coversLine(const PaintDevice::Point* p, float x, float y, float width) {
+  const float dx  = p[1].x-p[0].x, dy = p[1].y-p[0].y;
+  const float len = dx*dx+dy*dy;
+  float t = len>0 ? ((x-p[0].x)*dx+(y-p[0].y)*dy)/len : 0;
+  t = std::clamp(t,0.f,1.f);
+  const float ex = p[0].x+dx*t-x, ey = p[0].y+dy*t-y;
+  return ex*ex+ey*ey <= width*width;
+  }
+
+// tags of primitives, that cover the sample, in draw order
+std::vector<uint32_t> stack(const VectorImageAccess::Geometry& g, float x, float y, float px,
+                            const std::vector<PaintDevice::Blend>& blend, bool& stateOk) {
+  std::vector<uint32_t> ret;
+  for(auto& d:g.draw) {
+    if(d.instanced) {
+      for(size_t i=d.begin; i<d.begin+d.size; ++i) {
+        auto& q = g.quads[i];
+        if(blend[tagOf(q)]!=d.blend)
+          stateOk = false;
+        if(q.x0<=x && x<=q.x1 && q.y0<=y && y<=q.y1)
+          ret.push_back(tagOf(q));
+        }
+      continue;
+      }
+    const size_t n = (d.tp==Lines) ? 2 : 3;
+    for(size_t i=d.begin; i+n<=d.begin+d.size; i+=n) {
+      auto* p = &g.pts[i];
+      if(blend[tagOf(*p)]!=d.blend)
+        stateOk = false;
+      if(d.tp==Lines ? coversLine(p,x,y,px) : covers(p,x,y))
+        ret.push_back(tagOf(*p));
+      }
+    }
+  return ret;
+  }
+}
+
+TEST(main,VectorImageBatch) {
+  // merged draws must leave every pixel with same primitives, in same order, as unbatched replay
+  const int    w = 128, h = 128;
+  TextureAtlas atlas;
+  std::vector<uint8_t> px(16*16*4,255);
+  Sprite icon[2] = {atlas.load(px.data(),16,16,TextureFormat::RGBA8),
+                    atlas.load(px.data(),8,8,TextureFormat::RGBA8)};
+
+  std::mt19937 rnd(1);
+  for(int iter=0; iter<16; ++iter) {
+    VectorImage                     img;
+    std::vector<PaintDevice::Blend> blend;
+    {
+    PaintEvent e(img,atlas,w,h);
+    Painter    p(e);
+    for(uint32_t i=0; i<240; ++i) {
+      const Color cl(float(i%256)/255.f,float(i/256)/255.f,0.5f,1.f);
+      const int   x  = int(rnd()%w), y = int(rnd()%h);
+      const int   sw = 2+int(rnd()%24), sh = 2+int(rnd()%24);
+      switch(rnd()%5) {
+        case 0:
+          p.setBrush(Brush(cl,Painter::NoBlend));
+          p.drawRect(x,y,sw,sh);
+          blend.push_back(Painter::NoBlend);
+          break;
+        case 1:
+          p.setBrush(Brush(cl,Painter::Alpha));
+          p.drawRect(x,y,sw,sh);
+          blend.push_back(Painter::Alpha);
+          break;
+        case 2:
+          p.setBrush(Brush(icon[rnd()%2],cl));
+          p.drawRect(x,y,sw,sh);
+          blend.push_back(Painter::Alpha);
+          break;
+        case 3:
+          p.setPen(Pen(cl,Painter::Alpha,1));
+          p.drawLine(x,y,x+sw,y+sh);
+          blend.push_back(Painter::Alpha);
+          break;
+        default:
+          // rotated rect goes as triangles, not as quad
+          p.setBrush(Brush(cl,Painter::NoBlend));
+          p.pushState();
+          p.translate(x,y);
+          p.rotate(float(rnd()%90));
+          p.drawRect(0,0,sw,sh);
+          p.popState();
+          blend.push_back(Painter::NoBlend);
+          break;
+        }
+      }
+    }
+
+    const auto ref = VectorImageAccess::blocks(img);
+    const auto bt  = VectorImageAccess::batched(img);
+    EXPECT_LT(bt.draw.size(),ref.draw.size());
+    EXPECT_EQ(bt.pts.size(),  ref.pts.size());
+    EXPECT_EQ(bt.quads.size(),ref.quads.size());
+
+    bool stateOk = true, pixelsOk = true;
+    for(int y=0; y<h; y+=2)
+      for(int x=0; x<w; x+=2) {
+        const float sx = (float(x)+0.5f)*2.f/float(w)-1.f;
+        const float sy = (float(y)+0.5f)*2.f/float(h)-1.f;
+        if(stack(ref,sx,sy,2.f/float(w),blend,stateOk)!=stack(bt,sx,sy,2.f/float(w),blend,stateOk))
+          pixelsOk = false;
+        }
+    EXPECT_TRUE(stateOk);
+    EXPECT_TRUE(pixelsOk) << "iteration " << iter;
+    }
+  }
+
+TEST(main,VectorImageDirtyUpload) {
+  using Range = std::pair<size_t,size_t>;
+  std::vector<int>   src(100), shadow;
+  std::vector<Range> upd;
+  auto update = [&]() {
+    upd.clear();
+    return Detail::updateDirty(shadow,src,[&](size_t off, size_t size){ upd.emplace_back(off,size); });
+    };
+
+  for(size_t i=0; i<src.size(); ++i)
+    src[i] = int(i);
+  Detail::growShadow(shadow,src);
+  EXPECT_EQ(update(),0u);
+  EXPECT_TRUE(upd.empty());
+
+  // chunks are 16 elements, adjacent ones go in one range
+  src[40] = -1;
+  src[50] = -1;
+  src[5]  = -1;
+  src[99] = -1;
+  EXPECT_EQ(update(),(16+32+4)*sizeof(int));
+  EXPECT_THAT(upd, ElementsAre(Range(0,16*sizeof(int)), Range(32*sizeof(int),32*sizeof(int)), Range(96*sizeof(int),4*sizeof(int))));
+  EXPECT_EQ(shadow,src);
+  EXPECT_EQ(update(),0u);
+
+  // shadow doesn't shrink
+  src.resize(10);
+  Detail::growShadow(shadow,src);
+  EXPECT_EQ(shadow.size(),200u);
+  }
+
+TEST(main,VectorImageRetained) {
+  struct Item : Widget {
+    Color cl;
+    int   paints = 0;
+    void paintEvent(PaintEvent& e) override {
+      Painter p(e);
+      p.setBrush(Brush(cl,Painter::NoBlend));
+      p.drawRect(0,0,w(),h());
+      paints++;
+      }
+    };
+  struct Root : Widget {
+    using Widget::dispatchPaintEvent;
+    };
+
+  TextureAtlas atlas;
+  VectorImage  img;
+  img.setRetained(true);
+
+  Root root;
+  root.resize(512,512);
+  std::vector<Item*> items;
+  for(int i=0; i<64; ++i) {
+    auto& it = root.addWidget(new Item());
+    it.setGeometry((i%8)*64,(i/8)*64,60,60);
+    it.cl = Color(float(i)/64.f,0.5f,0.5f,1);
+    items.push_back(&it);
+    }
+
+  auto frame = [&](VectorImage& img) {
+    img.clear();
+    PaintEvent e(img,atlas,512,512);
+    root.dispatchPaintEvent(e);
+    return VectorImageAccess::batched(img);
+    };
+  std::vector<PaintDevice::Quad> shadow;
+  Detail::growShadow(shadow,frame(img).quads);
+
+  items[10]->cl = Color(1,0,0,1);
+  items[10]->update();
+  const auto geom = frame(img);
+  EXPECT_EQ(items[10]->paints,2);
+  EXPECT_EQ(items[11]->paints,1);
+
+  // replayed geometry is same, as painted from scratch
+  VectorImage full;
+  const auto  ref = frame(full);
+  ASSERT_EQ(geom.quads.size(),ref.quads.size());
+  EXPECT_EQ(std::memcmp(geom.quads.data(),ref.quads.data(),ref.quads.size()*sizeof(PaintDevice::Quad)),0);
+  EXPECT_EQ(geom.pts.size(),ref.pts.size());
+
+  // only chunk of changed widget goes to gpu
+  const size_t bytes = Detail::updateDirty(shadow,geom.quads,[](size_t,size_t){});
+  EXPECT_EQ(bytes,16*sizeof(PaintDevice::Quad));
+  }
+
+TEST(main,VectorImageSvgCache) {
+  auto write = [](const char* svg) {
+    WFile f("tmp.svg");
+    f.write(svg,std::strlen(svg));
+    };
+  auto color = [](const VectorImage& img) {
+    auto g = VectorImageAccess::blocks(img);
+    return g.pts.empty() ? Color() : Color(g.pts[0].r,g.pts[0].g,g.pts[0].b,g.pts[0].a);
+    };
+
+  // same size, other content
+  write("<svg width=\"8\" height=\"8\"><rect width=\"8\" height=\"8\" fill=\"#f00\"/></svg>");
+  VectorImage a;
+  ASSERT_TRUE(a.load("tmp.svg"));
+  write("<svg width=\"8\" height=\"8\"><rect width=\"8\" height=\"8\" fill=\"#00f\"/></svg>");
+  VectorImage b;
+  ASSERT_TRUE(b.load("tmp.svg"));
+  EXPECT_EQ(color(a).r(),1.f);
+  EXPECT_EQ(color(b).r(),0.f);
+  EXPECT_EQ(color(b).b(),1.f);
+
+  // from cache and after clear: same geometry
+  VectorImage c, d;
+  ASSERT_TRUE(c.load("tmp.svg"));
+  VectorImage::clearCache();
+  ASSERT_TRUE(d.load("tmp.svg"));
+  auto gb = VectorImageAccess::blocks(b), gc = VectorImageAccess::blocks(c), gd = VectorImageAccess::blocks(d);
+  ASSERT_EQ(gc.pts.size(),gb.pts.size());
+  ASSERT_EQ(gd.pts.size(),gb.pts.size());
+  EXPECT_EQ(std::memcmp(gc.pts.data(),gb.pts.data(),gb.pts.size()*sizeof(PaintDevice::Point)),0);
+  EXPECT_EQ(std::memcmp(gd.pts.data(),gb.pts.data(),gb.pts.size()*sizeof(PaintDevice::Point)),0);
+
+  EXPECT_FALSE(d.load("missing.svg"));
+  }
+
+TEST(main,VectorImageTextEffect) {
+  Font fnt("assets/font/Roboto-Regular.ttf");
+  fnt.setPixelSize(24);
+  fnt.setDistanceField(true);
+  Font raster = fnt;
+  raster.setDistanceField(false);
+
+  TextureAtlas atlas;
+  VectorImage  img;
+  {
+  PaintEvent e(img,atlas,200,200);
+  Painter    p(e);
+  p.setFont(fnt);
+  p.drawText(0,20,"ab");
+  p.setTextOutline(2,Color(1,0,0,1));
+  p.drawText(0,60,"ab");
+  p.drawText(100,60,"cd");
+  p.setFont(raster);
+  p.drawText(0,100,"ab");
+  p.setFont(fnt);
+  p.setTextOutline(0,Color());
+  p.setTextGlow(3,Color(0,0,1,1));
+  p.drawText(0,140,"ab");
+  }
+
+  // one draw per effect: distance fields differ only in push constant
+  auto g = VectorImageAccess::batched(img);
+  std::vector<std::pair<float,float>> fx;
+  size_t raw = 0;
+  for(auto& d:g.draw) {
+    if(!d.distField) {
+      // effects apply to distance-field text only
+      EXPECT_EQ(d.fx.outline,0.f);
+      EXPECT_EQ(d.fx.glow,0.f);
+      raw++;
+      continue;
+      }
+    fx.push_back({d.fx.outline,d.fx.glow});
+    }
+  std::sort(fx.begin(),fx.end());
+  EXPECT_THAT(fx,ElementsAre(Pair(0.f,0.f),Pair(0.f,3.f),Pair(2.f,0.f)));
+  EXPECT_EQ(raw,1u);
+  for(auto& d:g.draw)
+    if(d.distField && d.fx.outline>0)
+      EXPECT_EQ(d.fx.outlineColor,Color(1,0,0,1));
+  }
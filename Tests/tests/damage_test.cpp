@@ -0,0 +1,79 @@
+#include <Tempest/Widget>
+#include <Tempest/Window>
+#include <Tempest/VectorImage>
+#include <Tempest/TextureAtlas>
+#include <Tempest/Except>
+#include <Tempest/Log>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+using namespace testing;
+using namespace Tempest;
+
+TEST(main,DamagedRect) {
+  Widget w;
+  EXPECT_TRUE(w.damagedRect().isEmpty());
+
+  Widget& b0=w.addWidget(new Widget());
+  Widget& b1=w.addWidget(new Widget());
+  b0.setGeometry(10,20,50,50);
+  EXPECT_EQ(w.damagedRect(),Rect(10,20,50,50));
+
+  // nested widgets are mapped to top-level
+  Widget& b00=b0.addWidget(new Widget());
+  b00.setGeometry(5,5,10,10);
+  b00.update(Rect(1,1,2,2));
+  EXPECT_EQ(w.damagedRect(),Rect(10,20,50,50));
+
+  b1.setGeometry(100,100,10,10);
+  EXPECT_EQ(w.damagedRect(),Rect(10,20,100,90));
+
+  // old place of moved widget is damaged too
+  Widget r;
+  Widget& m=r.addWidget(new Widget());
+  m.setGeometry(0,0,10,10);
+  m.setPosition(30,0);
+  EXPECT_EQ(r.damagedRect(),Rect(0,0,40,10));
+
+  Widget h;
+  Widget& hx=h.addWidget(new Widget());
+  hx.setVisible(false);
+  hx.setGeometry(0,0,10,10);
+  hx.update();
+  EXPECT_TRUE(h.damagedRect().isEmpty());
+  }
+
+TEST(main,DamageWindowPending) {
+  struct Wnd : Window {
+    using Window::dispatchPaintEvent;
+    };
+
+  try {
+    Wnd          w;
+    VectorImage  img;
+    TextureAtlas ta;
+    Widget& panel = w.addWidget(new Widget());
+    Widget& empty = panel.addWidget(new Widget());
+    Widget& btn   = panel.addWidget(new Widget());
+    panel.setGeometry(0,0,100,100);
+    btn  .setGeometry(10,10,10,10);
+    w.dispatchPaintEvent(img,ta,Color());
+    EXPECT_FALSE(w.needToUpdate());
+
+    // update of zero-sized widget damages nothing, but must not keep window pending
+    empty.update();
+    EXPECT_TRUE(w.needToUpdate());
+    EXPECT_TRUE(w.dispatchPaintEvent(img,ta,Color()).isEmpty());
+    EXPECT_FALSE(w.needToUpdate());
+
+    // panel was not painted and still has the flag: update reaches the window anyway
+    btn.update();
+    EXPECT_TRUE(w.needToUpdate());
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::SystemErrc::UnableToCreateWindow)
+      Log::d("Skipping window testcase: ", e.what()); else
+      throw;
+    }
+  }
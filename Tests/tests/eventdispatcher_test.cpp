@@ -80,3 +80,87 @@ TEST(main,EventDispatcher_MouseEvent) {
   EXPECT_EQ(b0.up,  1);
   EXPECT_EQ(b0.move,1);
   }
+
+TEST(main,EventDispatcher_HitIndex) {
+  // flat grid of 100x100 buttons, placed without layout
+  Widget wx;
+  wx.resize(1000,1000);
+
+  EventDispatcher dis(wx);
+
+  std::vector<TstButton*> b;
+  for(int y=0; y<100; ++y)
+    for(int x=0; x<100; ++x) {
+      auto& bx = wx.addWidget(new TstButton());
+      bx.setGeometry(x*10,y*10,10,10);
+      b.push_back(&bx);
+      }
+
+  auto click = [&](int x, int y) {
+    auto down = mkMEvent(Event::MouseDown,x,y);
+    dis.dispatchMouseDown(wx,down);
+    auto up   = mkMEvent(Event::MouseUp,x,y);
+    dis.dispatchMouseUp(wx,up);
+    };
+
+  click(5,5);
+  click(995,995);
+  click(503,217);
+  EXPECT_EQ(b[0]->down,1);
+  EXPECT_EQ(b[9999]->down,1);
+  EXPECT_EQ(b[21*100+50]->down,1);
+
+  // topmost widget wins
+  TstButton& top = wx.addWidget(new TstButton());
+  top.setGeometry(200,200,100,100);
+  click(250,250);
+  EXPECT_EQ(top.down,1);
+  EXPECT_EQ(b[25*100+25]->down,0);
+
+  top.setVisible(false);
+  click(250,250);
+  EXPECT_EQ(top.down,1);
+  EXPECT_EQ(b[25*100+25]->down,1);
+
+  // moved widget is found at new place, even out of former bounds
+  b[0]->setPosition(1005,5);
+  click(1007,7);
+  EXPECT_EQ(b[0]->down,2);
+  click(5,5);
+  EXPECT_EQ(b[0]->down,2);
+
+  // removed widget doesn't get events, neighbours still do
+  delete b[50*100+50];
+  b[50*100+50] = nullptr;
+  int downs = 0;
+  for(auto i:b)
+    if(i!=nullptr)
+      downs += i->down;
+  click(505,505);
+  int downsAfter = 0;
+  for(auto i:b)
+    if(i!=nullptr)
+      downsAfter += i->down;
+  EXPECT_EQ(downsAfter,downs);
+  click(515,505);
+  click(505,495);
+  EXPECT_EQ(b[50*100+51]->down,1);
+  EXPECT_EQ(b[49*100+50]->down,1);
+
+  const int count  = 10000;
+  int       hidden = 0;
+  for(int i=0; i<count; ++i) {
+    const int x = (i*37)%1000, y = (i*91)%1000;
+    if((x<10 && y<10) || (x/10==50 && y/10==50))
+      ++hidden;
+    auto e = mkMEvent(Event::MouseMove,x,y);
+    dis.dispatchMouseMove(wx,e);
+    }
+
+  int moves = 0;
+  for(auto i:b)
+    if(i!=nullptr)
+      moves += i->move;
+  EXPECT_EQ(top.move,0);
+  EXPECT_EQ(moves,count-hidden);
+  }
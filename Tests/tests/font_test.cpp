@@ -0,0 +1,441 @@
+#include <Tempest/Font>
+#include <Tempest/FontCollection>
+#include <Tempest/Platform>
+#include <Tempest/TextLayout>
+#include <Tempest/Application>
+#include <Tempest/TextureAtlas>
+
+#include "utils/fontaccess.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Tempest;
+using Detail::FontAccess;
+
+static size_t residentBytes() {
+#if defined(__LINUX__)
+  // second field of statm: resident pages
+  std::FILE* f = std::fopen("/proc/self/statm","r");
+  if(f==nullptr)
+    return 0;
+  unsigned long pages=0, rss=0;
+  if(std::fscanf(f,"%lu %lu",&pages,&rss)!=2)
+    rss = 0;
+  std::fclose(f);
+  return size_t(rss)*4096;
+#else
+  return 0;
+#endif
+  }
+
+TEST(main,FontFileSharing) {
+  const char*       path    = "assets/font/Roboto-Regular.ttf";
+  const size_t      fileSz  = RFile(path).size();
+  static const float sizes[] = {8,10,12,14,18,24,32,48};
+
+  std::vector<FontElement> fonts;
+  for(size_t i=0; i<std::size(sizes); ++i)
+    fonts.emplace_back(path);
+
+  // all elements parse one mapping of the file, instead of a copy each
+  const uint8_t* data = FontAccess::data(fonts[0]);
+  ASSERT_NE(data,nullptr);
+  for(auto& i:fonts)
+    EXPECT_EQ(FontAccess::data(i),data);
+
+  // in-memory font owns its copy
+  std::vector<uint8_t> buf(fileSz);
+  RFile(path).read(buf.data(),buf.size());
+  FontElement copy(buf.data(),buf.size());
+  EXPECT_NE(FontAccess::data(copy),data);
+  EXPECT_NE(FontAccess::data(copy),buf.data());
+
+  for(size_t i=1; i<fonts.size(); ++i)
+    EXPECT_GT(fonts[i].textSize("Tempest",sizes[i]).w, fonts[i-1].textSize("Tempest",sizes[i-1]).w);
+
+  // mapping outlives elements, that are destroyed
+  fonts.erase(fonts.begin());
+  EXPECT_EQ(FontAccess::data(fonts[0]),data);
+  }
+
+TEST(main,DISABLED_FontFileSharingBenchmark) {
+  using clock = std::chrono::steady_clock;
+  const char*       path    = "assets/font/Roboto-Regular.ttf";
+  static const float sizes[] = {8,10,12,14,18,24,32,48};
+
+  std::vector<Font> fonts;
+  const size_t rss0 = residentBytes();
+  auto         t0   = clock::now();
+  for(float sz:sizes) {
+    Font fnt(path);
+    fnt.setPixelSize(sz);
+    // touch glyph tables, so file pages become resident
+    fnt.textSize("The quick brown fox jumps over the lazy dog");
+    fonts.push_back(fnt);
+    }
+  auto         t1   = clock::now();
+  const size_t rss1 = residentBytes();
+
+  const double us   = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t0).count())/1000.0;
+  const size_t grow = rss1>rss0 ? rss1-rss0 : 0;
+  std::printf("[          ] %d fonts: load %.0f us, rss grow %zu KiB, file %zu KiB\n",
+              int(std::size(sizes)), us, grow/1024, size_t(RFile(path).size())/1024);
+  }
+
+TEST(main,FontConcurrentLookup) {
+  const char* path = "assets/font/Roboto-Regular.ttf";
+  FontElement shared(path);
+  FontElement ref(path);
+
+  // latin-1 slots and trie beyond them, at few sizes
+  std::vector<char32_t> chars;
+  for(char32_t c=0x20; c<0x250; ++c)
+    chars.push_back(c);
+  static const float sizes[] = {10,13,16,24};
+  const size_t count = chars.size()*std::size(sizes);
+  auto lookup = [&](const FontElement& fnt, size_t i) -> const FontElement::LetterGeometry& {
+    return fnt.letterGeometry(chars[i%chars.size()],sizes[i/chars.size()]);
+    };
+
+  // threads walk in opposite directions, so they insert same glyphs at once
+  const size_t threads = 8;
+  std::vector<std::vector<const FontElement::LetterGeometry*>> got(threads);
+  std::vector<std::thread> th;
+  for(size_t t=0; t<threads; ++t) {
+    th.emplace_back([&,t]() {
+      got[t].resize(count);
+      for(size_t n=0; n<count; ++n) {
+        const size_t i = (t%2==0) ? n : count-1-n;
+        got[t][i] = &lookup(shared,i);
+        }
+      });
+    }
+  for(auto& i:th)
+    i.join();
+
+  // one entry per glyph, same as looked up by a single thread
+  size_t moved = 0, differ = 0;
+  for(size_t i=0; i<count; ++i) {
+    for(size_t t=1; t<threads; ++t)
+      if(got[t][i]!=got[0][i])
+        moved++;
+    auto& a = *got[0][i];
+    auto& b = lookup(ref,i);
+    if(!(a.size==b.size && a.dpos==b.dpos && a.advance==b.advance))
+      differ++;
+    }
+  EXPECT_EQ(moved, 0u);
+  EXPECT_EQ(differ,0u);
+  EXPECT_EQ(&lookup(shared,count-1),got[0][count-1]);
+  }
+
+TEST(main,FontPrefetch) {
+  const char* path = "assets/font/Roboto-Regular.ttf";
+  TextureAtlas atlas;
+
+  // enough glyphs to be split between worker threads
+  for(bool sdf:{false,true}) {
+    Font fnt(path), ref(path);
+    for(auto f:{&fnt,&ref}) {
+      f->setPixelSize(16);
+      f->setDistanceField(sdf);
+      }
+    fnt.prefetch(0x20,0x17F,atlas);
+
+    size_t differ = 0, again = 0;
+    for(char32_t c=0x20; c<0x180; ++c) {
+      auto& a = fnt.letter(c,atlas);
+      auto& b = ref.letter(c,atlas);
+      if(!(a.size==b.size && a.dpos==b.dpos && a.advance==b.advance && a.hasView==b.hasView))
+        differ++;
+      if(a.view.w()!=b.view.w() || a.view.h()!=b.view.h())
+        differ++;
+      // prefetched letter is served from cache
+      if(&fnt.letter(c,atlas)!=&a || !a.hasView)
+        again++;
+      }
+    EXPECT_EQ(differ,0u) << "sdf " << sdf;
+    EXPECT_EQ(again, 0u) << "sdf " << sdf;
+    }
+  }
+
+TEST(main,DistanceFieldAtlasReuse) {
+  Font fnt("assets/font/Roboto-Regular.ttf");
+  fnt.setDistanceField(true);
+  TextureAtlas atlas;
+
+  // one distance field per glyph serves every size: same atlas entries, scaled on draw
+  std::vector<TextLayout::Glyph> ref;
+  float                          refSz = 0;
+  for(float sz:{12.f,24.f,48.f,96.f}) {
+    fnt.setPixelSize(sz);
+    TextLayout l(fnt,"Tempest",TextLayout::SingleLine,&atlas);
+    ASSERT_TRUE(l.isDistanceField());
+    ASSERT_EQ(l.glyphs().size(),7u);
+    if(ref.empty()) {
+      ref   = l.glyphs();
+      refSz = sz;
+      continue;
+      }
+    for(size_t i=0; i<ref.size(); ++i) {
+      auto& a = ref[i].view;
+      auto& b = l.glyphs()[i].view;
+      EXPECT_EQ(a.pageId(),b.pageId());
+      EXPECT_EQ(a.pageRect(),b.pageRect());
+      EXPECT_NEAR(l.glyphs()[i].w,ref[i].w*sz/refSz,1e-3f);
+      }
+    }
+
+  // raster glyphs take an entry per size
+  Font raster("assets/font/Roboto-Regular.ttf");
+  raster.setPixelSize(12);
+  TextLayout a(raster,"T",TextLayout::SingleLine,&atlas);
+  raster.setPixelSize(24);
+  TextLayout b(raster,"T",TextLayout::SingleLine,&atlas);
+  ASSERT_FALSE(a.isDistanceField());
+  EXPECT_NE(a.glyphs()[0].view.pageRect(),b.glyphs()[0].view.pageRect());
+  }
+
+TEST(main,TextLayoutWrap) {
+  Font fnt = Application::defaultFont();
+  fnt.setPixelSize(16);
+  auto width = [&](const char* txt) {
+    return TextLayout(fnt,txt).size().w;
+    };
+
+  // kerned pairs: line fits by shaped advances, not by sum of letter advances
+  int sum = 0;
+  for(const char* c="AVAVAV AVAVAV"; *c; ++c)
+    sum += fnt.letterGeometry(char32_t(*c)).advance.x;
+  const int w = width("AVAVAV AVAVAV");
+  ASSERT_LT(w,sum);
+  EXPECT_EQ(TextLayout(fnt,"AVAVAV AVAVAV",w).lines().size(),1u);
+  EXPECT_EQ(TextLayout(fnt,"AVAVAV AVAVAV",w-1).lines().size(),2u);
+
+  // greedy: each line fits, and next word does not fit on it
+  const std::vector<std::string> words = {"The","quick","brown","fox","jumps","over","the","lazy","dog,","again","and","again"};
+  std::string text;
+  for(auto& i:words)
+    text += (text.empty() ? "" : " ")+i;
+  const int  wrap = 100;
+  TextLayout l(fnt,text.c_str(),wrap);
+  ASSERT_GT(l.lines().size(),2u);
+
+  // one glyph per letter, spaces have none
+  size_t wd = 0;
+  for(auto& ln:l.lines()) {
+    EXPECT_LE(ln.width,wrap);
+    std::string cur;
+    size_t      letters = 0;
+    while(wd<words.size() && letters<ln.end-ln.begin) {
+      letters += words[wd].size();
+      cur     += (cur.empty() ? "" : " ")+words[wd];
+      ++wd;
+      }
+    EXPECT_EQ(letters,ln.end-ln.begin);
+    EXPECT_EQ(ln.width,width(cur.c_str()));
+    if(wd<words.size()) {
+      EXPECT_GT(width((cur+" "+words[wd]).c_str()),wrap) << cur;
+      }
+    }
+  EXPECT_EQ(wd,words.size());
+  EXPECT_EQ(l.size().h,int(l.lines().size())*16);
+
+  // single word, that doesn't fit, is broken by letters
+  TextLayout narrow(fnt,"Tempest",20);
+  EXPECT_GT(narrow.lines().size(),1u);
+  for(auto& ln:narrow.lines())
+    EXPECT_GT(ln.end,ln.begin);
+  }
+
+TEST(main,TextLayoutSingleLine) {
+  Font fnt = Application::defaultFont();
+  fnt.setPixelSize(16);
+  EXPECT_EQ(TextLayout(fnt,"first\nsecond").lines().size(),2u);
+  EXPECT_EQ(TextLayout(fnt,"first\r\nsecond\n").lines().size(),2u);
+  // Painter::drawText(x,y,txt) doesn't break lines
+  EXPECT_EQ(TextLayout(fnt,"first\nsecond",TextLayout::SingleLine).lines().size(),1u);
+  }
+
+namespace {
+
+// minimal TrueType font: codepoints [first,last] map to empty glyphs of given advance, in units of 1000/em
+std::vector<uint8_t> makeFont(char32_t first, char32_t last, uint16_t advance) {
+  std::vector<uint8_t> out;
+  auto u16 = [](std::vector<uint8_t>& v, uint32_t x) { v.push_back(uint8_t(x>>8)); v.push_back(uint8_t(x)); };
+  auto u32 = [&](std::vector<uint8_t>& v, uint32_t x) { u16(v,x>>16); u16(v,x&0xFFFF); };
+
+  const uint16_t numGlyphs = uint16_t(last-first+2);
+
+  std::vector<uint8_t> head;
+  u32(head,0x00010000); u32(head,0); u32(head,0); u32(head,0x5F0F3CF5);
+  u16(head,0); u16(head,1000);
+  for(int i=0; i<16; ++i)
+    head.push_back(0);
+  u16(head,0); u16(head,0); u16(head,1000); u16(head,1000);
+  u16(head,0); u16(head,8); u16(head,2);
+  u16(head,0); u16(head,0);
+
+  std::vector<uint8_t> hhea;
+  u32(hhea,0x00010000); u16(hhea,800); u16(hhea,uint16_t(-200)); u16(hhea,0);
+  u16(hhea,advance);
+  for(int i=0; i<11; ++i)
+    u16(hhea,0);
+  u16(hhea,numGlyphs);
+
+  std::vector<uint8_t> maxp;
+  u32(maxp,0x00005000); u16(maxp,numGlyphs);
+
+  std::vector<uint8_t> hmtx, loca, glyf(4,0);
+  for(uint16_t i=0; i<numGlyphs; ++i) {
+    u16(hmtx,advance);
+    u16(hmtx,0);
+    }
+  for(uint16_t i=0; i<=numGlyphs; ++i)
+    u16(loca,0);
+
+  // format 4: one segment of codepoints with delta to glyph 1, and terminating 0xFFFF
+  std::vector<uint8_t> cmap;
+  u16(cmap,0); u16(cmap,1);
+  u16(cmap,3); u16(cmap,1); u32(cmap,12);
+  u16(cmap,4); u16(cmap,16+4*2*2); u16(cmap,0);
+  u16(cmap,2*2); u16(cmap,2*2); u16(cmap,1); u16(cmap,0);
+  u16(cmap,uint32_t(last)); u16(cmap,0xFFFF);
+  u16(cmap,0);
+  u16(cmap,uint32_t(first)); u16(cmap,0xFFFF);
+  u16(cmap,(1u-uint32_t(first))&0xFFFF); u16(cmap,1);
+  u16(cmap,0); u16(cmap,0);
+
+  const std::pair<const char*,std::vector<uint8_t>*> tables[] = {
+    {"cmap",&cmap},{"glyf",&glyf},{"head",&head},{"hhea",&hhea},{"hmtx",&hmtx},{"loca",&loca},{"maxp",&maxp}
+    };
+  const uint16_t cnt = uint16_t(std::size(tables));
+  u32(out,0x00010000); u16(out,cnt); u16(out,64); u16(out,2); u16(out,cnt*16-64);
+  uint32_t at = 12+16*cnt;
+  for(auto& t:tables) {
+    out.insert(out.end(),t.first,t.first+4);
+    u32(out,0);
+    u32(out,at);
+    u32(out,uint32_t(t.second->size()));
+    at += uint32_t((t.second->size()+3)&~size_t(3));
+    }
+  for(auto& t:tables) {
+    out.insert(out.end(),t.second->begin(),t.second->end());
+    out.resize((out.size()+3)&~size_t(3));
+    }
+  return out;
+  }
+
+int advanceOf(const FontElement* f, char32_t ch) {
+  return f==nullptr ? -1 : f->letterGeometry(ch,1000).advance.x;
+  }
+}
+
+TEST(main,FontCollectionFind) {
+  const auto  latin = makeFont('a','z',500);
+  const auto  cjk   = makeFont(0x4E00,0x4E0F,1000);
+  const auto  abc   = makeFont('a','c',700);
+  FontElement fLatin(latin.data(),latin.size());
+  FontElement fCjk  (cjk.data(),  cjk.size());
+  FontElement fAbc  (abc.data(),  abc.size());
+  ASSERT_TRUE (fLatin.hasGlyph('q'));
+  ASSERT_FALSE(fLatin.hasGlyph(0x4E01));
+  ASSERT_TRUE (fCjk.hasGlyph(0x4E01));
+  ASSERT_FALSE(fCjk.hasGlyph('q'));
+
+  // disjoint coverage: each codepoint goes to the font, that has it
+  FontCollection fc = {fLatin,fCjk};
+  EXPECT_EQ(fc.size(),2u);
+  EXPECT_EQ(advanceOf(fc.find('q'),'q'),500);
+  EXPECT_EQ(advanceOf(fc.find(0x4E01),0x4E01),1000);
+  // cached lookup gives same font
+  EXPECT_EQ(fc.find('q'),fc.find('z'));
+
+  // none of fonts has it
+  EXPECT_EQ(fc.find(0x0416),nullptr);
+  EXPECT_EQ(fc.find(0x0416),nullptr);
+  EXPECT_EQ(fc.find(0x110000),nullptr);
+
+  // first match wins, where coverage overlaps
+  FontCollection first = {fLatin,fAbc};
+  FontCollection last  = {fAbc,fLatin};
+  EXPECT_EQ(advanceOf(first.find('b'),'b'),500);
+  EXPECT_EQ(advanceOf(last .find('b'),'b'),700);
+  EXPECT_EQ(advanceOf(last .find('q'),'q'),500);
+
+  // add() makes a new list: copy, that resolved codepoint as missing, stays as is
+  FontCollection ext = fc;
+  const auto     cyr = makeFont(0x0410,0x044F,600);
+  ext.add(FontElement(cyr.data(),cyr.size()));
+  EXPECT_EQ(ext.size(),3u);
+  EXPECT_EQ(fc .size(),2u);
+  EXPECT_EQ(advanceOf(ext.find(0x0416),0x0416),600);
+  EXPECT_EQ(fc.find(0x0416),nullptr);
+  EXPECT_EQ(advanceOf(ext.find('q'),'q'),500);
+  }
+
+TEST(main,FontFallback) {
+  const auto  latin = makeFont('a','z',500);
+  const auto  cjk   = makeFont(0x4E00,0x4E0F,1000);
+  const auto  cjk2  = makeFont(0x4E00,0x4E0F,800);
+  FontElement fLatin(latin.data(),latin.size());
+
+  Font a(fLatin,fLatin,fLatin,fLatin);
+  a.setPixelSize(1000);
+  Font b = a;
+  a.setFallback(FontCollection{FontElement(cjk.data(),cjk.size())});
+  b.setFallback(FontCollection{FontElement(cjk2.data(),cjk2.size())});
+
+  // each font resolves missing glyphs through its own list
+  EXPECT_EQ(a.letterGeometry(char32_t(0x4E01)).advance.x,1000);
+  EXPECT_EQ(b.letterGeometry(char32_t(0x4E01)).advance.x,800);
+  EXPECT_EQ(a.letterGeometry(char32_t('q')).advance.x,500);
+  a.setBold(true);
+  EXPECT_EQ(a.letterGeometry(char32_t(0x4E02)).advance.x,1000);
+
+  // element, fallback was set from, is not changed
+  EXPECT_FALSE(fLatin.hasGlyph(0x4E01));
+  EXPECT_EQ(FontCollection{}.find(0x4E01),nullptr);
+  // empty list: .notdef of the font itself
+  a.setFallback(FontCollection{});
+  EXPECT_EQ(a.letterGeometry(char32_t(0x4E01)).advance.x,fLatin.letterGeometry(0x4E01,1000).advance.x);
+  }
+
+#if defined(__LINUX__)
+TEST(main,FontCollectionDiscovery) {
+  namespace fs = std::filesystem;
+  const fs::path dir = fs::temp_directory_path()/"tempest_fonts_test";
+  fs::create_directories(dir/"fonts"/"sub");
+  for(auto name:{"zzz.ttf","aaa.OTF","sub/Roboto-Regular.ttf","readme.txt"}) {
+    std::FILE* f = std::fopen((dir/"fonts"/name).string().c_str(),"wb");
+    if(f!=nullptr)
+      std::fclose(f);
+    }
+
+  const char* prev = std::getenv("XDG_DATA_HOME");
+  const std::string saved = prev!=nullptr ? prev : "";
+  setenv("XDG_DATA_HOME",dir.string().c_str(),1);
+  auto files = FontCollection::systemFontFiles();
+  if(prev!=nullptr)
+    setenv("XDG_DATA_HOME",saved.c_str(),1); else
+    unsetenv("XDG_DATA_HOME");
+  fs::remove_all(dir);
+
+  // preferred fonts first, then the rest of discovered fonts by path
+  std::vector<std::string> own;
+  for(auto& i:files)
+    if(i.rfind(dir.string(),0)==0)
+      own.push_back(i.substr(dir.string().size()));
+  const std::vector<std::string> expect = {"/fonts/sub/Roboto-Regular.ttf","/fonts/aaa.OTF","/fonts/zzz.ttf"};
+  EXPECT_EQ(own,expect);
+  }
+#endif
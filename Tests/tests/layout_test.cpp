@@ -1,8 +1,13 @@
 #include <Tempest/Widget>
+#include <Tempest/Layout>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock-matchers.h>
 
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
 using namespace testing;
 using namespace Tempest;
 
@@ -68,3 +73,123 @@ TEST(main,LinearLayoutVisibility) {
     b[i]->setVisible(false);
     }
   }
+
+namespace {
+struct Leaf : Widget {
+  using Widget::setSizeHint;
+  };
+
+// height depends on width, like wrapped text
+struct Wrap : Widget {
+  Wrap() { setSizePolicy(Preferred,Fixed); }
+  void resizeEvent(SizeEvent& e) override {
+    if(e.w>0)
+      setSizeHint(Size(0,int(1000/e.w)));
+    }
+  };
+}
+
+TEST(main,LinearLayoutHintFromResize) {
+  Widget w;
+  w.resize(100,1000);
+  w.setMargins(Margin(0));
+  w.setLayout(Vertical);
+
+  Widget& b0 = w.addWidget(new Wrap());
+  w.addWidget(new Widget());
+  EXPECT_EQ(b0.w(),100);
+  EXPECT_EQ(b0.h(),10);
+
+  w.resize(50,1000);
+  EXPECT_EQ(b0.w(),50);
+  EXPECT_EQ(b0.h(),20);
+  }
+
+namespace {
+// 100 rows of 100 leafs
+Leaf* buildLarge(Widget& root) {
+  root.resize(1000,1000);
+  root.setLayout(Vertical);
+  Leaf*  leaf = nullptr;
+  for(int r=0; r<100; ++r) {
+    Widget& row = root.addWidget(new Widget());
+    row.setLayout(Horizontal);
+    for(int c=0; c<100; ++c) {
+      auto& l = row.addWidget(new Leaf());
+      l.setSizePolicy(Fixed);
+      l.setSizeHint(Size(8,8));
+      if(r==50 && c==50)
+        leaf = &l;
+      }
+    }
+  return leaf;
+  }
+
+size_t measureCount(const Widget& w) {
+  auto lay = dynamic_cast<const LinearLayout*>(&w.layout());
+  return lay==nullptr ? 0 : lay->measureCount();
+  }
+}
+
+TEST(main,LinearLayoutLarge) {
+  Widget root;
+  Leaf*  leaf = buildLarge(root);
+  Widget& row = *leaf->owner();
+
+  std::vector<size_t> cnt;
+  auto snapshot = [&]() {
+    cnt.clear();
+    cnt.push_back(measureCount(root));
+    for(size_t i=0; i<root.widgetsCount(); ++i)
+      cnt.push_back(measureCount(root.widget(i)));
+    };
+
+  // leaf change measures its ancestor chain only
+  snapshot();
+  const auto before = cnt;
+  for(int i=0; i<1000; ++i)
+    leaf->setSizeHint(Size(9+(i&1),8));
+  snapshot();
+  for(size_t i=0; i<root.widgetsCount(); ++i) {
+    if(&root.widget(i)==&row)
+      EXPECT_EQ(cnt[i+1],before[i+1]+1000); else
+      EXPECT_EQ(cnt[i+1],before[i+1]) << "row " << i;
+    }
+  // hints don't propagate above owner of leaf
+  EXPECT_EQ(cnt[0],before[0]);
+
+  // resize reuses measured sizes at every level
+  for(int i=0; i<100; ++i)
+    root.resize(1000+(i&1),1000);
+  const auto resized = cnt;
+  snapshot();
+  EXPECT_EQ(cnt,resized);
+
+  EXPECT_EQ(leaf->w(),10);
+  EXPECT_GE(row.widget(51).x(),leaf->x()+leaf->w()+row.spacing());
+  }
+
+TEST(main,DISABLED_LinearLayoutBenchmark) {
+  using clock = std::chrono::steady_clock;
+  auto us = [](clock::duration d) {
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count())/1000.0;
+    };
+
+  auto   t0   = clock::now();
+  Widget root;
+  Leaf*  leaf = buildLarge(root);
+  auto   t1   = clock::now();
+
+  const int leafCount = 1000;
+  for(int i=0; i<leafCount; ++i)
+    leaf->setSizeHint(Size(9+(i&1),8));
+  auto t2 = clock::now();
+
+  const int resizeCount = 100;
+  for(int i=0; i<resizeCount; ++i)
+    root.resize(1000+(i&1),1000);
+  auto t3 = clock::now();
+
+  std::printf("[          ] 10k widgets: build %.0f us, leaf change %.2f us, root resize %.2f us\n",
+              us(t1-t0), us(t2-t1)/leafCount, us(t3-t2)/resizeCount);
+  }
@@ -0,0 +1,128 @@
+#include <Tempest/ListView>
+#include <Tempest/ScrollWidget>
+#include <Tempest/Button>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace Tempest;
+
+namespace {
+
+struct Item : Widget {
+  Item(size_t pos):pos(pos) {
+    setSizeHint(Size(100,20));
+    }
+  size_t pos = 0;
+  };
+
+struct Delegate : ListDelegate {
+  size_t size() const override { return 100000; }
+
+  Widget* createView(size_t position) override {
+    ++created;
+    return new Item(position);
+    }
+
+  Widget* update(Widget* w, size_t position) override {
+    static_cast<Item*>(w)->pos = position;
+    return w;
+    }
+
+  size_t created = 0;
+  };
+
+// stock delegate: views show text of item, counted on creation
+struct Counted : ArrayListDelegate<std::string> {
+  using ArrayListDelegate<std::string>::ArrayListDelegate;
+  using ListDelegate::createView;
+  Widget* createView(size_t position) override {
+    ++created;
+    return ArrayListDelegate<std::string>::createView(position);
+    }
+  size_t created = 0;
+  };
+
+size_t itemAt(Widget& content, int y) {
+  for(size_t i=0; i<content.widgetsCount(); ++i) {
+    auto& w = content.widget(i);
+    if(w.y()<=y && y<w.y()+w.h())
+      return static_cast<Item&>(w).pos;
+    }
+  return size_t(-1);
+  }
+}
+
+TEST(main,ListViewVirtualized) {
+  ListView list;
+  list.setVirtualized(true);
+  list.resize(200,400);
+
+  auto d = list.setDelegate(new Delegate());
+  auto& sc      = dynamic_cast<ScrollWidget&>(list.widget(0));
+  auto& content = list.centralWidget().widget(0);
+
+  EXPECT_EQ(content.h(),100000*20);
+  // visible 20 items and a margin of half-screen
+  EXPECT_LE(content.widgetsCount(),size_t(42));
+  EXPECT_EQ(itemAt(content,0),  size_t(0));
+  EXPECT_EQ(itemAt(content,390),size_t(19));
+
+  for(int i=0; i<1000; ++i)
+    sc.scrollV(i*1000);
+  // views are recycled
+  EXPECT_LE(content.widgetsCount(),size_t(42));
+  EXPECT_LE(d->created,size_t(64));
+
+  sc.scrollV(500000);
+  EXPECT_EQ(sc.scrollV(),500000);
+  EXPECT_EQ(itemAt(content,500000),   size_t(25000));
+  EXPECT_EQ(itemAt(content,500000+390),size_t(25019));
+  }
+
+TEST(main,ListViewRecycledText) {
+  std::vector<std::string> data;
+  for(int i=0; i<1000; ++i)
+    data.push_back("item " + std::to_string(i));
+
+  ListView list;
+  list.setVirtualized(true);
+  list.resize(200,400);
+  auto  d       = list.setDelegate(new Counted(data));
+  auto& sc      = dynamic_cast<ScrollWidget&>(list.widget(0));
+  auto& content = list.centralWidget().widget(0);
+  ASSERT_GT(content.widgetsCount(),0u);
+  const int step = content.widget(0).h();
+  ASSERT_GT(step,0);
+
+  // every view shows item at its place
+  auto check = [&]() {
+    size_t cnt = 0;
+    for(size_t i=0; i<content.widgetsCount(); ++i) {
+      auto& b = dynamic_cast<Button&>(content.widget(i));
+      EXPECT_EQ(b.y()%step,0);
+      EXPECT_STREQ(b.text().c_str(),data[size_t(b.y()/step)].c_str());
+      cnt++;
+      }
+    return cnt;
+    };
+  EXPECT_GT(check(),0u);
+
+  const size_t created = d->created;
+  for(int y : {step*10+3, step*500, step*37, step*990, 0}) {
+    sc.scrollV(y);
+    EXPECT_GT(check(),0u) << "scroll " << y;
+    }
+  // views of other items got new text, instead of new views
+  EXPECT_LE(d->created,created*2);
+
+  // new data, same views: item size is not measured again
+  data[0] = "first";
+  const size_t before = d->created;
+  for(int i=0; i<10; ++i)
+    d->updateView();
+  EXPECT_EQ(d->created,before);
+  check();
+  }
@@ -1,10 +1,14 @@
 #include <Tempest/Pixmap>
+#include <Tempest/PixmapCodec>
+#include <Tempest/File>
 #include <Tempest/MemWriter>
 #include <Tempest/MemReader>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock-matchers.h>
 
+#include <cstring>
+
 using namespace testing;
 using namespace Tempest;
 
@@ -40,6 +44,28 @@ TEST(main,PixmapIO_SymetricIO) {
     }
   }
 
+TEST(main,PixmapMapped) {
+  MappedFile dds("assets/pixmap_io/dxt5.dds");
+  Pixmap     pm(dds);
+  EXPECT_EQ(pm.w(),     512);
+  EXPECT_EQ(pm.h(),     512);
+  EXPECT_EQ(pm.format(),TextureFormat::DXT5);
+
+  auto* begin = dds.data();
+  auto* px    = reinterpret_cast<const uint8_t*>(static_cast<const Pixmap&>(pm).data());
+  EXPECT_TRUE(begin<=px && px+pm.dataSize()<=begin+dds.size());
+
+  Pixmap ref("assets/pixmap_io/dxt5.dds");
+  EXPECT_EQ(ref.dataSize(),pm.dataSize());
+  EXPECT_EQ(std::memcmp(ref.data(),px,pm.dataSize()),0);
+
+  MappedFile png("assets/pixmap_io/rgba.png");
+  Pixmap     pm2(png);
+  EXPECT_EQ(pm2.w(),     256);
+  EXPECT_EQ(pm2.h(),     256);
+  EXPECT_EQ(pm2.format(),TextureFormat::RGBA8);
+  }
+
 TEST(main,PixmapConv) {
   Pixmap pm("assets/pixmap_io/dxt5.dds");
   EXPECT_EQ(pm.w(),     512);
@@ -54,3 +80,67 @@ TEST(main,PixmapConv) {
   EXPECT_EQ(px1.format(),TextureFormat::RGBA16);
   px1.save("tst-dxt5.png");
   }
+
+TEST(main,PixmapMips) {
+  Pixmap pm("assets/pixmap_io/rgba.png");
+  pm.generateMips(Pixmap::MipFilter::Kaiser,true);
+  EXPECT_EQ(pm.mipCount(),9);
+  EXPECT_EQ(pm.dataSize(),size_t(4*(256*256+128*128+64*64+32*32+16*16+8*8+4*4+2*2+1)));
+
+  Pixmap solid(5,3,TextureFormat::RGBA8);
+  auto*  px = reinterpret_cast<uint8_t*>(solid.data());
+  for(size_t i=0; i<5*3; ++i) {
+    px[i*4+0] = 200;
+    px[i*4+1] = 100;
+    px[i*4+2] = 50;
+    px[i*4+3] = 255;
+    }
+  for(auto f:{Pixmap::MipFilter::Box,Pixmap::MipFilter::Lanczos,Pixmap::MipFilter::Kaiser}) {
+    Pixmap mip = solid;
+    mip.generateMips(f,true);
+    EXPECT_EQ(mip.mipCount(),3);
+    // 5x3 -> 2x1 -> 1x1
+    auto* last = reinterpret_cast<const uint8_t*>(mip.data()) + 4*(5*3+2*1);
+    EXPECT_NEAR(last[0],200,1);
+    EXPECT_NEAR(last[1],100,1);
+    EXPECT_NEAR(last[2],50, 1);
+    EXPECT_EQ  (last[3],255);
+    }
+
+  Pixmap dxt(pm,TextureFormat::DXT5);
+  EXPECT_EQ(dxt.mipCount(),9);
+
+  Pixmap dds("assets/pixmap_io/dxt5.dds");
+  dds.generateMips(Pixmap::MipFilter::Box,false);
+  EXPECT_EQ(dds.format(),  TextureFormat::DXT5);
+  EXPECT_EQ(dds.mipCount(),10);
+  }
+
+TEST(main,PixmapStreamDecode) {
+  static const char* files[] = {"assets/pixmap_io/rgba.png", "assets/pixmap_io/rgb.jpg", "assets/pixmap_io/dxt5.dds"};
+  for(auto path:files) {
+    Pixmap ref(path);
+
+    RFile             fin(path);
+    PixmapCodec::Info info;
+    ASSERT_TRUE(PixmapCodec::probeImg(fin,info));
+    EXPECT_EQ(info.w,       ref.w());
+    EXPECT_EQ(info.h,       ref.h());
+    EXPECT_EQ(info.frm,     ref.format());
+    EXPECT_EQ(info.mipCnt,  ref.mipCount());
+    EXPECT_EQ(info.dataSz,  ref.dataSize());
+    EXPECT_EQ(info.mipOffset(info.mipCnt),info.dataSz);
+
+    std::vector<uint8_t> small(info.dataSz/2);
+    EXPECT_FALSE(PixmapCodec::decodeImg(fin,info,small.data(),small.size()));
+
+    std::vector<uint8_t> buf(info.dataSz);
+    uint32_t rows = 0;
+    ASSERT_TRUE(PixmapCodec::decodeImg(fin,info,buf.data(),buf.size(),[&](uint32_t mip, uint32_t, uint32_t count){
+      if(mip==0)
+        rows += count;
+      }));
+    EXPECT_EQ(rows,ref.h());
+    EXPECT_EQ(std::memcmp(buf.data(),ref.data(),buf.size()),0);
+    }
+  }
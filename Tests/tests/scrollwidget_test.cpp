@@ -0,0 +1,211 @@
+#include <Tempest/ScrollWidget>
+#include <Tempest/Application>
+#include <Tempest/VectorImage>
+#include <Tempest/TextureAtlas>
+#include <Tempest/Painter>
+#include <Tempest/Event>
+
+#include "utils/vectorimageaccess.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+using namespace Tempest;
+using Detail::VectorImageAccess;
+
+namespace {
+
+struct Scroll : ScrollWidget {
+  using ScrollWidget::mouseWheelEvent;
+  using ScrollWidget::mouseDownEvent;
+  using ScrollWidget::mouseDragEvent;
+  using ScrollWidget::mouseUpEvent;
+  using ScrollWidget::kineticTick;
+  using ScrollWidget::dispatchPaintEvent;
+  };
+
+struct Item : Widget {
+  Item() { setSizeHint(Size(100,40)); }
+
+  // item is identified by red of its color
+  uint8_t id     = 0;
+  int     paints = 0;
+  void paintEvent(PaintEvent& e) override {
+    Painter p(e);
+    p.setBrush(Brush(Color(float(id)/255.f,1,1,1),Painter::NoBlend));
+    p.drawRect(0,0,w(),h());
+    paints++;
+    }
+  };
+
+std::vector<Item*> fill(Scroll& sc) {
+  std::vector<Item*> ret;
+  sc.resize(200,400);
+  for(int i=0; i<100; ++i) {
+    auto& it = sc.centralWidget().addWidget(new Item());
+    it.id = uint8_t(i);
+    ret.push_back(&it);
+    }
+  sc.setVscrollViewMode(ScrollWidget::AlwaysOn);
+  return ret;
+  }
+
+// kinetic timer, driven by hand: positions after each frame
+std::vector<int> inertia(Scroll& sc) {
+  std::vector<int> pos = {sc.scrollV()};
+  for(int i=0; i<500 && sc.isScrolling(); ++i) {
+    Application::sleep(16);
+    sc.kineticTick();
+    pos.push_back(sc.scrollV());
+    }
+  return pos;
+  }
+
+bool decays(const std::vector<int>& pos) {
+  if(!std::is_sorted(pos.begin(),pos.end()) || pos.size()<8)
+    return false;
+  const size_t q = pos.size()/4;
+  return pos[q]-pos[0] > pos.back()-pos[pos.size()-1-q];
+  }
+
+// quad of item in retained frame
+bool quadOf(const VectorImage& img, uint8_t id, PaintDevice::Quad& out) {
+  for(auto& q:VectorImageAccess::blocks(img).quads)
+    if(q.color==(uint32_t(id) | 0xFFFFFF00)) {
+      out = q;
+      return true;
+      }
+  return false;
+  }
+}
+
+TEST(main,ScrollWidgetKinetic) {
+  Scroll sc;
+  fill(sc);
+
+  // wheel without kinetic scroll jumps at once
+  MouseEvent wheel(10,10,Event::ButtonNone,Event::M_NoModifier,-1,0,Event::MouseWheel);
+  sc.mouseWheelEvent(wheel);
+  const int step = sc.scrollV();
+  EXPECT_GT(step,0);
+
+  sc.scrollV(0);
+  sc.setKineticScroll(true);
+  sc.mouseWheelEvent(wheel);
+  // moves by timer later on, one large step in total
+  EXPECT_EQ(sc.scrollV(),0);
+  EXPECT_TRUE(sc.isScrolling());
+  auto pos = inertia(sc);
+  EXPECT_FALSE(sc.isScrolling());
+  EXPECT_TRUE(decays(pos));
+  EXPECT_NEAR(sc.scrollV(),step,5);
+
+  // content follows the drag, and keeps moving after release
+  sc.scrollV(0);
+  MouseEvent down(50,300,Event::ButtonLeft,Event::M_NoModifier,0,0,Event::MouseDown);
+  MouseEvent drag(50,200,Event::ButtonLeft,Event::M_NoModifier,0,0,Event::MouseDrag);
+  MouseEvent up  (50,200,Event::ButtonLeft,Event::M_NoModifier,0,0,Event::MouseUp);
+  sc.mouseDownEvent(down);
+  EXPECT_TRUE(down.isAccepted());
+  Application::sleep(20);
+  sc.mouseDragEvent(drag);
+  EXPECT_EQ(sc.scrollV(),100);
+  sc.mouseUpEvent(up);
+  EXPECT_TRUE(sc.isScrolling());
+  pos = inertia(sc);
+  EXPECT_FALSE(sc.isScrolling());
+  EXPECT_TRUE(decays(pos));
+  // 100px in 20ms or more: impulse is 5000 px/s at most, travel is speed/5
+  EXPECT_GT(sc.scrollV(),100);
+  EXPECT_LE(sc.scrollV(),100+1000);
+
+  // inertia stops at end of scroll range
+  sc.scrollV(1000000);
+  const int end = sc.scrollV();
+  sc.scrollV(end-150);
+  sc.mouseDownEvent(down);
+  Application::sleep(20);
+  sc.mouseDragEvent(drag);
+  sc.mouseUpEvent(up);
+  inertia(sc);
+  EXPECT_FALSE(sc.isScrolling());
+  EXPECT_EQ(sc.scrollV(),end);
+
+  // scrolled by someone else
+  sc.scrollV(0);
+  sc.mouseWheelEvent(wheel);
+  Application::sleep(16);
+  sc.kineticTick();
+  sc.scrollV(0);
+  sc.kineticTick();
+  EXPECT_FALSE(sc.isScrolling());
+  EXPECT_EQ(sc.scrollV(),0);
+
+  sc.setKineticScroll(false);
+  MouseEvent down2(50,300,Event::ButtonLeft,Event::M_NoModifier,0,0,Event::MouseDown);
+  sc.mouseDownEvent(down2);
+  EXPECT_FALSE(down2.isAccepted());
+  }
+
+TEST(main,ScrollWidgetCached) {
+  Scroll sc;
+  auto   items = fill(sc);
+  EXPECT_FALSE(sc.isCachedScroll());
+  sc.setCachedScroll(true);
+  EXPECT_TRUE(sc.isCachedScroll());
+
+  TextureAtlas atlas;
+  VectorImage  img;
+  img.setRetained(true);
+  auto frame = [&]() {
+    img.clear();
+    PaintEvent e(img,atlas,uint32_t(sc.w()),uint32_t(sc.h()));
+    sc.dispatchPaintEvent(e);
+    };
+
+  frame();
+  std::vector<PaintDevice::Quad> before(items.size());
+  std::vector<bool>              shown (items.size());
+  for(size_t i=0; i<items.size(); ++i)
+    shown[i] = quadOf(img,items[i]->id,before[i]);
+  ASSERT_TRUE(shown[0]);
+  ASSERT_FALSE(shown.back());
+
+  // not a multiple of item height: items at the edges get cut differently
+  const int dy = 25;
+  sc.scrollV(dy);
+  EXPECT_EQ(sc.scrollV(),dy);
+  frame();
+
+  const float ty = -float(dy)*2.f/float(sc.h());
+  size_t replayed = 0, painted = 0;
+  for(size_t i=0; i<items.size(); ++i) {
+    PaintDevice::Quad q;
+    if(!quadOf(img,items[i]->id,q))
+      continue;
+    if(!shown[i]) {
+      // came into view
+      EXPECT_EQ(items[i]->paints,1);
+      painted++;
+      continue;
+      }
+    auto& b = before[i];
+    if(items[i]->paints==1) {
+      // only moved: same vertices, shifted by scroll
+      replayed++;
+      EXPECT_EQ(q.x0,b.x0);
+      EXPECT_EQ(q.x1,b.x1);
+      EXPECT_FLOAT_EQ(q.y0,b.y0+ty);
+      EXPECT_FLOAT_EQ(q.y1,b.y1+ty);
+      } else {
+      // visible part changed: painted again, clipped on the other edge
+      painted++;
+      EXPECT_EQ(items[i]->paints,2);
+      }
+    }
+  EXPECT_GT(replayed,0u);
+  EXPECT_GT(painted, 0u);
+  // cut only at top and bottom edges
+  EXPECT_LE(painted,4u);
+  }
@@ -58,3 +58,18 @@ TEST(main,TextCodec_UTF8_4) {
 
   TextCodec_Base(u8,u16);
   }
+
+TEST(main,TextCodec_UTF8_NoAlloc) {
+#if !defined(_MSC_VER)
+  char16_t buf[8] = {};
+  EXPECT_EQ(TextCodec::toUtf16("z\u00df\u6c34\U0001f34c",buf,8),5u);
+  EXPECT_EQ(std::u16string(buf),u"z\u00df\u6c34\U0001f34c");
+
+  // surrogate pair doesn't fit
+  EXPECT_EQ(TextCodec::toUtf16("z\U0001f34c",buf,3),1u);
+  EXPECT_EQ(std::u16string(buf),u"z");
+
+  EXPECT_EQ(TextCodec::toUtf16("",buf,8),0u);
+  EXPECT_EQ(buf[0],u'\0');
+#endif
+  }
@@ -0,0 +1,135 @@
+#include <Tempest/TextModel>
+#include <Tempest/Application>
+#include <Tempest/TextLayout>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+using namespace Tempest;
+
+static TextModel::Cursor cursorAt(const TextModel& m, size_t pos) {
+  // ascii text: one letter is one byte
+  return m.advance(m.charAt(size_t(0)),int32_t(pos));
+  }
+
+// width of text, measured from scratch
+static int widthOf(const char* txt) {
+  TextModel m(txt);
+  m.setFont(Application::defaultFont());
+  return m.w();
+  }
+
+TEST(main,TextModelEdit) {
+  TextModel   m("hello\nworld");
+  std::string ref = "hello\nworld";
+  m.setFont(Application::defaultFont());
+
+  std::mt19937 rnd(1);
+  for(int i=0; i<2000; ++i) {
+    const size_t a = rnd()%(ref.size()+1);
+    const size_t b = std::min(ref.size(),a+rnd()%8);
+    switch(rnd()%3) {
+      case 0: {
+        const char* ins[] = {"a","bc","\n","x\ny\n","long text\nwith lines"};
+        const char* t = ins[rnd()%5];
+        m.insert(t,cursorAt(m,a));
+        ref.insert(a,t);
+        break;
+        }
+      case 1: {
+        m.erase(cursorAt(m,a),cursorAt(m,b));
+        ref.erase(std::min(a,b),std::max(a,b)-std::min(a,b));
+        break;
+        }
+      case 2: {
+        m.replace("R\n",cursorAt(m,a),cursorAt(m,b));
+        ref.replace(std::min(a,b),std::max(a,b)-std::min(a,b),"R\n");
+        break;
+        }
+      }
+    ASSERT_EQ(ref,m.c_str());
+    ASSERT_EQ(ref.size(),m.size());
+    // widths are kept up to date by edits, same as measured from scratch
+    const int w = m.w();
+    if(i%50==0)
+      ASSERT_EQ(w,widthOf(ref.c_str())) << i;
+    }
+
+  std::string part;
+  m.fetch(cursorAt(m,3),cursorAt(m,ref.size()-3),part);
+  EXPECT_EQ(part,ref.substr(3,ref.size()-6));
+
+  // round trip of cursor to every position
+  for(size_t i=0; i<=ref.size(); ++i) {
+    auto c = cursorAt(m,i);
+    EXPECT_TRUE(m.isValid(c));
+    EXPECT_EQ(m.advance(c,-int32_t(i)),m.charAt(size_t(0)));
+    }
+  }
+
+TEST(main,TextModelWidth) {
+  TextModel m("short\na much longer line\nmid line");
+  m.setFont(Application::defaultFont());
+  const int wide = m.w();
+  EXPECT_EQ(wide,widthOf("a much longer line"));
+
+  // widest line is gone: next one defines width
+  m.erase(cursorAt(m,6),cursorAt(m,25));
+  EXPECT_EQ(std::string(m.c_str()),"short\nmid line");
+  EXPECT_EQ(m.w(),widthOf("mid line"));
+  EXPECT_LT(m.w(),wide);
+
+  m.insert("a much longer line\n",cursorAt(m,6));
+  EXPECT_EQ(m.w(),wide);
+  m.replace("x",cursorAt(m,6),cursorAt(m,25));
+  EXPECT_EQ(m.w(),widthOf("xmid line"));
+  }
+
+TEST(main,TextModelKerning) {
+  Font fnt = Application::defaultFont();
+  fnt.setPixelSize(16);
+  TextModel m("AVAVAV\nAV");
+  m.setFont(fnt);
+
+  // measured as painted: by shaped advances, not by sum of letters
+  int sum = 0;
+  for(const char* c="AVAVAV"; *c; ++c)
+    sum += fnt.letterGeometry(char32_t(*c)).advance.x;
+  const int w = TextLayout(fnt,"AVAVAV").size().w;
+  ASSERT_LT(w,sum);
+  EXPECT_EQ(m.w(),w);
+
+  // cursor goes to pen position of shaped text, and back
+  EXPECT_EQ(m.mapToCoords(cursorAt(m,6)).x,w);
+  int prev = -1;
+  for(size_t i=0; i<=6; ++i) {
+    auto        c = cursorAt(m,i);
+    const Point p = m.mapToCoords(c);
+    EXPECT_GT(p.x,prev);
+    EXPECT_EQ(m.charAt(p.x,p.y),c);
+    prev = p.x;
+    }
+  EXPECT_EQ(m.mapToCoords(cursorAt(m,9)).x,TextLayout(fnt,"AV").size().w);
+  }
+
+TEST(main,TextModelLargeText) {
+  std::string txt;
+  for(int i=0; i<100000; ++i)
+    txt += "line of a large log file " + std::to_string(i) + "\n";
+  TextModel m(txt.c_str());
+
+  auto      at    = cursorAt(m,txt.size()/2);
+  const int count = 1000;
+  for(int i=0; i<count; ++i) {
+    m.insert(i%10==9 ? "\n" : "x",at);
+    at = m.advance(at,1);
+    }
+
+  EXPECT_EQ(m.size(),txt.size()+count);
+  std::string tail;
+  m.fetch(m.advance(at,-10),at,tail);
+  EXPECT_EQ(tail,"xxxxxxxxx\n");
+  }
@@ -0,0 +1,36 @@
+#include <Tempest/Application>
+#include <Tempest/Timer>
+
+#include "utils/applicationaccess.h"
+
+#include <gtest/gtest.h>
+
+using namespace Tempest;
+using Detail::ApplicationAccess;
+
+TEST(main,TimerWaitTime) {
+  // nothing to wait for: loop still wakes up, to notice exit
+  EXPECT_EQ(ApplicationAccess::waitTime(Application::tickCount()),500u);
+
+  Timer slow, fast;
+  slow.start(2000);
+  EXPECT_EQ(ApplicationAccess::waitTime(Application::tickCount()),500u);
+
+  // nearest deadline wins, counted from start of timer
+  fast.start(100);
+  const uint64_t now = Application::tickCount();
+  const uint64_t t   = ApplicationAccess::waitTime(now);
+  EXPECT_LE(t,100u);
+  EXPECT_GE(t,50u);
+  EXPECT_EQ(ApplicationAccess::waitTime(now+10),t-10);
+
+  // overdue: no sleep at all
+  EXPECT_EQ(ApplicationAccess::waitTime(now+100),0u);
+  EXPECT_EQ(ApplicationAccess::waitTime(now+5000),0u);
+
+  // stopped timer is not waited for
+  fast.stop();
+  EXPECT_EQ(ApplicationAccess::waitTime(now+100),500u);
+  EXPECT_LE(ApplicationAccess::waitTime(now+1800),200u);
+  EXPECT_EQ(ApplicationAccess::waitTime(now+2000),0u);
+  }
@@ -0,0 +1,143 @@
+#include <Tempest/UndoStack>
+#include <Tempest/TextModel>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace testing;
+using namespace Tempest;
+
+namespace {
+
+struct Append : UndoStack<std::string>::Command {
+  Append(char ch):ch(ch){}
+  void redo(std::string& s) override { s.push_back(ch); }
+  void undo(std::string& s) override { s.pop_back(); }
+  size_t memoryUsage() const override { return 100; }
+
+  char ch;
+  };
+
+// letters, typed one after another, are undone together
+struct Typing : UndoStack<std::string>::Command {
+  Typing(char ch):txt(1,ch){}
+  void redo(std::string& s) override { s += txt; }
+  void undo(std::string& s) override { s.resize(s.size()-txt.size()); }
+  bool mergeWith(const Command& next) override {
+    auto n = dynamic_cast<const Typing*>(&next);
+    if(n==nullptr || n->txt[0]==' ')
+      return false;
+    txt += n->txt;
+    return true;
+    }
+
+  std::string txt;
+  };
+
+}
+
+TEST(main,UndoStackMerge) {
+  std::string            s;
+  UndoStack<std::string> stk;
+  for(char c:std::string("ab cd"))
+    stk.push(s,new Typing(c));
+  EXPECT_EQ(s,"ab cd");
+  EXPECT_EQ(stk.depth(),2u);
+
+  stk.undo(s);
+  EXPECT_EQ(s,"ab");
+  stk.redo(s);
+  EXPECT_EQ(s,"ab cd");
+
+  // undo/redo and breakMerge split runs
+  stk.push(s,new Typing('e'));
+  EXPECT_EQ(stk.depth(),3u);
+  stk.breakMerge();
+  stk.push(s,new Typing('f'));
+  EXPECT_EQ(stk.depth(),4u);
+
+  stk.setMergeRule([](const UndoStack<std::string>::Command&,const UndoStack<std::string>::Command&){ return false; });
+  stk.push(s,new Typing('g'));
+  EXPECT_EQ(stk.depth(),5u);
+  }
+
+TEST(main,UndoStackLimits) {
+  std::string            s;
+  UndoStack<std::string> stk;
+  stk.setMaxDepth(4);
+  for(int i=0; i<100; ++i) {
+    stk.breakMerge();
+    stk.push(s,new Append('a'));
+    }
+  EXPECT_EQ(stk.depth(),4u);
+  EXPECT_EQ(stk.memoryUsage(),400u);
+
+  stk.setMaxDepth(size_t(-1));
+  stk.setMemoryLimit(250);
+  EXPECT_EQ(stk.depth(),2u);
+  for(int i=0; i<10; ++i)
+    stk.undo(s);
+  EXPECT_EQ(s.size(),98u);
+  EXPECT_EQ(stk.memoryUsage(),0u);
+
+  // last command is kept over budget
+  stk.setMemoryLimit(10);
+  stk.push(s,new Append('b'));
+  EXPECT_EQ(stk.depth(),1u);
+  }
+
+TEST(main,UndoStackTransaction) {
+  std::string            s;
+  UndoStack<std::string> stk;
+  stk.push(s,new Typing('x'));
+  stk.beginTransaction();
+  stk.push(s,new Typing('a'));
+  stk.beginTransaction();
+  stk.push(s,new Typing(' '));
+  stk.push(s,new Typing('b'));
+  stk.endTransaction();
+  EXPECT_EQ(stk.depth(),1u);
+  stk.endTransaction();
+  EXPECT_EQ(stk.depth(),2u);
+
+  stk.undo(s);
+  EXPECT_EQ(s,"x");
+  stk.redo(s);
+  EXPECT_EQ(s,"xa b");
+  }
+
+TEST(main,UndoStackTextModel) {
+  TextModel            t("hello");
+  UndoStack<TextModel> stk;
+
+  const char* word = "abc def";
+  auto at = t.charAt(5);
+  for(const char* c=word; *c; ++c) {
+    char ch[2] = {*c,'\0'};
+    stk.push(t,new TextModel::CommandInsert(ch,at));
+    at = t.advance(at,1);
+    }
+  EXPECT_STREQ(t.c_str(),"helloabc def");
+  EXPECT_EQ(stk.depth(),2u);
+
+  // backspace run
+  for(int i=0; i<3; ++i) {
+    auto e = t.advance(at,-1);
+    stk.push(t,new TextModel::CommandErase(e,at));
+    at = e;
+    }
+  EXPECT_STREQ(t.c_str(),"helloabc ");
+  EXPECT_EQ(stk.depth(),3u);
+
+  stk.undo(t);
+  EXPECT_STREQ(t.c_str(),"helloabc def");
+  stk.undo(t);
+  EXPECT_STREQ(t.c_str(),"helloabc");
+  stk.undo(t);
+  EXPECT_STREQ(t.c_str(),"hello");
+  stk.redo(t);
+  stk.redo(t);
+  stk.redo(t);
+  EXPECT_STREQ(t.c_str(),"helloabc ");
+  }
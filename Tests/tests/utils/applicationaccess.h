@@ -0,0 +1,15 @@
+#pragma once
+
+#include <Tempest/Application>
+
+namespace Tempest {
+namespace Detail {
+
+// sleep time of event-driven loop, at given tick
+class ApplicationAccess {
+  public:
+    static uint64_t waitTime(uint64_t now) { return Application::implWaitTime(now); }
+  };
+
+}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Tempest/Font>
+
+namespace Tempest {
+namespace Detail {
+
+// font file, as parsed by FontElement
+class FontAccess {
+  public:
+    static const uint8_t* data(const FontElement& fnt) {
+      size_t sz = 0;
+      return fnt.rawData(sz);
+      }
+  };
+
+}
+}
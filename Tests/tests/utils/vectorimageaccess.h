@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Tempest/VectorImage>
+
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+// geometry of VectorImage, as it goes to gpu
+class VectorImageAccess {
+  public:
+    using Point = PaintDevice::Point;
+    using Quad  = PaintDevice::Quad;
+    using Blend = PaintDevice::Blend;
+
+    struct Draw {
+      Topology tp        = Triangles;
+      Blend    blend     = PaintDevice::NoBlend;
+      bool     instanced = false;
+      bool     textured  = false;
+      size_t   begin     = 0;
+      size_t   size      = 0;
+      bool     distField = false;
+      PaintDevice::TextEffect fx;
+      };
+
+    struct Geometry {
+      std::vector<Draw>  draw;
+      std::vector<Point> pts;
+      std::vector<Quad>  quads;
+      };
+
+    // blocks in paint order
+    static Geometry blocks(const VectorImage& img) {
+      Geometry g;
+      g.pts   = img.buf;
+      g.quads = img.quads;
+      for(auto& b:img.blocks)
+        if(b.size>0)
+          g.draw.push_back({b.tp,b.blend,b.instanced,b.hasImg,b.begin,b.size,b.tex.distField,b.tex.fx});
+      return g;
+      }
+
+    // draws, merged by VectorImage::Mesh::update
+    static Geometry batched(const VectorImage& img) {
+      Geometry                        g;
+      std::vector<VectorImage::Batch> bt;
+      img.batch(bt,g.pts,g.quads);
+      for(auto& b:bt) {
+        auto& src = img.blocks[b.block];
+        g.draw.push_back({src.tp,src.blend,src.instanced,src.hasImg,b.begin,b.size,src.tex.distField,src.tex.fx});
+        }
+      return g;
+      }
+  };
+
+}
+}